@@ -26,6 +26,7 @@ class _VideoItem extends StatefulWidget {
 class _VideoItemState extends State<_VideoItem> {
   VideoController? _player;
   var _inView = false;
+  var _prefetched = false;
 
   void _update() => setState(() {});
 
@@ -69,6 +70,13 @@ class _VideoItemState extends State<_VideoItem> {
     ),
     builder: (_, isInView, child) {
       _inView = isInView;
+      if (_inView &&
+          !_prefetched &&
+          widget.index + 1 < videoSources.length) {
+        // Warm up the next video once, so it starts quickly after scrolling.
+        _prefetched = true;
+        VideoController.prefetch(videoSources[widget.index + 1]);
+      }
       if (_player != null) {
         if (_inView) {
           // We should open the video only if it's niehter loading nor opened.
@@ -8,6 +8,30 @@ enum VideoControllerDisplayMode { normal, fullscreen, pictureInPicture }
 /// This type is used by [VideoController.playbackState].
 enum VideoControllerPlaybackState { closed, paused, playing }
 
+/// This type is used by [VideoController.visibility].
+enum VideoControllerVisibility { visible, hidden, audioOnly }
+
+/// This type is used by [VideoController.priority].
+enum VideoControllerPriority { foreground, background, thumbnail }
+
+/// This type is used by [VideoController.quality].
+/// Each step includes the ones before it.
+enum VideoControllerQuality {
+  full,
+
+  /// Bilinear scaling and no debanding.
+  fastScaling,
+
+  /// The video is rendered at half of its size.
+  halfResolution,
+
+  /// A lower rendition of adaptive streams is selected.
+  lowerRendition,
+
+  /// The decoder skips the loop filter and other costly steps.
+  fastDecoding,
+}
+
 /// This class is used by [VideoController] to notify listeners when
 /// property changes. The [value] setter is protected, you may see warnings
 /// when trying to assign value to it.
@@ -127,6 +151,264 @@ class VideoControllerMediaInfo {
   );
 }
 
+/// This type is used by [VideoController.rendition].
+class VideoControllerRendition {
+  final int width;
+  final int height;
+
+  /// The bit rate of the rendition in bits per second.
+  final int bitRate;
+
+  /// The estimated bandwidth in bits per second when the rendition is selected.
+  final int bandwidth;
+
+  /// The media buffered ahead in milliseconds when the rendition is selected.
+  final int buffer;
+
+  const VideoControllerRendition({
+    this.width = 0,
+    this.height = 0,
+    this.bitRate = 0,
+    this.bandwidth = 0,
+    this.buffer = 0,
+  });
+
+  factory VideoControllerRendition.fromMap(Map map) => VideoControllerRendition(
+    width: map['width'] as int,
+    height: map['height'] as int,
+    bitRate: map['bitRate'] as int,
+    bandwidth: map['bandwidth'] as int,
+    buffer: map['buffer'] as int,
+  );
+}
+
+/// This type is used by [VideoController.openTiming].
+/// All times are in milliseconds since the media is opened.
+class VideoControllerOpenTiming {
+  /// The demuxer has opened the media.
+  final int fileLoaded;
+
+  /// The first frame is decoded.
+  final int playbackRestart;
+
+  /// [VideoController.mediaInfo] is sent.
+  final int mediaInfo;
+
+  /// The texture is asked for its first frame.
+  final int? firstPopulate;
+
+  /// The first frame is drawn to the texture. It's null for media without video.
+  final int? firstFrame;
+
+  /// Whether the media is read from network.
+  final bool network;
+
+  /// Whether the media is opened with [VideoController.fastStart].
+  final bool fastStart;
+
+  /// The demuxer used by the media, such as "lavf" or "mkv".
+  final String? demuxer;
+
+  /// The bytes read ahead by the demuxer when [mediaInfo] is sent.
+  final int cacheBytes;
+
+  /// The duration in milliseconds read ahead by the demuxer when [mediaInfo] is sent.
+  final int cacheDuration;
+
+  /// The input rate in bytes per second when [mediaInfo] is sent.
+  final int inputRate;
+
+  const VideoControllerOpenTiming({
+    required this.fileLoaded,
+    required this.playbackRestart,
+    required this.mediaInfo,
+    this.firstPopulate,
+    this.firstFrame,
+    this.network = false,
+    this.fastStart = false,
+    this.demuxer,
+    this.cacheBytes = 0,
+    this.cacheDuration = 0,
+    this.inputRate = 0,
+  });
+
+  factory VideoControllerOpenTiming.fromMap(Map map) =>
+      VideoControllerOpenTiming(
+        fileLoaded: map['fileLoaded'] as int,
+        playbackRestart: map['playbackRestart'] as int,
+        mediaInfo: map['mediaInfo'] as int,
+        firstPopulate: map['firstPopulate'] as int?,
+        firstFrame: map['firstFrame'] as int?,
+        network: map['network'] as bool? ?? false,
+        fastStart: map['fastStart'] as bool? ?? false,
+        demuxer: map['demuxer'] as String?,
+        cacheBytes: map['cacheBytes'] as int? ?? 0,
+        cacheDuration: map['cacheDuration'] as int? ?? 0,
+        inputRate: map['inputRate'] as int? ?? 0,
+      );
+}
+
+/// This type is used by [VideoController.stats] and [VideoController.getStats].
+/// Render times are in microseconds, and computed from the most recent frames.
+class VideoControllerStats {
+  /// Frames dropped by the decoder.
+  final int decoderDrops;
+
+  /// Frames dropped by the video output.
+  final int outputDrops;
+
+  /// The estimated frame rate of decoded video.
+  final double fps;
+
+  /// The difference between audio and video positions in milliseconds.
+  final double avSync;
+
+  final int populateAverage;
+  final int populateP99;
+  final int renderAverage;
+  final int renderP99;
+
+  /// The time to upload software rendered frames, it's 0 with hardware rendering.
+  final int uploadAverage;
+  final int uploadP99;
+
+  /// The latency of the last [VideoController.stepFrame] in microseconds, until the frame is on screen.
+  final int stepLatency;
+
+  /// The average latency of all steps of the player.
+  final int stepLatencyAverage;
+
+  /// The bytes held by textures of the player, including frames cached by
+  /// [VideoController.stepFrame]. It's 0 with software rendering.
+  final int textureBytes;
+
+  /// The bytes held by buffers of software rendering, including frames cached
+  /// by [VideoController.stepFrame]. It's 0 with EGL rendering.
+  final int bufferBytes;
+
+  /// The bytes held by the demuxer cache.
+  final int cacheBytes;
+
+  /// The speed in bytes per second at which the demuxer cache is filled.
+  final int cacheSpeed;
+
+  /// The hardware decoding API in use, null for software decoding.
+  final String? hwdec;
+
+  const VideoControllerStats({
+    this.decoderDrops = 0,
+    this.outputDrops = 0,
+    this.fps = 0,
+    this.avSync = 0,
+    this.populateAverage = 0,
+    this.populateP99 = 0,
+    this.renderAverage = 0,
+    this.renderP99 = 0,
+    this.uploadAverage = 0,
+    this.uploadP99 = 0,
+    this.stepLatency = 0,
+    this.stepLatencyAverage = 0,
+    this.textureBytes = 0,
+    this.bufferBytes = 0,
+    this.cacheBytes = 0,
+    this.cacheSpeed = 0,
+    this.hwdec,
+  });
+
+  factory VideoControllerStats.fromMap(Map map) {
+    final hwdec = map['hwdec'] as String?;
+    return VideoControllerStats(
+      decoderDrops: map['decoderDrops'] as int,
+      outputDrops: map['outputDrops'] as int,
+      fps: map['fps'] as double,
+      avSync: map['avSync'] as double,
+      populateAverage: map['populateAverage'] as int,
+      populateP99: map['populateP99'] as int,
+      renderAverage: map['renderAverage'] as int,
+      renderP99: map['renderP99'] as int,
+      uploadAverage: map['uploadAverage'] as int,
+      uploadP99: map['uploadP99'] as int,
+      stepLatency: map['stepLatency'] as int? ?? 0,
+      stepLatencyAverage: map['stepLatencyAverage'] as int? ?? 0,
+      textureBytes: map['textureBytes'] as int,
+      bufferBytes: map['bufferBytes'] as int,
+      cacheBytes: map['cacheBytes'] as int,
+      cacheSpeed: map['cacheSpeed'] as int,
+      hwdec: hwdec == "" ? null : hwdec,
+    );
+  }
+}
+
+/// The memory held for a player in bytes, which is estimated from sizes of buffers and textures.
+/// This type is used by [VideoControllerMemoryReport].
+class VideoControllerMemoryUsage {
+  /// The demuxer cache in memory, cache on disk is not counted.
+  final int cache;
+
+  /// The buffer of software rendering, the texture uploaded from it is not
+  /// counted again.
+  final int buffer;
+
+  /// The texture shown by [VideoView] with EGL rendering.
+  final int texture;
+
+  /// The frames cached by [VideoController.stepFrame].
+  final int stepCache;
+
+  /// The track lists.
+  final int tracks;
+
+  final int total;
+
+  const VideoControllerMemoryUsage({
+    this.cache = 0,
+    this.buffer = 0,
+    this.texture = 0,
+    this.stepCache = 0,
+    this.tracks = 0,
+    this.total = 0,
+  });
+
+  factory VideoControllerMemoryUsage.fromMap(Map map) =>
+      VideoControllerMemoryUsage(
+        cache: map['cache'] as int,
+        buffer: map['buffer'] as int,
+        texture: map['texture'] as int,
+        stepCache: map['stepCache'] as int,
+        tracks: map['tracks'] as int,
+        total: map['total'] as int,
+      );
+}
+
+/// This type is used by [VideoController.getMemoryReport].
+class VideoControllerMemoryReport {
+  /// The budget set by [VideoController.setMemoryBudget], 0 means no budget.
+  final int budget;
+
+  final int total;
+
+  /// The usage of each player by its id.
+  final Map<int, VideoControllerMemoryUsage> players;
+
+  const VideoControllerMemoryReport({
+    this.budget = 0,
+    this.total = 0,
+    this.players = const {},
+  });
+
+  factory VideoControllerMemoryReport.fromMap(Map map) =>
+      VideoControllerMemoryReport(
+        budget: map['budget'] as int,
+        total: map['total'] as int,
+        players: (map['players'] as Map).map(
+          (id, usage) => MapEntry(
+            id as int,
+            VideoControllerMemoryUsage.fromMap(usage as Map),
+          ),
+        ),
+      );
+}
+
 /// The interface for creating and controling player instance.
 ///
 /// Do NOT modify properties directly, use the corresponding methods instead.
@@ -134,6 +416,80 @@ abstract class VideoController {
   /// This constructor is used by implementations and should be considered as private.
   VideoController.create();
 
+  /// Set the demuxer cache policy shared by all players. It applies to media opened afterwards.
+  ///
+  /// [memoryBytes] limits the cache of each player in memory, 0 means the default limit.
+  /// [diskBytes] greater than 0 moves the cache to files in [directory], and limits the total size of them.
+  /// When the total size exceeds [diskBytes], the cache of least recently used players is dropped first.
+  /// [directory] defaults to a folder in the user cache directory.
+  /// This API only works on Linux.
+  static bool setCachePolicy({
+    int memoryBytes = 0,
+    int diskBytes = 0,
+    String? directory,
+  }) => VideoControllerImplementation.setCachePolicy(
+    memoryBytes,
+    diskBytes,
+    directory,
+  );
+
+  /// Route http and https media of players opened afterwards through a loopback proxy.
+  ///
+  /// The proxy reuses connections to the same host, and players requesting the same data concurrently share one download.
+  /// [maxBitRate] limits the total download rate in bits per second, 0 means no limit.
+  /// Within the limit, playing and opening players get a larger share than paused ones.
+  /// This API only works on Linux.
+  static bool setProxy(bool enabled, {int maxBitRate = 0}) =>
+      VideoControllerImplementation.setProxy(enabled, maxBitRate);
+
+  /// Download the beginning of an upcoming http or https [source] without creating a player.
+  ///
+  /// A later [open] of the same source starts from the downloaded data.
+  /// For HLS, the preferred variant and the first segments of a VOD playlist are downloaded as well.
+  /// [bytes] limits the total size to download, the cache shared by all sources is limited to 64MB.
+  /// Prefetching has lower priority than playback when [setProxy] limits the bit rate.
+  /// This API only works on Linux.
+  static bool prefetch(String source, {int bytes = 4 << 20}) =>
+      VideoControllerImplementation.prefetch(source, bytes);
+
+  /// Cancel prefetching [source] and drop the downloaded data.
+  /// This API only works on Linux.
+  static bool cancelPrefetch(String source) =>
+      VideoControllerImplementation.prefetch(source, 0);
+
+  /// Write spans of the render, event and method call paths of all players to a Chrome trace file at [path].
+  ///
+  /// The file can be opened by Perfetto or chrome://tracing. Tracing costs almost nothing while stopped.
+  /// This API only works on Linux.
+  static bool startTrace(String path) =>
+      VideoControllerImplementation.startTrace(path);
+
+  /// Stop tracing and close the trace file.
+  /// This API only works on Linux.
+  static bool stopTrace() => VideoControllerImplementation.stopTrace();
+
+  /// Set the number of decoder threads shared by all players, 0 means the number of processors, which is the default.
+  ///
+  /// Each media gets a share by its [priority] among opened players when it's opened.
+  /// This API only works on Linux.
+  static bool setDecoderThreads(int threads) =>
+      VideoControllerImplementation.setDecoderThreads(threads);
+
+  /// Set the memory budget in bytes shared by all players, 0 means no budget, which is the default.
+  ///
+  /// The budget is checked every second. While it's exceeded, least recently used players give up memory first:
+  /// the demuxer cache of players not playing is dropped, then software render buffers and cached step frames of
+  /// paused or hidden players are freed, then the cache of playing players other than foreground ones
+  /// (see [setPriority]) is limited until they open another media.
+  /// This API only works on Linux.
+  static bool setMemoryBudget(int bytes) =>
+      VideoControllerImplementation.setMemoryBudget(bytes);
+
+  /// Get the memory held by all players.
+  /// This API only works on Linux.
+  static Future<VideoControllerMemoryReport?> getMemoryReport() =>
+      VideoControllerImplementation.getMemoryReport();
+
   /// All parameters are optional, and can be changed later by calling the corresponding methods.
   ///
   /// [cancelableNotification] determines whether properties should suppress unchanged notifications.
@@ -187,6 +543,11 @@ abstract class VideoController {
   /// It's null before an error occurs.
   final error = VideoControllerProperty<String?>(null);
 
+  /// The last mpv log messages sent with [error], from the oldest to the newest.
+  /// It's empty unless logging is enabled by [setLogLevel].
+  /// This API only works on Linux.
+  final errorLogs = VideoControllerProperty<List<String>>(const []);
+
   /// The loading state of the player.
   /// It's false before opening a media.
   final loading = VideoControllerProperty(false);
@@ -211,7 +572,7 @@ abstract class VideoController {
   final finishedTimes = VideoControllerProperty(0);
 
   /// The current buffer status of the player.
-  /// It is only reported by network media.
+  /// It is only reported by network media, or realtime streams with [timeShift] enabled.
   final bufferRange = VideoControllerProperty<VideoControllerBufferRange>(
     .empty,
   );
@@ -234,6 +595,83 @@ abstract class VideoController {
   /// It's between 0.5 and 2, and defaults to 1.
   final speed = VideoControllerProperty(1.0);
 
+  /// The distance in milliseconds between the current position and the live edge of a realtime stream.
+  /// It's 0 for other media, and only reported on Linux.
+  final liveLatency = VideoControllerProperty(0);
+
+  /// The latency in milliseconds the player tries to keep for realtime streams.
+  /// 0 means no latency control, which is the default.
+  final targetLatency = VideoControllerProperty(0);
+
+  /// The time-shift window in milliseconds for realtime streams. 0 means time-shift is disabled.
+  /// While enabled, [bufferRange] of a realtime stream is the seekable window, and [seekTo] works inside it.
+  final timeShift = VideoControllerProperty(0);
+
+  /// The bytes held by the demuxer cache of the current media, in memory or on disk.
+  /// It's 0 before the media is opened, and only reported on Linux.
+  final cacheBytes = VideoControllerProperty(0);
+
+  /// The ratio of seeks served from the demuxer cache of the current network media.
+  /// It's 0 before any seek, and only reported on Linux.
+  final cacheHitRate = VideoControllerProperty(0.0);
+
+  /// The timing of the phases of the last open, to find out where the time to first frame goes.
+  /// It's null until the first frame is drawn, and only reported on Linux.
+  final openTiming = VideoControllerProperty<VideoControllerOpenTiming?>(null);
+
+  /// The playback statistics reported every [statsInterval] milliseconds.
+  /// It's null before the first report, and only reported on Linux.
+  final stats = VideoControllerProperty<VideoControllerStats?>(null);
+
+  /// The interval in milliseconds between [stats] reports. 0 means no report, which is the default.
+  final statsInterval = VideoControllerProperty(0);
+
+  /// The level of mpv log messages kept by the player. null means logging is disabled, which is the default.
+  final logLevel = VideoControllerProperty<String?>(null);
+
+  /// Whether the media is opened with the fast-start profile.
+  /// It's false by default.
+  final fastStart = VideoControllerProperty(false);
+
+  /// Whether the video of the player is on screen.
+  /// It's [VideoControllerVisibility.visible] by default.
+  final visibility = VideoControllerProperty<VideoControllerVisibility>(
+    .visible,
+  );
+
+  /// The priority class of the player.
+  /// It's [VideoControllerPriority.foreground] by default.
+  final priority = VideoControllerProperty<VideoControllerPriority>(
+    .foreground,
+  );
+
+  /// The max frame rate rendered by the player. 0 means no cap, which is the default.
+  final maxFrameRate = VideoControllerProperty(0.0);
+
+  /// Whether audio is not decoded while [volume] is 0.
+  /// It's false by default.
+  final skipMutedAudio = VideoControllerProperty(false);
+
+  /// Whether the player switches renditions of adaptive streams by the estimated bandwidth.
+  /// It's false by default.
+  final adaptiveBitRate = VideoControllerProperty(false);
+
+  /// The rendition selected by [adaptiveBitRate].
+  /// It's null until the first switch of the current media, and only reported on Linux.
+  final rendition = VideoControllerProperty<VideoControllerRendition?>(null);
+
+  /// Whether the player lowers its quality when it can't keep up.
+  /// It's false by default.
+  final adaptiveQuality = VideoControllerProperty(false);
+
+  /// The step of quality chosen by [adaptiveQuality].
+  /// It's [VideoControllerQuality.full] when the media is opened, and only reported on Linux.
+  final quality = VideoControllerProperty<VideoControllerQuality>(.full);
+
+  /// The scan speed of the player. 0 means the player is not scanning.
+  /// It's reset to 0 when the scan reaches either end of the media.
+  final scanSpeed = VideoControllerProperty(0.0);
+
   /// Whether the player should loop the media.
   /// It's false by default.
   final looping = VideoControllerProperty(false);
@@ -263,10 +701,30 @@ abstract class VideoController {
     videoSize,
     position,
     error,
+    errorLogs,
     loading,
     playbackState,
     volume,
     speed,
+    scanSpeed,
+    liveLatency,
+    targetLatency,
+    timeShift,
+    cacheBytes,
+    cacheHitRate,
+    openTiming,
+    stats,
+    statsInterval,
+    logLevel,
+    fastStart,
+    visibility,
+    priority,
+    maxFrameRate,
+    skipMutedAudio,
+    adaptiveBitRate,
+    rendition,
+    adaptiveQuality,
+    quality,
     looping,
     autoPlay,
     finishedTimes,
@@ -399,9 +857,108 @@ abstract class VideoController {
 
   /// Set playback speed of the player.
   ///
-  /// [speed] is the speed to set between 0.5 and 2.
+  /// [speed] is the speed to set between 0.5 and 2, or up to 64 on Linux,
+  /// where speeds over 4 scan keyframes only like [setScanSpeed].
   bool setSpeed(double speed);
 
+  /// Scan through the media at [speed] times by decoding keyframes only, audio is silent while scanning.
+  ///
+  /// [speed] is between 2 and 64, or between -64 and -2 for scanning backward. 0 stops scanning.
+  /// This API only works on Linux.
+  bool setScanSpeed(double speed);
+
+  /// Set the latency the player tries to keep for realtime streams.
+  ///
+  /// [latency] is in milliseconds. The player speeds up or slows down slightly to hold it, and jumps forward when far behind.
+  /// Players sharing the same target stay within a bounded delay of each other. 0 disables latency control.
+  /// This API only works on Linux.
+  bool setTargetLatency(int latency);
+
+  /// Set the time-shift window for realtime streams, so they can be paused and rewound.
+  ///
+  /// [timeShift] is in milliseconds, and 0 disables time-shift.
+  /// The window is kept in the demuxer back buffer, which never exceeds 256MB regardless of the window.
+  /// This API only works on Linux.
+  bool setTimeShift(int timeShift);
+
+  /// Get the current playback statistics, or null if they are not available.
+  /// This API only works on Linux.
+  Future<VideoControllerStats?> getStats();
+
+  /// Set the interval in milliseconds between [stats] reports, 0 stops reporting.
+  /// Collecting statistics is cheap enough to keep enabled.
+  /// This API only works on Linux.
+  bool setStatsInterval(int interval);
+
+  /// Set the level of mpv log messages kept by the player, null disables logging.
+  ///
+  /// [level] is one of 'fatal', 'error', 'warn', 'info', 'v', 'debug' and 'trace'.
+  /// The last 256 messages are kept in memory, and at most 200 messages per second are captured.
+  /// Use [getLogs] to retrieve them, for example after [error] is set.
+  /// This API only works on Linux.
+  bool setLogLevel(String? level);
+
+  /// Get the recent mpv log messages of the player, from the oldest to the newest.
+  /// This API only works on Linux.
+  Future<List<String>> getLogs();
+
+  /// Set whether the following opens use the fast-start profile.
+  ///
+  /// It probes less of the media and keeps a small read-ahead buffer until playback begins, so the first frame shows up sooner.
+  /// Normal buffering is restored once the media is played. The media being opened is not affected.
+  /// This API only works on Linux.
+  bool setFastStart(bool fastStart);
+
+  /// Tell the player whether its video is on screen.
+  ///
+  /// A hidden player keeps decoding but stops rendering, and shows the latest frame as soon as it's visible again.
+  /// An audio only player also stops decoding video and releases its render target, [videoSize] is kept meanwhile.
+  /// Media opened by an audio only player, or with an audio file extension, doesn't create a video renderer at all,
+  /// and the renderer of other media is freed once its track list shows no video.
+  /// [VideoView] hides the player while it's offstage, and all players are hidden while the window is minimized.
+  /// This API only works on Linux.
+  bool setVisibility(VideoControllerVisibility visibility);
+
+  /// Set the priority class of the player, so the one being watched stays smooth when many players are running.
+  ///
+  /// Classes get decreasing shares of decoder threads (see [setDecoderThreads]) and of the bandwidth limited by [setProxy].
+  /// Background players also read less ahead and render at most 30 frames per second, thumbnails 15.
+  /// Decoder threads apply to media opened afterwards, others apply immediately.
+  /// This API only works on Linux.
+  bool setPriority(VideoControllerPriority priority);
+
+  /// Set the max frame rate rendered by the player, 0 means no cap. It's meant for previews and thumbnails.
+  ///
+  /// The lower of it and the cap of [priority] applies. Frames over the cap are dropped by mpv before they're rendered,
+  /// and when the cap is at most half the frame rate of the media, frames that no other frame depends on are not
+  /// decoded either, which [stepFrame] skips as well. Frames of hidden players are consumed without being rendered.
+  /// The decoder only switches while the player is hidden or before its first frame, so a visible player doesn't stall.
+  /// This API only works on Linux.
+  bool setMaxFrameRate(double fps);
+
+  /// Set whether the player stops decoding audio and releases its audio output while [volume] is 0.
+  ///
+  /// It only applies to media with video, which keeps the playback clock. Audio resumes in sync when the volume is raised.
+  /// This API only works on Linux.
+  bool setSkipMutedAudio(bool skip);
+
+  /// Set whether the player switches renditions of adaptive streams by the bandwidth estimated from the download
+  /// rate of the demuxer and the media buffered ahead.
+  ///
+  /// It switches up only with enough media buffered to refetch from the position, and down when the buffer runs
+  /// low or the rendition can't be sustained. [setMaxBitRate] and [setMaxResolution] still apply.
+  /// The download rate is only sampled while the demuxer keeps reading, so with a full buffer the estimate is updated
+  /// rarely, and a single sample counts at most twice the long-term estimate.
+  /// This API only works on Linux.
+  bool setAdaptiveBitRate(bool enable);
+
+  /// Set whether the player lowers its quality step by step when frames are dropped or rendering takes most of
+  /// the frame time, and raises it again after several seconds with plenty of headroom.
+  ///
+  /// The steps are described by [VideoControllerQuality], and the current one is [quality].
+  /// This API only works on Linux.
+  bool setAdaptiveQuality(bool enable);
+
   /// Set whether the player should loop the media.
   bool setLooping(bool looping);
 
@@ -436,6 +993,11 @@ abstract class VideoController {
   /// Set whether to keep the screen on when playing video.
   bool setKeepScreenOn(bool keepOn);
 
+  /// Step [frames] video frames forward (positive) or backward (negative), and pause the player.
+  /// Frames around the current position are cached, so repeated steps don't decode them again.
+  /// This API only works on Linux.
+  bool stepFrame(int frames);
+
   /// Set video display mode.
   /// This API only works on web.
   bool setDisplayMode(VideoControllerDisplayMode mode);
@@ -9,6 +9,7 @@ import 'player.dart';
 /// Native implementation of [VideoController].
 class VideoControllerImplementation extends VideoController {
   static const _methodChannel = MethodChannel('VideoViewPlugin');
+  static final _isLinux = defaultTargetPlatform == TargetPlatform.linux;
   static var _detectorStarted = false;
 
   /// The id of the player.
@@ -29,6 +30,96 @@ class VideoControllerImplementation extends VideoController {
   var _seeking = false;
   var _position = 0;
 
+  static bool setCachePolicy(
+    int memoryBytes,
+    int diskBytes,
+    String? directory,
+  ) {
+    if (_isLinux && memoryBytes >= 0 && diskBytes >= 0) {
+      _methodChannel.invokeMethod('setCachePolicy', {
+        'memoryBytes': memoryBytes,
+        'diskBytes': diskBytes,
+        'directory': directory ?? '',
+      });
+      return true;
+    }
+    return false;
+  }
+
+  static bool setProxy(bool enabled, int maxBitRate) {
+    if (_isLinux && maxBitRate >= 0) {
+      _methodChannel.invokeMethod('setProxy', {
+        'enabled': enabled,
+        'maxBitRate': maxBitRate,
+      });
+      return true;
+    }
+    return false;
+  }
+
+  static bool prefetch(String source, int bytes) {
+    if (_isLinux &&
+        bytes >= 0 &&
+        (source.startsWith('http://') || source.startsWith('https://'))) {
+      _methodChannel.invokeMethod('prefetch', {
+        'source': source,
+        'bytes': bytes,
+      });
+      return true;
+    }
+    return false;
+  }
+
+  static bool startTrace(String path) {
+    if (_isLinux && path.isNotEmpty) {
+      _methodChannel.invokeMethod('startTrace', path);
+      return true;
+    }
+    return false;
+  }
+
+  static bool stopTrace() {
+    if (_isLinux) {
+      _methodChannel.invokeMethod('stopTrace');
+      return true;
+    }
+    return false;
+  }
+
+  static bool setDecoderThreads(int threads) {
+    if (_isLinux && threads >= 0) {
+      _methodChannel.invokeMethod('setDecoderThreads', threads);
+      return true;
+    }
+    return false;
+  }
+
+  // create fails with an 'unsupported' error if libmpv can't be loaded, other errors are not expected and pass through
+  static Future<dynamic> _create() => _methodChannel
+      .invokeMethod('create')
+      .catchError(
+        (_) => null,
+        test: (e) => e is PlatformException && e.code == 'unsupported',
+      );
+
+  static bool setMemoryBudget(int bytes) {
+    if (_isLinux && bytes >= 0) {
+      _methodChannel.invokeMethod('setMemoryBudget', bytes);
+      return true;
+    }
+    return false;
+  }
+
+  static Future<VideoControllerMemoryReport?> getMemoryReport() async {
+    if (_isLinux) {
+      final result = await _methodChannel.invokeMethod('getMemoryReport');
+      if (result is Map) {
+        return VideoControllerMemoryReport.fromMap(result);
+      }
+    }
+    return null;
+  }
+
   VideoControllerImplementation() : super.create() {
     if (kDebugMode && !_detectorStarted) {
       _detectorStarted = true;
@@ -42,7 +133,7 @@ class VideoControllerImplementation extends VideoController {
         debugName: 'Video_view restart detector',
       );
     }
-    _methodChannel.invokeMethod('create').then((value) {
+    _create().then((value) {
       if (value is! Map) {
         if (!disposed) {
           _source = null;
@@ -80,6 +171,28 @@ class VideoControllerImplementation extends VideoController {
                       playbackState.value = .paused;
                     }
                   }
+                } else if (eventName == 'mediaInfoUpdate') {
+                  // mediaInfo from the probe cache is outdated
+                  if (_source == e['source'] && mediaInfo.value != null) {
+                    mediaInfo.value = VideoControllerMediaInfo(
+                      e['duration'],
+                      VideoControllerAudioInfo.batchFromMap(e['audioTracks']),
+                      VideoControllerSubtitleInfo.batchFromMap(
+                        e['subtitleTracks'],
+                      ),
+                      _source!,
+                    );
+                    if (!mediaInfo.value!.audioTracks.containsKey(
+                      overrideAudio.value,
+                    )) {
+                      overrideAudio.value = null;
+                    }
+                    if (!mediaInfo.value!.subtitleTracks.containsKey(
+                      overrideSubtitle.value,
+                    )) {
+                      overrideSubtitle.value = null;
+                    }
+                  }
                 } else if (eventName == 'videoSize') {
                   if (playbackState.value != .closed || loading.value) {
                     final width = e['width'] as double;
@@ -96,7 +209,10 @@ class VideoControllerImplementation extends VideoController {
                   }
                 } else if (eventName == 'position') {
                   if (mediaInfo.value != null) {
-                    position.value = e['value'] > mediaInfo.value!.duration
+                    // realtime streams report positions in the time-shift window
+                    position.value =
+                        mediaInfo.value!.duration > 0 &&
+                            e['value'] > mediaInfo.value!.duration
                         ? mediaInfo.value!.duration
                         : e['value'] < 0
                         ? 0
@@ -114,6 +230,8 @@ class VideoControllerImplementation extends VideoController {
                   if (playbackState.value != .closed || loading.value) {
                     _source = null;
                     loading.value = false;
+                    errorLogs.value =
+                        (e['logs'] as List?)?.cast<String>() ?? const [];
                     error.value = e['value'];
                     _close();
                   }
@@ -126,6 +244,43 @@ class VideoControllerImplementation extends VideoController {
                     _seeking = false;
                     loading.value = false;
                   }
+                } else if (eventName == 'stepEnd') {
+                  if (mediaInfo.value != null) {
+                    position.value = e['position'] > mediaInfo.value!.duration
+                        ? mediaInfo.value!.duration
+                        : e['position'] < 0
+                        ? 0
+                        : e['position'];
+                  }
+                } else if (eventName == 'latency') {
+                  if (mediaInfo.value != null) {
+                    liveLatency.value = e['value'];
+                  }
+                } else if (eventName == 'cache') {
+                  if (mediaInfo.value != null) {
+                    cacheBytes.value = e['bytes'];
+                    cacheHitRate.value = e['hitRate'];
+                  }
+                } else if (eventName == 'stats') {
+                  if (mediaInfo.value != null) {
+                    stats.value = VideoControllerStats.fromMap(e);
+                  }
+                } else if (eventName == 'rendition') {
+                  if (mediaInfo.value != null) {
+                    rendition.value = VideoControllerRendition.fromMap(e);
+                  }
+                } else if (eventName == 'quality') {
+                  if (mediaInfo.value != null) {
+                    quality.value = VideoControllerQuality.values[e['value']];
+                  }
+                } else if (eventName == 'openTiming') {
+                  if (mediaInfo.value != null) {
+                    openTiming.value = VideoControllerOpenTiming.fromMap(e);
+                  }
+                } else if (eventName == 'scanEnd') {
+                  if (mediaInfo.value != null) {
+                    scanSpeed.value = 0;
+                  }
                 } else if (eventName == 'finished') {
                   if (mediaInfo.value != null) {
                     finishedTimes.value += 1;
@@ -139,6 +294,33 @@ class VideoControllerImplementation extends VideoController {
                 }
               }
             });
+        if (fastStart.value) {
+          _setFastStart();
+        }
+        if (visibility.value != .visible) {
+          _setVisibility();
+        }
+        if (priority.value != .foreground) {
+          _setPriority();
+        }
+        if (maxFrameRate.value > 0) {
+          _setMaxFrameRate();
+        }
+        if (skipMutedAudio.value) {
+          _setSkipMutedAudio();
+        }
+        if (adaptiveBitRate.value) {
+          _setAdaptiveBitRate();
+        }
+        if (adaptiveQuality.value) {
+          _setAdaptiveQuality();
+        }
+        if (statsInterval.value > 0) {
+          _setStatsInterval();
+        }
+        if (logLevel.value != null) {
+          _setLogLevel();
+        }
         if (_source != null) {
           open(_source!);
           if (_position > 0) {
@@ -155,6 +337,12 @@ class VideoControllerImplementation extends VideoController {
         if (looping.value) {
           _setLooping();
         }
+        if (targetLatency.value > 0) {
+          _setTargetLatency();
+        }
+        if (timeShift.value > 0) {
+          _setTimeShift();
+        }
         if (maxBitRate.value > 0) {
           _setMaxBitRate();
         }
@@ -206,6 +394,7 @@ class VideoControllerImplementation extends VideoController {
       _source = source;
       if (_id != null) {
         error.value = null;
+        errorLogs.value = const [];
         _close();
         _methodChannel.invokeMethod('open', {'id': _id, 'value': source});
       }
@@ -264,11 +453,15 @@ class VideoControllerImplementation extends VideoController {
           });
           return true;
         }
-      } else if (mediaInfo.value!.duration > 0) {
-        if (position < 0) {
-          position = 0;
-        } else if (position > mediaInfo.value!.duration) {
-          position = mediaInfo.value!.duration;
+      } else if (mediaInfo.value!.duration > 0 ||
+          (timeShift.value > 0 && bufferRange.value != .empty)) {
+        final (start, end) = mediaInfo.value!.duration > 0
+            ? (0, mediaInfo.value!.duration)
+            : (bufferRange.value.start, bufferRange.value.end);
+        if (position < start) {
+          position = start;
+        } else if (position > end) {
+          position = end;
         }
         _methodChannel.invokeMethod('seekTo', {
           'id': _id,
@@ -303,8 +496,8 @@ class VideoControllerImplementation extends VideoController {
     if (!disposed && mediaInfo.value?.duration != 0) {
       if (value < 0.5) {
         value = 0.5;
-      } else if (value > 2) {
-        value = 2;
+      } else if (value > (_isLinux ? 64 : 2)) {
+        value = _isLinux ? 64 : 2;
       }
       speed.value = value;
       if (_id != null) {
@@ -315,6 +508,185 @@ class VideoControllerImplementation extends VideoController {
     return false;
   }
 
+  @override
+  setTargetLatency(value) {
+    if (!disposed && _isLinux && value >= 0 && value != targetLatency.value) {
+      targetLatency.value = value;
+      if (_id != null) {
+        _setTargetLatency();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  @override
+  setTimeShift(value) {
+    if (!disposed && _isLinux && value >= 0 && value != timeShift.value) {
+      timeShift.value = value;
+      if (_id != null) {
+        _setTimeShift();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  @override
+  setLogLevel(value) {
+    if (!disposed && _isLinux && value != logLevel.value) {
+      logLevel.value = value;
+      if (_id != null) {
+        _setLogLevel();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  @override
+  getLogs() async {
+    if (!disposed && _isLinux && _id != null) {
+      final result = await _methodChannel.invokeMethod('getLogs', _id);
+      if (result is List) {
+        return result.cast<String>();
+      }
+    }
+    return const [];
+  }
+
+  @override
+  getStats() async {
+    if (!disposed && _isLinux && _id != null) {
+      final result = await _methodChannel.invokeMethod('getStats', _id);
+      if (result is Map) {
+        return VideoControllerStats.fromMap(result);
+      }
+    }
+    return null;
+  }
+
+  @override
+  setStatsInterval(value) {
+    if (!disposed && _isLinux && value >= 0 && value != statsInterval.value) {
+      statsInterval.value = value;
+      if (_id != null) {
+        _setStatsInterval();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  @override
+  setFastStart(value) {
+    if (!disposed && _isLinux && value != fastStart.value) {
+      fastStart.value = value;
+      if (_id != null) {
+        _setFastStart();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  @override
+  setVisibility(value) {
+    if (!disposed && _isLinux && value != visibility.value) {
+      visibility.value = value;
+      if (_id != null) {
+        _setVisibility();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  @override
+  setPriority(value) {
+    if (!disposed && _isLinux && value != priority.value) {
+      priority.value = value;
+      if (_id != null) {
+        _setPriority();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  @override
+  setMaxFrameRate(value) {
+    if (!disposed && _isLinux && value >= 0 && value != maxFrameRate.value) {
+      maxFrameRate.value = value;
+      if (_id != null) {
+        _setMaxFrameRate();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  @override
+  setSkipMutedAudio(value) {
+    if (!disposed && _isLinux && value != skipMutedAudio.value) {
+      skipMutedAudio.value = value;
+      if (_id != null) {
+        _setSkipMutedAudio();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  @override
+  setAdaptiveBitRate(value) {
+    if (!disposed && _isLinux && value != adaptiveBitRate.value) {
+      adaptiveBitRate.value = value;
+      if (_id != null) {
+        _setAdaptiveBitRate();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  @override
+  setAdaptiveQuality(value) {
+    if (!disposed && _isLinux && value != adaptiveQuality.value) {
+      adaptiveQuality.value = value;
+      if (_id != null) {
+        _setAdaptiveQuality();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  @override
+  setScanSpeed(value) {
+    if (!disposed &&
+        _isLinux &&
+        mediaInfo.value != null &&
+        mediaInfo.value!.duration > 0) {
+      if (value.abs() < 2) {
+        value = 0;
+      } else if (value > 64) {
+        value = 64;
+      } else if (value < -64) {
+        value = -64;
+      }
+      if (value != scanSpeed.value) {
+        scanSpeed.value = value;
+        _methodChannel.invokeMethod('setScanSpeed', {
+          'id': _id,
+          'value': value,
+        });
+      }
+      return true;
+    }
+    return false;
+  }
+
   @override
   setLooping(value) {
     if (!disposed && value != looping.value) {
@@ -412,6 +784,21 @@ class VideoControllerImplementation extends VideoController {
     return false;
   }
 
+  @override
+  stepFrame(frames) {
+    if (!disposed &&
+        _isLinux &&
+        frames != 0 &&
+        mediaInfo.value != null &&
+        mediaInfo.value!.duration > 0 &&
+        videoSize.value != .zero) {
+      pause();
+      _methodChannel.invokeMethod('stepFrame', {'id': _id, 'value': frames});
+      return true;
+    }
+    return false;
+  }
+
   @override
   setOverrideAudio(trackId) => _overrideTrack(trackId, true);
 
@@ -477,6 +864,61 @@ class VideoControllerImplementation extends VideoController {
     'value': speed.value,
   });
 
+  void _setTargetLatency() => _methodChannel.invokeMethod('setTargetLatency', {
+    'id': _id,
+    'value': targetLatency.value,
+  });
+
+  void _setLogLevel() => _methodChannel.invokeMethod('setLogLevel', {
+    'id': _id,
+    'value': logLevel.value ?? 'no',
+  });
+
+  void _setStatsInterval() => _methodChannel.invokeMethod('setStatsInterval', {
+    'id': _id,
+    'value': statsInterval.value,
+  });
+
+  void _setFastStart() => _methodChannel.invokeMethod('setFastStart', {
+    'id': _id,
+    'value': fastStart.value,
+  });
+
+  void _setVisibility() => _methodChannel.invokeMethod('setVisibility', {
+    'id': _id,
+    'value': visibility.value.index,
+  });
+
+  void _setPriority() => _methodChannel.invokeMethod('setPriority', {
+    'id': _id,
+    'value': priority.value.index,
+  });
+
+  void _setMaxFrameRate() => _methodChannel.invokeMethod('setMaxFrameRate', {
+    'id': _id,
+    'value': maxFrameRate.value,
+  });
+
+  void _setSkipMutedAudio() => _methodChannel.invokeMethod(
+    'setSkipMutedAudio',
+    {'id': _id, 'value': skipMutedAudio.value},
+  );
+
+  void _setAdaptiveBitRate() => _methodChannel.invokeMethod(
+    'setAdaptiveBitRate',
+    {'id': _id, 'value': adaptiveBitRate.value},
+  );
+
+  void _setAdaptiveQuality() => _methodChannel.invokeMethod(
+    'setAdaptiveQuality',
+    {'id': _id, 'value': adaptiveQuality.value},
+  );
+
+  void _setTimeShift() => _methodChannel.invokeMethod('setTimeShift', {
+    'id': _id,
+    'value': timeShift.value,
+  });
+
   void _setLooping() => _methodChannel.invokeMethod('setLooping', {
     'id': _id,
     'value': looping.value,
@@ -513,6 +955,14 @@ class VideoControllerImplementation extends VideoController {
     mediaInfo.value = null;
     videoSize.value = .zero;
     position.value = 0;
+    scanSpeed.value = 0;
+    liveLatency.value = 0;
+    cacheBytes.value = 0;
+    cacheHitRate.value = 0;
+    openTiming.value = null;
+    stats.value = null;
+    quality.value = .full;
+    rendition.value = null;
     bufferRange.value = .empty;
     finishedTimes.value = 0;
     playbackState.value = .closed;
@@ -112,6 +112,22 @@ class VideoControllerImplementation extends VideoController {
 
   VideoControllerImplementation() : super.create();
 
+  static bool setCachePolicy(int _, int _, String? _) => false;
+
+  static bool setProxy(bool _, int _) => false;
+
+  static bool prefetch(String _, int _) => false;
+
+  static bool startTrace(String _) => false;
+
+  static bool stopTrace() => false;
+
+  static bool setDecoderThreads(int _) => false;
+
+  static bool setMemoryBudget(int _) => false;
+
+  static Future<VideoControllerMemoryReport?> getMemoryReport() async => null;
+
   @override
   dispose() {
     if (!disposed) {
@@ -333,6 +349,51 @@ class VideoControllerImplementation extends VideoController {
     return false;
   }
 
+  @override
+  setTargetLatency(_) => false;
+
+  @override
+  setTimeShift(_) => false;
+
+  @override
+  setLogLevel(_) => false;
+
+  @override
+  getLogs() async => const [];
+
+  @override
+  getStats() async => null;
+
+  @override
+  setStatsInterval(_) => false;
+
+  @override
+  setFastStart(_) => false;
+
+  @override
+  setVisibility(_) => false;
+
+  @override
+  setPriority(_) => false;
+
+  @override
+  setMaxFrameRate(_) => false;
+
+  @override
+  setSkipMutedAudio(_) => false;
+
+  @override
+  setAdaptiveBitRate(_) => false;
+
+  @override
+  setAdaptiveQuality(_) => false;
+
+  @override
+  setScanSpeed(_) => false;
+
+  @override
+  stepFrame(_) => false;
+
   /// Set user assigned styles for the player.
   void setStyle(BoxFit objectFit, Color backgroundColor) {
     if (!disposed) {
@@ -73,6 +73,8 @@ class _VideoViewState extends State<VideoView> {
   var _foreignController = false;
   // This is a workaround for the fullscreen issue on web.
   OverlayEntry? _overlayEntry;
+  // Whether the player is hidden by this widget while it's offstage.
+  var _hiddenOffstage = false;
 
   void _fullscreenChange() {
     if (_controller.displayMode.value != .fullscreen) {
@@ -96,6 +98,17 @@ class _VideoViewState extends State<VideoView> {
 
   void _update() => setState(() {});
 
+  void _updateVisibility(bool onstage) {
+    if (!onstage && _controller.visibility.value == .visible) {
+      _hiddenOffstage = _controller.setVisibility(.hidden);
+    } else if (onstage && _hiddenOffstage) {
+      _hiddenOffstage = false;
+      if (_controller.visibility.value == .hidden) {
+        _controller.setVisibility(.visible);
+      }
+    }
+  }
+
   @pragma('vm:notify-debugger-on-exception')
   void _runOnCreated() {
     if (widget.onCreated != null) {
@@ -169,11 +182,21 @@ class _VideoViewState extends State<VideoView> {
     }
   }
 
+  @override
+  didChangeDependencies() {
+    super.didChangeDependencies();
+    if (!_controller.disposed) {
+      // routes and tabs that are not shown disable tickers of their subtree
+      _updateVisibility(TickerMode.of(context));
+    }
+  }
+
   @override
   dispose() {
     if (!_foreignController) {
       _controller.dispose();
     } else if (!_controller.disposed) {
+      _updateVisibility(true);
       _controller.videoSize.removeListener(_update);
       _controller.showSubtitle.removeListener(_update);
       if (kIsWeb) {
@@ -0,0 +1,133 @@
+// Checks adaptive bit rate switching of the plugin against a local HLS server whose bandwidth is throttled.
+//
+// usage: bench_abr [--hls DIR] [--low BYTES] [--high BYTES] [--phase-seconds S]
+//
+// DIR is a multi-variant fixture created by make_hls.sh, served by a local HTTP server. A looping player with
+// setAdaptiveBitRate plays it while the server rate goes low, high and low again. The player starts on the top
+// rendition, so each phase expects a rendition event switching down to a rendition within the low rate, or up from
+// the rendition of the previous phase. A JSON line is written per rendition event and per phase. The exit code is 1
+// if a phase doesn't see its switch before the phase time runs out.
+
+#include <video_view/video_view_plugin.h>
+#include "bench_flutter.h"
+#include "bench_http.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_PHASES 3
+
+typedef struct {
+	int64_t id; // player whose events are handled, 0 before it's created
+	int64_t bitRate; // bit rate of the last rendition event, 0 before any
+	uint32_t switches; // rendition events in the current phase
+	gint64 phaseStart;
+	int phase;
+	bool error;
+} BenchAbr;
+
+static void bench_on_event(const gchar* channel, FlValue* event, void* userData) {
+	BenchAbr* abr = userData;
+	const gchar* name = bench_event_name(channel, event, abr->id);
+	if (!name) {
+		return;
+	} else if (g_str_equal(name, "error")) {
+		abr->error = true;
+	} else if (g_str_equal(name, "rendition")) {
+		abr->bitRate = fl_value_get_int(fl_value_lookup_string(event, "bitRate"));
+		abr->switches++;
+		printf("{\"phase\":%d,\"ms\":%ld,\"width\":%ld,\"height\":%ld,\"bitRate\":%ld,\"bandwidth\":%ld,\"buffer\":%ld}\n", abr->phase, (g_get_monotonic_time() - abr->phaseStart) / 1000,
+			fl_value_get_int(fl_value_lookup_string(event, "width")), fl_value_get_int(fl_value_lookup_string(event, "height")), abr->bitRate,
+			fl_value_get_int(fl_value_lookup_string(event, "bandwidth")), fl_value_get_int(fl_value_lookup_string(event, "buffer")));
+		fflush(stdout);
+	}
+}
+
+// throttles the server to rate and waits for a switch down within rate, or up from the bit rate before the phase
+static bool bench_phase(BenchAbr* abr, BenchHttp* http, const int64_t rate, const bool up, const double seconds) {
+	const int64_t from = abr->bitRate;
+	bench_http_set_rate(http, rate);
+	abr->switches = 0;
+	abr->phaseStart = g_get_monotonic_time();
+	const gint64 end = abr->phaseStart + (gint64)(seconds * G_USEC_PER_SEC);
+	bool ok = false;
+	while (!ok && !abr->error && g_get_monotonic_time() < end) {
+		g_main_context_iteration(NULL, FALSE);
+		if (!bench_populate_pending()) {
+			g_usleep(1000);
+		}
+		ok = abr->switches > 0 && (up ? abr->bitRate > from : abr->bitRate <= rate * 8);
+	}
+	printf("{\"summary\":true,\"phase\":%d,\"rate\":%ld,\"direction\":\"%s\",\"switches\":%u,\"bitRate\":%ld,\"ms\":%ld,\"ok\":%s}\n", abr->phase, rate, up ? "up" : "down", abr->switches, abr->bitRate,
+		(g_get_monotonic_time() - abr->phaseStart) / 1000, ok ? "true" : "false");
+	fflush(stdout);
+	return ok;
+}
+
+int main(int argc, char** argv) {
+	const gchar* hls = "build/bench/hls";
+	int64_t low = 100 << 10;
+	int64_t high = 1 << 20;
+	double seconds = 60;
+	for (int i = 1; i < argc; i++) {
+		if (i + 1 >= argc) {
+			fprintf(stderr, "usage: %s [--hls DIR] [--low BYTES] [--high BYTES] [--phase-seconds S]\n", argv[0]);
+			return 2;
+		} else if (g_str_equal(argv[i], "--hls")) {
+			hls = argv[++i];
+		} else if (g_str_equal(argv[i], "--low")) {
+			low = MAX(g_ascii_strtoll(argv[++i], NULL, 10), 1);
+		} else if (g_str_equal(argv[i], "--high")) {
+			high = MAX(g_ascii_strtoll(argv[++i], NULL, 10), 1);
+		} else if (g_str_equal(argv[i], "--phase-seconds")) {
+			seconds = g_ascii_strtod(argv[++i], NULL);
+		} else {
+			fprintf(stderr, "unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+	gchar* master = g_build_filename(hls, "index.m3u8", NULL);
+	const bool exists = g_file_test(master, G_FILE_TEST_EXISTS);
+	g_free(master);
+	if (!exists) {
+		fprintf(stderr, "%s/index.m3u8 is missing, create it with make_hls.sh\n", hls);
+		return 1;
+	}
+	if (!bench_egl_init()) {
+		fprintf(stderr, "surfaceless EGL is not available\n");
+		return 1;
+	}
+	video_view_plugin_register_with_registrar(bench_flutter_init());
+	BenchAbr abr = { 0 };
+	bench_set_event_handler(bench_on_event, true, &abr);
+	BenchHttp* http = bench_http_start();
+	bench_http_add_dir(http, "/hls/", hls);
+	bench_http_set_rate(http, high);
+
+	g_autoptr(FlValue) created = bench_invoke("create", NULL);
+	abr.id = fl_value_get_int(fl_value_lookup_string(created, "id"));
+	g_autoptr(FlValue) looping = bench_args(abr.id, fl_value_new_bool(true));
+	bench_call("setLooping", looping);
+	g_autoptr(FlValue) adaptive = bench_args(abr.id, fl_value_new_bool(true));
+	bench_call("setAdaptiveBitRate", adaptive);
+	gchar* source = g_strdup_printf("http://127.0.0.1:%u/hls/index.m3u8", bench_http_port(http));
+	g_autoptr(FlValue) open = bench_args(abr.id, fl_value_new_string(source));
+	g_free(source);
+	bench_call("open", open);
+	g_autoptr(FlValue) play = fl_value_new_int(abr.id);
+	bench_call("play", play);
+
+	const int64_t rates[BENCH_PHASES] = { low, high, low };
+	bool ok = true;
+	for (abr.phase = 0; ok && abr.phase < BENCH_PHASES; abr.phase++) {
+		ok = bench_phase(&abr, http, rates[abr.phase], rates[abr.phase] > low, seconds);
+	}
+	if (abr.error) {
+		fprintf(stderr, "the player reported an error\n");
+	}
+
+	bench_call("dispose", play);
+	abr.id = 0;
+	bench_http_stop(http);
+	bench_egl_terminate();
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,37 @@
+#include "bench_flutter.h"
+
+// Counts heap allocations of each thread by interposing malloc, so stages on the main thread can be measured
+// without noise from decoder threads. glibc exports the real allocator as __libc_*.
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static __thread uint64_t allocCount;
+static __thread uint64_t allocBytes;
+
+void* malloc(size_t size) {
+	allocCount++;
+	allocBytes += size;
+	return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+	allocCount++;
+	allocBytes += count * size;
+	return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+	allocCount++;
+	allocBytes += size;
+	return __libc_realloc(ptr, size);
+}
+
+uint64_t bench_alloc_count(void) {
+	return allocCount;
+}
+
+uint64_t bench_alloc_bytes(void) {
+	return allocBytes;
+}
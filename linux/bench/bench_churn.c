@@ -0,0 +1,257 @@
+// Ramps the number of players and churns them through the method channel of the plugin, like an app with many
+// views coming and going.
+//
+// usage: bench_churn [--video PATH]... [--max-players N] [--step N] [--seconds S] [--rate N] [--interval MS] [--seed N]
+//
+// Players are added by step up to the maximum, each count is churned for some seconds with random seek, pause, play,
+// reopen and dispose/create at the given rate per second, then all players are disposed. Every interval a JSON line
+// is written with main thread busy time, event throughput, RSS, file descriptors, GL objects, main loop sources and
+// registered textures, and a last line compares resources after draining with the baseline. It exits with 1 if
+// sources or textures are left behind.
+
+#include <video_view/video_view_plugin.h>
+#include "bench_flutter.h"
+#include <epoxy/gl.h>
+#include <stdio.h>
+
+#define BENCH_DRAIN_SECONDS 3
+#define BENCH_GL_SCAN 4096 // highest GL object name checked
+
+typedef struct {
+	int64_t id;
+	bool playing;
+} BenchPlayer;
+
+typedef struct {
+	gint64 time;
+	gint64 pollTime; // time blocked in poll
+	gint64 populateTime; // time populating textures, which is the raster thread in an app
+	BenchCounters counters;
+	uint64_t frames;
+} BenchMark;
+
+typedef struct {
+	uint64_t rss;
+	uint32_t fds;
+	uint32_t glTextures;
+	uint32_t glFramebuffers;
+	uint32_t sources;
+	uint32_t textures;
+} BenchResources;
+
+static gchar** videos;
+static uint32_t videoCount;
+static GArray* benchPlayers;
+static GRand* benchRand;
+static gint64 populateTime;
+static uint64_t frames;
+
+static gboolean bench_tick(void* data) {
+	return G_SOURCE_CONTINUE;
+}
+
+static void bench_open(BenchPlayer* player) {
+	g_autoptr(FlValue) args = bench_args(player->id, fl_value_new_string(videos[g_rand_int_range(benchRand, 0, videoCount)]));
+	bench_call("open", args);
+	g_autoptr(FlValue) id = fl_value_new_int(player->id);
+	bench_call("play", id);
+	player->playing = true;
+}
+
+static void bench_add_player(void) {
+	g_autoptr(FlValue) created = bench_invoke("create", NULL);
+	BenchPlayer player = { fl_value_get_int(fl_value_lookup_string(created, "id")), false };
+	g_autoptr(FlValue) args = bench_args(player.id, fl_value_new_bool(true));
+	bench_call("setLooping", args);
+	bench_open(&player);
+	g_array_append_val(benchPlayers, player);
+}
+
+static void bench_remove_player(const uint32_t index) {
+	g_autoptr(FlValue) id = fl_value_new_int(g_array_index(benchPlayers, BenchPlayer, index).id);
+	bench_call("dispose", id);
+	g_array_remove_index_fast(benchPlayers, index);
+}
+
+// one random operation on a random player
+static void bench_churn(void) {
+	const uint32_t index = g_rand_int_range(benchRand, 0, benchPlayers->len);
+	BenchPlayer* player = &g_array_index(benchPlayers, BenchPlayer, index);
+	const int32_t action = g_rand_int_range(benchRand, 0, 100);
+	if (action < 40) {
+		g_autoptr(FlValue) args = bench_args(player->id, NULL);
+		fl_value_set_string_take(args, "position", fl_value_new_int(g_rand_int_range(benchRand, 0, 10000)));
+		fl_value_set_string_take(args, "fast", fl_value_new_bool(g_rand_boolean(benchRand)));
+		bench_call("seekTo", args);
+	} else if (action < 60) {
+		g_autoptr(FlValue) id = fl_value_new_int(player->id);
+		bench_call(player->playing ? "pause" : "play", id);
+		player->playing = !player->playing;
+	} else if (action < 75) {
+		bench_open(player);
+	} else {
+		bench_remove_player(index);
+		bench_add_player();
+	}
+}
+
+static uint32_t bench_count_fds(void) {
+	uint32_t count = 0;
+	GDir* dir = g_dir_open("/proc/self/fd", 0, NULL);
+	if (dir) {
+		while (g_dir_read_name(dir)) {
+			count++;
+		}
+		g_dir_close(dir);
+	}
+	return count - 1; // the directory itself
+}
+
+// sources of the default main context, ids are sequential so all ids below a new one are checked
+static uint32_t bench_count_sources(void) {
+	const guint last = g_idle_add(bench_tick, NULL);
+	g_source_remove(last);
+	uint32_t count = 0;
+	for (guint id = 1; id < last; id++) {
+		if (g_main_context_find_source_by_id(NULL, id)) {
+			count++;
+		}
+	}
+	return count;
+}
+
+static void bench_collect(BenchResources* resources) {
+	resources->rss = bench_rss();
+	resources->fds = bench_count_fds();
+	resources->glTextures = resources->glFramebuffers = 0;
+	bench_egl_make_current();
+	for (GLuint name = 1; name <= BENCH_GL_SCAN; name++) {
+		resources->glTextures += glIsTexture(name) ? 1 : 0;
+		resources->glFramebuffers += glIsFramebuffer(name) ? 1 : 0;
+	}
+	resources->sources = bench_count_sources();
+	resources->textures = bench_texture_count();
+}
+
+static void bench_mark(BenchMark* mark) {
+	mark->time = g_get_monotonic_time();
+	mark->pollTime = bench_poll_time();
+	mark->populateTime = populateTime;
+	mark->counters = benchCounters;
+	mark->frames = frames;
+}
+
+static void bench_sample(BenchMark* last, const gint64 start, const gchar* phase) {
+	BenchMark mark;
+	bench_mark(&mark);
+	BenchResources resources;
+	bench_collect(&resources);
+	const double seconds = (mark.time - last->time) / 1e6;
+	const gint64 elapsed = mark.time - last->time;
+	const gint64 busy = elapsed - (mark.pollTime - last->pollTime) - (mark.populateTime - last->populateTime);
+	printf("{\"time\":%.3f,\"phase\":\"%s\",\"players\":%u,\"busy\":%.4f,\"raster\":%.4f,\"events\":%.1f,\"eventBytes\":%.1f,\"methodCalls\":%.1f,\"frames\":%.1f,"
+		"\"rss\":%lu,\"fds\":%u,\"glTextures\":%u,\"glFramebuffers\":%u,\"sources\":%u,\"textures\":%u}\n",
+		(mark.time - start) / 1e6, phase, benchPlayers->len, (double)busy / elapsed, (double)(mark.populateTime - last->populateTime) / elapsed,
+		(mark.counters.events - last->counters.events) / seconds, (mark.counters.eventBytes - last->counters.eventBytes) / seconds,
+		(mark.counters.methodCalls - last->counters.methodCalls) / seconds, (mark.frames - last->frames) / seconds,
+		resources.rss, resources.fds, resources.glTextures, resources.glFramebuffers, resources.sources, resources.textures);
+	fflush(stdout);
+	// the next interval starts after sampling
+	bench_mark(last);
+}
+
+// runs the main loop for some seconds like the engine does, optionally churning players at a rate per second
+static void bench_run(const double seconds, const uint32_t rate, const gint64 interval, BenchMark* last, const gint64 start, const gchar* phase) {
+	const gint64 end = g_get_monotonic_time() + (gint64)(seconds * 1e6);
+	gint64 nextChurn = g_get_monotonic_time();
+	for (gint64 now = g_get_monotonic_time(); now < end; now = g_get_monotonic_time()) {
+		g_main_context_iteration(NULL, TRUE);
+		const gint64 populateStart = g_get_monotonic_time();
+		frames += bench_populate_pending();
+		populateTime += g_get_monotonic_time() - populateStart;
+		if (rate && benchPlayers->len && now >= nextChurn) {
+			bench_churn();
+			nextChurn += G_USEC_PER_SEC / rate;
+		}
+		if (now - last->time >= interval) {
+			bench_sample(last, start, phase);
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	GPtrArray* videoList = g_ptr_array_new();
+	uint32_t maxPlayers = 64;
+	uint32_t step = 8;
+	double seconds = 10;
+	uint32_t rate = 20;
+	gint64 interval = 1000;
+	guint32 seed = 1;
+	for (int i = 1; i < argc; i++) {
+		if (i + 1 >= argc) {
+			fprintf(stderr, "usage: %s [--video PATH]... [--max-players N] [--step N] [--seconds S] [--rate N] [--interval MS] [--seed N]\n", argv[0]);
+			return 2;
+		} else if (g_str_equal(argv[i], "--video")) {
+			g_ptr_array_add(videoList, argv[++i]);
+		} else if (g_str_equal(argv[i], "--max-players")) {
+			maxPlayers = (uint32_t)g_ascii_strtoull(argv[++i], NULL, 10);
+		} else if (g_str_equal(argv[i], "--step")) {
+			step = MAX((uint32_t)g_ascii_strtoull(argv[++i], NULL, 10), 1);
+		} else if (g_str_equal(argv[i], "--seconds")) {
+			seconds = g_ascii_strtod(argv[++i], NULL);
+		} else if (g_str_equal(argv[i], "--rate")) {
+			rate = (uint32_t)g_ascii_strtoull(argv[++i], NULL, 10);
+		} else if (g_str_equal(argv[i], "--interval")) {
+			interval = MAX(g_ascii_strtoll(argv[++i], NULL, 10), 10);
+		} else if (g_str_equal(argv[i], "--seed")) {
+			seed = (guint32)g_ascii_strtoull(argv[++i], NULL, 10);
+		} else {
+			fprintf(stderr, "unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+	if (videoList->len == 0) {
+		g_ptr_array_add(videoList, (gchar*)BENCH_VIDEO);
+	}
+	videoCount = videoList->len;
+	g_ptr_array_add(videoList, NULL);
+	videos = (gchar**)g_ptr_array_free(videoList, FALSE);
+	if (!bench_egl_init()) {
+		fprintf(stderr, "surfaceless EGL is not available\n");
+		return 1;
+	}
+	bench_track_poll();
+	video_view_plugin_register_with_registrar(bench_flutter_init());
+	benchPlayers = g_array_new(FALSE, FALSE, sizeof(BenchPlayer));
+	benchRand = g_rand_new_with_seed(seed);
+	// wakes the loop up for churn and samples when nothing else happens
+	g_timeout_add(rate ? MAX(1000 / rate, 1) : interval, bench_tick, NULL);
+
+	BenchResources baseline;
+	bench_collect(&baseline);
+	BenchMark last;
+	bench_mark(&last);
+	const gint64 start = last.time;
+	for (uint32_t count = MIN(step, maxPlayers); count <= maxPlayers && count > 0; count += step) {
+		while (benchPlayers->len < count) {
+			bench_add_player();
+		}
+		bench_run(seconds, rate, interval * 1000, &last, start, "churn");
+	}
+	while (benchPlayers->len) {
+		bench_remove_player(benchPlayers->len - 1);
+	}
+	bench_run(BENCH_DRAIN_SECONDS, 0, interval * 1000, &last, start, "drain");
+
+	BenchResources drained;
+	bench_collect(&drained);
+	const bool leaked = drained.sources > baseline.sources || drained.textures > baseline.textures;
+	printf("{\"summary\":true,\"leaked\":%s,\"rss\":[%lu,%lu],\"fds\":[%u,%u],\"glTextures\":[%u,%u],\"glFramebuffers\":[%u,%u],\"sources\":[%u,%u],\"textures\":[%u,%u]}\n",
+		leaked ? "true" : "false", baseline.rss, drained.rss, baseline.fds, drained.fds, baseline.glTextures, drained.glTextures,
+		baseline.glFramebuffers, drained.glFramebuffers, baseline.sources, drained.sources, baseline.textures, drained.textures);
+	g_array_free(benchPlayers, TRUE);
+	g_rand_free(benchRand);
+	g_free(videos);
+	bench_egl_terminate();
+	return leaked ? 1 : 0;
+}
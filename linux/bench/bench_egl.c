@@ -0,0 +1,65 @@
+#include "bench_flutter.h"
+#include <epoxy/egl.h>
+
+// A surfaceless EGL context standing in for the one of Flutter's raster thread, it needs no window or GPU.
+
+static EGLDisplay display = EGL_NO_DISPLAY;
+static EGLContext context = EGL_NO_CONTEXT;
+
+bool bench_egl_init(void) {
+	if (epoxy_has_egl_extension(EGL_NO_DISPLAY, "EGL_MESA_platform_surfaceless")) {
+		display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	}
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+		display = EGL_NO_DISPLAY;
+		return false;
+	}
+	eglBindAPI(EGL_OPENGL_ES_API);
+	const EGLint configAttribs[] = {
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_ALPHA_SIZE, 8,
+		EGL_NONE
+	};
+	EGLConfig config = NULL;
+	EGLint numConfigs = 0;
+	if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs <= 0) {
+		bench_egl_terminate();
+		return false;
+	}
+	const EGLint contextAttribs[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+	context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+	if (context == EGL_NO_CONTEXT) {
+		bench_egl_terminate();
+		return false;
+	}
+	bench_egl_make_current();
+	return true;
+}
+
+void bench_egl_make_current(void) {
+	if (context != EGL_NO_CONTEXT && eglGetCurrentContext() != context) {
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+	}
+}
+
+// players opened without a current context fall back to software rendering
+void bench_egl_release(void) {
+	if (display != EGL_NO_DISPLAY) {
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	}
+}
+
+void bench_egl_terminate(void) {
+	if (display != EGL_NO_DISPLAY) {
+		bench_egl_release();
+		if (context != EGL_NO_CONTEXT) {
+			eglDestroyContext(display, context);
+			context = EGL_NO_CONTEXT;
+		}
+		eglTerminate(display);
+		display = EGL_NO_DISPLAY;
+	}
+}
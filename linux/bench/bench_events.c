@@ -0,0 +1,204 @@
+// Measures the overhead of the plugin itself, with fake_mpv.c in place of libmpv.
+//
+// usage: bench_events [--players N] [--seconds S] [--frame-rate R] [--time-rate R] [--cache-rate R] [--reconfig-rate R]
+//                     [--restart-rate R] [--log-rate R] [--trace PATH] [--calls N] [--max-event-us X]
+//                     [--max-frame-us X] [--max-method-us X] [--max-dropped N]
+//
+// Players are opened on a scripted media, or on a trace recorded by bench_record, and the main loop runs for some
+// seconds like the engine does. The main thread busy time is divided by the mpv events the plugin handled, and
+// populate time by the frames it populated. Then each method in a fixed set is called repeatedly through the method
+// channel, which includes encoding and decoding the call like the engine. One JSON object is written, and the exit
+// code is 1 if a threshold is exceeded, so it can gate regressions.
+
+#include <video_view/video_view_plugin.h>
+#include "bench_flutter.h"
+#include "fake_mpv.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+	const gchar* name;
+	bool map; // arguments are a map with id, otherwise the id
+	const gchar* key;
+	FlValueType type;
+} BenchMethod;
+
+static const BenchMethod benchMethods[] = {
+	{ "setVolume", true, "value", FL_VALUE_TYPE_FLOAT },
+	{ "setSpeed", true, "value", FL_VALUE_TYPE_FLOAT },
+	{ "setLooping", true, "value", FL_VALUE_TYPE_BOOL },
+	{ "seekTo", true, "position", FL_VALUE_TYPE_INT },
+	{ "pause", false, NULL, FL_VALUE_TYPE_NULL },
+	{ "play", false, NULL, FL_VALUE_TYPE_NULL },
+	{ "getStats", false, NULL, FL_VALUE_TYPE_NULL },
+};
+
+static FlValue* bench_method_args(const BenchMethod* method, const int64_t id, const uint32_t i) {
+	if (!method->map) {
+		return fl_value_new_int(id);
+	}
+	FlValue* args = fl_value_new_map();
+	fl_value_set_string_take(args, "id", fl_value_new_int(id));
+	if (method->type == FL_VALUE_TYPE_FLOAT) {
+		fl_value_set_string_take(args, method->key, fl_value_new_float(1.0));
+	} else if (method->type == FL_VALUE_TYPE_BOOL) {
+		fl_value_set_string_take(args, method->key, fl_value_new_bool(true));
+	} else {
+		fl_value_set_string_take(args, method->key, fl_value_new_int((i * 997) % 50000));
+		fl_value_set_string_take(args, "fast", fl_value_new_bool(true));
+	}
+	return args;
+}
+
+// returns the worst average in microseconds of the methods
+static double bench_methods(const int64_t id, const uint32_t calls) {
+	gint64* times = g_new(gint64, calls);
+	double worst = 0;
+	printf(",\"methods\":{");
+	for (uint32_t m = 0; m < G_N_ELEMENTS(benchMethods); m++) {
+		const BenchMethod* method = &benchMethods[m];
+		gint64 sum = 0;
+		for (uint32_t i = 0; i < calls; i++) {
+			g_autoptr(FlValue) args = bench_method_args(method, id, i);
+			const gint64 start = g_get_monotonic_time();
+			g_autoptr(FlValue) result = bench_invoke(method->name, args);
+			times[i] = g_get_monotonic_time() - start;
+			sum += times[i];
+			// events caused by the call are part of its cost
+			while (g_main_context_iteration(NULL, FALSE)) {}
+		}
+		qsort(times, calls, sizeof(gint64), bench_compare_int64);
+		const double avg = (double)sum / calls;
+		worst = MAX(worst, avg);
+		printf("%s\"%s\":{\"avg\":%.2f,\"p99\":%ld}", m ? "," : "", method->name, avg, times[calls - 1 - calls / 100]);
+	}
+	printf("}");
+	g_free(times);
+	return worst;
+}
+
+int main(int argc, char** argv) {
+	FakeMpvScript script;
+	fake_mpv_get_script(&script);
+	uint32_t playerCount = 16;
+	double seconds = 5;
+	uint32_t calls = 2000;
+	const gchar* trace = NULL;
+	double maxEventUs = 0;
+	double maxFrameUs = 0;
+	double maxMethodUs = 0;
+	int64_t maxDropped = -1;
+	for (int i = 1; i < argc; i++) {
+		if (i + 1 >= argc) {
+			fprintf(stderr, "usage: see the top of bench_events.c\n");
+			return 2;
+		} else if (g_str_equal(argv[i], "--players")) {
+			playerCount = MAX((uint32_t)g_ascii_strtoull(argv[++i], NULL, 10), 1);
+		} else if (g_str_equal(argv[i], "--seconds")) {
+			seconds = g_ascii_strtod(argv[++i], NULL);
+		} else if (g_str_equal(argv[i], "--frame-rate")) {
+			script.frameRate = g_ascii_strtod(argv[++i], NULL);
+		} else if (g_str_equal(argv[i], "--time-rate")) {
+			script.timeRate = g_ascii_strtod(argv[++i], NULL);
+		} else if (g_str_equal(argv[i], "--cache-rate")) {
+			script.cacheRate = g_ascii_strtod(argv[++i], NULL);
+		} else if (g_str_equal(argv[i], "--reconfig-rate")) {
+			script.reconfigRate = g_ascii_strtod(argv[++i], NULL);
+		} else if (g_str_equal(argv[i], "--restart-rate")) {
+			script.restartRate = g_ascii_strtod(argv[++i], NULL);
+		} else if (g_str_equal(argv[i], "--log-rate")) {
+			script.logRate = g_ascii_strtod(argv[++i], NULL);
+		} else if (g_str_equal(argv[i], "--trace")) {
+			trace = argv[++i];
+		} else if (g_str_equal(argv[i], "--calls")) {
+			calls = MAX((uint32_t)g_ascii_strtoull(argv[++i], NULL, 10), 1);
+		} else if (g_str_equal(argv[i], "--max-event-us")) {
+			maxEventUs = g_ascii_strtod(argv[++i], NULL);
+		} else if (g_str_equal(argv[i], "--max-frame-us")) {
+			maxFrameUs = g_ascii_strtod(argv[++i], NULL);
+		} else if (g_str_equal(argv[i], "--max-method-us")) {
+			maxMethodUs = g_ascii_strtod(argv[++i], NULL);
+		} else if (g_str_equal(argv[i], "--max-dropped")) {
+			maxDropped = g_ascii_strtoll(argv[++i], NULL, 10);
+		} else {
+			fprintf(stderr, "unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+	fake_mpv_set_script(&script);
+	if (trace && !fake_mpv_load_trace(trace)) {
+		fprintf(stderr, "failed to load trace %s\n", trace);
+		return 1;
+	}
+	if (!bench_egl_init()) {
+		fprintf(stderr, "surfaceless EGL is not available\n");
+		return 1;
+	}
+	bench_track_poll();
+	video_view_plugin_register_with_registrar(bench_flutter_init());
+	int64_t* ids = g_new(int64_t, playerCount);
+	for (uint32_t i = 0; i < playerCount; i++) {
+		g_autoptr(FlValue) created = bench_invoke("create", NULL);
+		ids[i] = fl_value_get_int(fl_value_lookup_string(created, "id"));
+		g_autoptr(FlValue) args = fl_value_new_map();
+		fl_value_set_string_take(args, "id", fl_value_new_int(ids[i]));
+		fl_value_set_string_take(args, "value", fl_value_new_string(script.logRate > 0 ? "info" : "no"));
+		g_autoptr(FlValue) logged = bench_invoke("setLogLevel", args);
+		fl_value_set_string_take(args, "value", fl_value_new_string("fake.mp4"));
+		g_autoptr(FlValue) opened = bench_invoke("open", args);
+		g_autoptr(FlValue) id = fl_value_new_int(ids[i]);
+		g_autoptr(FlValue) played = bench_invoke("play", id);
+	}
+
+	FakeMpvCounters counters;
+	fake_mpv_get_counters(&counters);
+	const uint64_t events = counters.events;
+	const uint64_t dropped = counters.dropped;
+	const uint64_t benchEvents = benchCounters.events;
+	const gint64 pollTime = bench_poll_time();
+	const gint64 start = g_get_monotonic_time();
+	const gint64 end = start + (gint64)(seconds * G_USEC_PER_SEC);
+	gint64 populateTime = 0;
+	uint64_t frames = 0;
+	while (g_get_monotonic_time() < end) {
+		g_main_context_iteration(NULL, TRUE);
+		const gint64 populateStart = g_get_monotonic_time();
+		frames += bench_populate_pending();
+		populateTime += g_get_monotonic_time() - populateStart;
+	}
+	const gint64 elapsed = g_get_monotonic_time() - start;
+	const gint64 busy = elapsed - (bench_poll_time() - pollTime) - populateTime;
+	fake_mpv_get_counters(&counters);
+	const uint64_t handled = counters.events - events;
+	const double eventUs = handled ? (double)busy / handled : 0;
+	const double frameUs = frames ? (double)populateTime / frames : 0;
+	printf("{\"players\":%u,\"seconds\":%.3f,\"mpvEvents\":%lu,\"mpvEventRate\":%.1f,\"clientEvents\":%lu,\"dropped\":%lu,\"flutterEvents\":%lu,"
+		"\"busy\":%.4f,\"eventUs\":%.3f,\"frames\":%lu,\"frameUs\":%.3f,\"renders\":%lu",
+		playerCount, elapsed / 1e6, handled, handled / (elapsed / 1e6), counters.clientEvents, counters.dropped - dropped,
+		benchCounters.events - benchEvents, (double)busy / elapsed, eventUs, frames, frameUs, counters.renders);
+	const double methodUs = bench_methods(ids[0], calls);
+	printf("}\n");
+
+	int failed = 0;
+	if (maxEventUs > 0 && eventUs > maxEventUs) {
+		fprintf(stderr, "event overhead %.3fus exceeds %.3fus\n", eventUs, maxEventUs);
+		failed++;
+	}
+	if (maxFrameUs > 0 && frameUs > maxFrameUs) {
+		fprintf(stderr, "frame overhead %.3fus exceeds %.3fus\n", frameUs, maxFrameUs);
+		failed++;
+	}
+	if (maxMethodUs > 0 && methodUs > maxMethodUs) {
+		fprintf(stderr, "method overhead %.3fus exceeds %.3fus\n", methodUs, maxMethodUs);
+		failed++;
+	}
+	if (maxDropped >= 0 && counters.dropped - dropped > (uint64_t)maxDropped) {
+		fprintf(stderr, "%lu mpv events dropped, more than %ld\n", counters.dropped - dropped, maxDropped);
+		failed++;
+	}
+	g_autoptr(FlValue) all = fl_value_new_null();
+	g_autoptr(FlValue) disposed = bench_invoke("dispose", all);
+	g_free(ids);
+	bench_egl_terminate();
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,397 @@
+#include "bench_flutter.h"
+#include <stdio.h>
+#include <unistd.h>
+
+// Stub implementations of the engine side interfaces used by the plugin.
+// Method calls on the plugin channel are dispatched synchronously, and messages without reply are counted as events.
+
+BenchCounters benchCounters;
+
+typedef struct {
+	FlBinaryMessengerMessageHandler handler;
+	gpointer userData;
+	GDestroyNotify destroyNotify;
+} BenchHandler;
+
+static void bench_handler_free(void* data) {
+	BenchHandler* handler = data;
+	if (handler->destroyNotify) {
+		handler->destroyNotify(handler->userData);
+	}
+	g_free(handler);
+}
+
+/* response handle */
+
+G_DECLARE_FINAL_TYPE(BenchResponseHandle, bench_response_handle, BENCH, RESPONSE_HANDLE, FlBinaryMessengerResponseHandle)
+
+struct _BenchResponseHandle {
+	FlBinaryMessengerResponseHandle parent_instance;
+	GTask* task;
+};
+
+G_DEFINE_TYPE(BenchResponseHandle, bench_response_handle, fl_binary_messenger_response_handle_get_type())
+
+static void bench_response_handle_dispose(GObject* object) {
+	BenchResponseHandle* self = BENCH_RESPONSE_HANDLE(object);
+	if (self->task) {
+		g_task_return_pointer(self->task, NULL, NULL);
+		g_clear_object(&self->task);
+	}
+	G_OBJECT_CLASS(bench_response_handle_parent_class)->dispose(object);
+}
+
+static void bench_response_handle_class_init(BenchResponseHandleClass* klass) {
+	G_OBJECT_CLASS(klass)->dispose = bench_response_handle_dispose;
+}
+
+static void bench_response_handle_init(BenchResponseHandle* self) {}
+
+/* messenger */
+
+G_DECLARE_FINAL_TYPE(BenchMessenger, bench_messenger, BENCH, MESSENGER, GObject)
+
+struct _BenchMessenger {
+	GObject parent_instance;
+	GHashTable* handlers; // message handlers by channel
+	BenchEventHandler eventHandler;
+	void* eventUserData;
+	bool decodeEvents;
+};
+
+static void bench_messenger_iface_init(FlBinaryMessengerInterface* iface);
+
+G_DEFINE_TYPE_WITH_CODE(BenchMessenger, bench_messenger, G_TYPE_OBJECT, G_IMPLEMENT_INTERFACE(fl_binary_messenger_get_type(), bench_messenger_iface_init))
+
+static FlMethodCodec* benchCodec;
+static FlMethodChannel* benchChannel;
+
+static void bench_messenger_set_message_handler_on_channel(FlBinaryMessenger* messenger, const gchar* channel, FlBinaryMessengerMessageHandler handler, gpointer userData, GDestroyNotify destroyNotify) {
+	BenchMessenger* self = BENCH_MESSENGER(messenger);
+	if (handler) {
+		BenchHandler* h = g_new0(BenchHandler, 1);
+		h->handler = handler;
+		h->userData = userData;
+		h->destroyNotify = destroyNotify;
+		g_hash_table_replace(self->handlers, g_strdup(channel), h);
+	} else {
+		g_hash_table_remove(self->handlers, channel);
+	}
+}
+
+static gboolean bench_messenger_send_response(FlBinaryMessenger* messenger, FlBinaryMessengerResponseHandle* responseHandle, GBytes* response, GError** error) {
+	BenchResponseHandle* handle = BENCH_RESPONSE_HANDLE(responseHandle);
+	if (handle->task) {
+		g_task_return_pointer(handle->task, response ? g_bytes_ref(response) : NULL, (GDestroyNotify)g_bytes_unref);
+		g_clear_object(&handle->task);
+	}
+	return TRUE;
+}
+
+static void bench_messenger_send_on_channel(FlBinaryMessenger* messenger, const gchar* channel, GBytes* message, GCancellable* cancellable, GAsyncReadyCallback callback, gpointer userData) {
+	BenchMessenger* self = BENCH_MESSENGER(messenger);
+	BenchHandler* handler = callback ? g_hash_table_lookup(self->handlers, channel) : NULL;
+	if (handler) {
+		benchCounters.methodCalls++;
+		BenchResponseHandle* handle = g_object_new(bench_response_handle_get_type(), NULL);
+		handle->task = g_task_new(messenger, cancellable, callback, userData);
+		handler->handler(messenger, channel, message, FL_BINARY_MESSENGER_RESPONSE_HANDLE(handle), handler->userData);
+		g_object_unref(handle);
+		return;
+	}
+	benchCounters.events++;
+	benchCounters.eventBytes += message ? g_bytes_get_size(message) : 0;
+	if (self->eventHandler) {
+		FlValue* event = NULL;
+		if (self->decodeEvents && message) {
+			g_autoptr(FlMethodResponse) response = FL_METHOD_CODEC_GET_CLASS(benchCodec)->decode_response(benchCodec, message, NULL);
+			if (response && FL_IS_METHOD_SUCCESS_RESPONSE(response)) {
+				event = fl_method_success_response_get_result(FL_METHOD_SUCCESS_RESPONSE(response));
+			}
+			self->eventHandler(channel, event, self->eventUserData);
+		} else {
+			self->eventHandler(channel, NULL, self->eventUserData);
+		}
+	}
+	if (callback) {
+		GTask* task = g_task_new(messenger, cancellable, callback, userData);
+		g_task_return_pointer(task, NULL, NULL);
+		g_object_unref(task);
+	}
+}
+
+static GBytes* bench_messenger_send_on_channel_finish(FlBinaryMessenger* messenger, GAsyncResult* result, GError** error) {
+	return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void bench_messenger_resize_channel(FlBinaryMessenger* messenger, const gchar* channel, int64_t size) {}
+
+static void bench_messenger_set_warns_on_channel_overflow(FlBinaryMessenger* messenger, const gchar* channel, bool warns) {}
+
+static void bench_messenger_iface_init(FlBinaryMessengerInterface* iface) {
+	iface->set_message_handler_on_channel = bench_messenger_set_message_handler_on_channel;
+	iface->send_response = bench_messenger_send_response;
+	iface->send_on_channel = bench_messenger_send_on_channel;
+	iface->send_on_channel_finish = bench_messenger_send_on_channel_finish;
+	iface->resize_channel = bench_messenger_resize_channel;
+	iface->set_warns_on_channel_overflow = bench_messenger_set_warns_on_channel_overflow;
+}
+
+static void bench_messenger_class_init(BenchMessengerClass* klass) {}
+
+static void bench_messenger_init(BenchMessenger* self) {
+	self->handlers = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, bench_handler_free);
+}
+
+/* texture registrar */
+
+G_DECLARE_FINAL_TYPE(BenchTextureRegistrar, bench_texture_registrar, BENCH, TEXTURE_REGISTRAR, GObject)
+
+struct _BenchTextureRegistrar {
+	GObject parent_instance;
+	GMutex mutex; // frames are marked available from mpv threads
+	GHashTable* textures;
+	GHashTable* pending;
+};
+
+static void bench_texture_registrar_iface_init(FlTextureRegistrarInterface* iface);
+
+G_DEFINE_TYPE_WITH_CODE(BenchTextureRegistrar, bench_texture_registrar, G_TYPE_OBJECT, G_IMPLEMENT_INTERFACE(fl_texture_registrar_get_type(), bench_texture_registrar_iface_init))
+
+static gboolean bench_texture_registrar_register_texture(FlTextureRegistrar* registrar, FlTexture* texture) {
+	BenchTextureRegistrar* self = BENCH_TEXTURE_REGISTRAR(registrar);
+	g_mutex_lock(&self->mutex);
+	g_hash_table_add(self->textures, texture);
+	g_mutex_unlock(&self->mutex);
+	return TRUE;
+}
+
+static FlTexture* bench_texture_registrar_lookup_texture(FlTextureRegistrar* registrar, int64_t id) {
+	return NULL;
+}
+
+static gboolean bench_texture_registrar_mark_texture_frame_available(FlTextureRegistrar* registrar, FlTexture* texture) {
+	BenchTextureRegistrar* self = BENCH_TEXTURE_REGISTRAR(registrar);
+	g_mutex_lock(&self->mutex);
+	if (g_hash_table_contains(self->textures, texture)) {
+		g_hash_table_add(self->pending, texture);
+	}
+	g_mutex_unlock(&self->mutex);
+	g_main_context_wakeup(NULL);
+	return TRUE;
+}
+
+static gboolean bench_texture_registrar_unregister_texture(FlTextureRegistrar* registrar, FlTexture* texture) {
+	BenchTextureRegistrar* self = BENCH_TEXTURE_REGISTRAR(registrar);
+	g_mutex_lock(&self->mutex);
+	g_hash_table_remove(self->textures, texture);
+	g_hash_table_remove(self->pending, texture);
+	g_mutex_unlock(&self->mutex);
+	return TRUE;
+}
+
+static void bench_texture_registrar_iface_init(FlTextureRegistrarInterface* iface) {
+	iface->register_texture = bench_texture_registrar_register_texture;
+	iface->lookup_texture = bench_texture_registrar_lookup_texture;
+	iface->mark_texture_frame_available = bench_texture_registrar_mark_texture_frame_available;
+	iface->unregister_texture = bench_texture_registrar_unregister_texture;
+}
+
+static void bench_texture_registrar_class_init(BenchTextureRegistrarClass* klass) {}
+
+static void bench_texture_registrar_init(BenchTextureRegistrar* self) {
+	g_mutex_init(&self->mutex);
+	self->textures = g_hash_table_new(NULL, NULL);
+	self->pending = g_hash_table_new(NULL, NULL);
+}
+
+/* plugin registrar */
+
+G_DECLARE_FINAL_TYPE(BenchRegistrar, bench_registrar, BENCH, REGISTRAR, GObject)
+
+struct _BenchRegistrar {
+	GObject parent_instance;
+	BenchMessenger* messenger;
+	BenchTextureRegistrar* textureRegistrar;
+};
+
+static void bench_registrar_iface_init(FlPluginRegistrarInterface* iface);
+
+G_DEFINE_TYPE_WITH_CODE(BenchRegistrar, bench_registrar, G_TYPE_OBJECT, G_IMPLEMENT_INTERFACE(fl_plugin_registrar_get_type(), bench_registrar_iface_init))
+
+static FlBinaryMessenger* bench_registrar_get_messenger(FlPluginRegistrar* registrar) {
+	return FL_BINARY_MESSENGER(BENCH_REGISTRAR(registrar)->messenger);
+}
+
+static FlTextureRegistrar* bench_registrar_get_texture_registrar(FlPluginRegistrar* registrar) {
+	return FL_TEXTURE_REGISTRAR(BENCH_REGISTRAR(registrar)->textureRegistrar);
+}
+
+// there is no view, so players only render with the EGL context current when they are opened
+static FlView* bench_registrar_get_view(FlPluginRegistrar* registrar) {
+	return NULL;
+}
+
+static void bench_registrar_iface_init(FlPluginRegistrarInterface* iface) {
+	iface->get_messenger = bench_registrar_get_messenger;
+	iface->get_texture_registrar = bench_registrar_get_texture_registrar;
+	iface->get_view = bench_registrar_get_view;
+}
+
+static void bench_registrar_class_init(BenchRegistrarClass* klass) {}
+
+static void bench_registrar_init(BenchRegistrar* self) {
+	self->messenger = g_object_new(bench_messenger_get_type(), NULL);
+	self->textureRegistrar = g_object_new(bench_texture_registrar_get_type(), NULL);
+}
+
+/* helpers */
+
+static BenchRegistrar* benchRegistrar;
+
+FlPluginRegistrar* bench_flutter_init(void) {
+	if (!benchRegistrar) {
+		benchRegistrar = g_object_new(bench_registrar_get_type(), NULL);
+		benchCodec = FL_METHOD_CODEC(fl_standard_method_codec_new());
+		benchChannel = fl_method_channel_new(FL_BINARY_MESSENGER(benchRegistrar->messenger), "VideoViewPlugin", benchCodec);
+	}
+	return FL_PLUGIN_REGISTRAR(benchRegistrar);
+}
+
+void bench_set_event_handler(BenchEventHandler handler, bool decode, void* userData) {
+	benchRegistrar->messenger->eventHandler = handler;
+	benchRegistrar->messenger->decodeEvents = decode;
+	benchRegistrar->messenger->eventUserData = userData;
+}
+
+const gchar* bench_event_name(const gchar* channel, FlValue* event, const int64_t id) {
+	gchar* expected = g_strdup_printf("VideoViewPlugin/%ld", id);
+	const bool matched = event && g_str_equal(channel, expected) && fl_value_get_type(event) == FL_VALUE_TYPE_MAP;
+	g_free(expected);
+	FlValue* name = matched ? fl_value_lookup_string(event, "event") : NULL;
+	return name && fl_value_get_type(name) == FL_VALUE_TYPE_STRING ? fl_value_get_string(name) : NULL;
+}
+
+typedef struct {
+	FlValue* result;
+	bool done;
+} BenchInvocation;
+
+static void bench_invoke_callback(GObject* object, GAsyncResult* result, gpointer userData) {
+	BenchInvocation* invocation = userData;
+	g_autoptr(FlMethodResponse) response = fl_method_channel_invoke_method_finish(FL_METHOD_CHANNEL(object), result, NULL);
+	if (response && FL_IS_METHOD_SUCCESS_RESPONSE(response)) {
+		invocation->result = fl_value_ref(fl_method_success_response_get_result(FL_METHOD_SUCCESS_RESPONSE(response)));
+	}
+	invocation->done = true;
+}
+
+FlValue* bench_invoke(const gchar* method, FlValue* args) {
+	BenchInvocation invocation = { NULL, false };
+	fl_method_channel_invoke_method(benchChannel, method, args, NULL, bench_invoke_callback, &invocation);
+	while (!invocation.done) {
+		g_main_context_iteration(NULL, TRUE);
+	}
+	return invocation.result;
+}
+
+void bench_call(const gchar* method, FlValue* args) {
+	FlValue* result = bench_invoke(method, args);
+	if (result) {
+		fl_value_unref(result);
+	}
+}
+
+FlValue* bench_args(const int64_t id, FlValue* value) {
+	FlValue* args = fl_value_new_map();
+	fl_value_set_string_take(args, "id", fl_value_new_int(id));
+	if (value) {
+		fl_value_set_string_take(args, "value", value);
+	}
+	return args;
+}
+
+uint32_t bench_populate_pending(void) {
+	BenchTextureRegistrar* registrar = benchRegistrar->textureRegistrar;
+	g_mutex_lock(&registrar->mutex);
+	GList* textures = g_hash_table_get_keys(registrar->pending);
+	g_hash_table_steal_all(registrar->pending);
+	g_mutex_unlock(&registrar->mutex);
+	uint32_t count = 0;
+	if (textures) {
+		// the raster thread always has its context current when populating
+		bench_egl_make_current();
+		for (GList* item = textures; item; item = item->next) {
+			uint32_t target, name, width, height;
+			FlTextureGL* texture = FL_TEXTURE_GL(item->data);
+			if (FL_TEXTURE_GL_GET_CLASS(texture)->populate(texture, &target, &name, &width, &height, NULL)) {
+				count++;
+			}
+		}
+		g_list_free(textures);
+	}
+	benchCounters.frames += count;
+	return count;
+}
+
+bool bench_take_frame(FlTexture* texture) {
+	BenchTextureRegistrar* registrar = benchRegistrar->textureRegistrar;
+	g_mutex_lock(&registrar->mutex);
+	const bool pending = g_hash_table_remove(registrar->pending, texture);
+	g_mutex_unlock(&registrar->mutex);
+	return pending;
+}
+
+uint32_t bench_texture_count(void) {
+	BenchTextureRegistrar* registrar = benchRegistrar->textureRegistrar;
+	g_mutex_lock(&registrar->mutex);
+	const uint32_t count = g_hash_table_size(registrar->textures);
+	g_mutex_unlock(&registrar->mutex);
+	return count;
+}
+
+static gint64 benchPollTime;
+
+static gint bench_poll(GPollFD* fds, guint count, gint timeout) {
+	const gint64 start = g_get_monotonic_time();
+	const gint result = g_poll(fds, count, timeout);
+	benchPollTime += g_get_monotonic_time() - start;
+	return result;
+}
+
+void bench_track_poll(void) {
+	g_main_context_set_poll_func(NULL, bench_poll);
+}
+
+gint64 bench_poll_time(void) {
+	return benchPollTime;
+}
+
+uint64_t bench_rss(void) {
+	gchar* statm = NULL;
+	uint64_t pages = 0;
+	if (g_file_get_contents("/proc/self/statm", &statm, NULL, NULL)) {
+		sscanf(statm, "%*u %lu", &pages);
+		g_free(statm);
+	}
+	return pages * sysconf(_SC_PAGESIZE);
+}
+
+gint bench_compare_int64(const void* a, const void* b) {
+	const int64_t x = *(const int64_t*)a;
+	const int64_t y = *(const int64_t*)b;
+	return x < y ? -1 : x > y;
+}
+
+int64_t bench_median(GArray* values) {
+	GArray* reported = g_array_new(FALSE, FALSE, sizeof(int64_t));
+	for (guint i = 0; i < values->len; i++) {
+		if (g_array_index(values, int64_t, i) >= 0) {
+			g_array_append_val(reported, g_array_index(values, int64_t, i));
+		}
+	}
+	g_array_sort(reported, bench_compare_int64);
+	const int64_t median = reported->len ? g_array_index(reported, int64_t, reported->len / 2) : -1;
+	g_array_free(reported, TRUE);
+	return median;
+}
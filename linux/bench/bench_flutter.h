@@ -0,0 +1,66 @@
+#pragma once
+#include <flutter_linux/flutter_linux.h>
+
+G_BEGIN_DECLS
+
+// called for every event sent by players, event is NULL unless decoding is requested by bench_set_event_handler
+typedef void (*BenchEventHandler)(const gchar* channel, FlValue* event, void* userData);
+
+typedef struct {
+	uint64_t events; // messages sent to event channels
+	uint64_t eventBytes;
+	uint64_t methodCalls; // method calls dispatched to the plugin
+	uint64_t frames; // frames marked available by players
+} BenchCounters;
+
+extern BenchCounters benchCounters;
+
+// creates the stub registrar, messenger and texture registrar, which replace the engine
+FlPluginRegistrar* bench_flutter_init(void);
+
+void bench_set_event_handler(BenchEventHandler handler, bool decode, void* userData);
+
+// returns the name of a decoded event if it's sent on the event channel of the player, otherwise NULL
+const gchar* bench_event_name(const gchar* channel, FlValue* event, const int64_t id);
+
+// invokes a method of the plugin and waits for its result, the result should be released by fl_value_unref
+FlValue* bench_invoke(const gchar* method, FlValue* args);
+
+// invokes a method of the plugin and drops its result
+void bench_call(const gchar* method, FlValue* args);
+
+// returns the arguments of a player method with the id and value, value is taken and left out if NULL
+FlValue* bench_args(const int64_t id, FlValue* value);
+
+// populates textures with frames marked available since the last call, and returns how many are populated
+uint32_t bench_populate_pending(void);
+
+// returns whether a frame of texture is marked available since the last call, and clears the mark
+bool bench_take_frame(FlTexture* texture);
+
+// returns the number of textures registered and not yet unregistered
+uint32_t bench_texture_count(void);
+
+// counts the time the main loop of the default context is blocked in poll, the rest is busy
+void bench_track_poll(void);
+gint64 bench_poll_time(void);
+
+// resident set size of the process in bytes
+uint64_t bench_rss(void);
+
+// orders int64_t values for g_array_sort and qsort
+gint bench_compare_int64(const void* a, const void* b);
+
+// median of the values >= 0, -1 if there is none, values are int64_t
+int64_t bench_median(GArray* values);
+
+// malloc calls and bytes of the calling thread
+uint64_t bench_alloc_count(void);
+uint64_t bench_alloc_bytes(void);
+
+bool bench_egl_init(void);
+void bench_egl_make_current(void);
+void bench_egl_release(void);
+void bench_egl_terminate(void);
+
+G_END_DECLS
@@ -0,0 +1,275 @@
+#include "bench_http.h"
+#include <gio/gio.h>
+#include <string.h>
+
+#define BENCH_HTTP_THREADS 32
+#define BENCH_HTTP_CHUNK (16 << 10) // bytes written between throttle checks
+
+struct _BenchHttp {
+	GMutex mutex; // guards the states below, connections are served by threads of the service
+	GHashTable* resources; // GBytes by path
+	GHashTable* types; // content types by path
+	GHashTable* requests; // request counts by path
+	GPtrArray* dirs; // prefix and directory pairs
+	uint32_t requestCount;
+	uint32_t connections;
+	int64_t rate;
+	int64_t sent; // bytes sent in the current window
+	gint64 windowStart;
+	gint64 delay;
+	uint16_t port;
+	GMainContext* context;
+	GMainLoop* loop;
+	GThread* thread;
+	GSocketService* service;
+};
+
+static const gchar* bench_http_guess_type(const gchar* path) {
+	if (g_str_has_suffix(path, ".m3u8")) {
+		return "application/vnd.apple.mpegurl";
+	} else if (g_str_has_suffix(path, ".ts")) {
+		return "video/mp2t";
+	} else if (g_str_has_suffix(path, ".mp4") || g_str_has_suffix(path, ".m4s")) {
+		return "video/mp4";
+	}
+	return "application/octet-stream";
+}
+
+// sleeps until the bytes are within the rate shared by all responses
+static void bench_http_throttle(BenchHttp* http, const gsize bytes) {
+	gint64 delay = 0;
+	g_mutex_lock(&http->mutex);
+	if (http->rate > 0) {
+		const gint64 now = g_get_monotonic_time();
+		if (now - http->windowStart > G_USEC_PER_SEC) {
+			http->windowStart = now;
+			http->sent = 0;
+		}
+		http->sent += bytes;
+		delay = http->windowStart + http->sent * G_USEC_PER_SEC / http->rate - now;
+	}
+	g_mutex_unlock(&http->mutex);
+	if (delay > 0) {
+		g_usleep(delay);
+	}
+}
+
+// returns the resource at path with its content type, or NULL if there is none
+static GBytes* bench_http_lookup(BenchHttp* http, const gchar* path, const gchar** contentType) {
+	g_mutex_lock(&http->mutex);
+	GBytes* body = g_hash_table_lookup(http->resources, path);
+	if (body) {
+		g_bytes_ref(body);
+		*contentType = g_hash_table_lookup(http->types, path);
+	}
+	gchar* file = NULL;
+	for (guint i = 0; !body && !file && i + 1 < http->dirs->len; i += 2) {
+		const gchar* prefix = g_ptr_array_index(http->dirs, i);
+		if (g_str_has_prefix(path, prefix) && !strstr(path, "..")) {
+			file = g_build_filename(g_ptr_array_index(http->dirs, i + 1), &path[strlen(prefix)], NULL);
+		}
+	}
+	g_mutex_unlock(&http->mutex);
+	gchar* contents = NULL;
+	gsize size = 0;
+	if (file && g_file_get_contents(file, &contents, &size, NULL)) {
+		body = g_bytes_new_take(contents, size);
+		*contentType = bench_http_guess_type(path);
+	}
+	g_free(file);
+	return body;
+}
+
+static bool bench_http_respond(BenchHttp* http, GOutputStream* output, const gchar* method, const gchar* target, const gchar* range) {
+	gchar* path = g_strndup(target, strcspn(target, "?"));
+	g_mutex_lock(&http->mutex);
+	http->requestCount++;
+	g_hash_table_replace(http->requests, g_strdup(path), GUINT_TO_POINTER(GPOINTER_TO_UINT(g_hash_table_lookup(http->requests, path)) + 1));
+	const gint64 delay = http->delay;
+	g_mutex_unlock(&http->mutex);
+	if (delay > 0) {
+		g_usleep(delay);
+	}
+	const gchar* contentType = NULL;
+	GBytes* body = bench_http_lookup(http, path, &contentType);
+	g_free(path);
+	if (!body) {
+		const gchar* response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+		return g_output_stream_write_all(output, response, strlen(response), NULL, NULL, NULL);
+	}
+	gsize size = 0;
+	const guint8* data = g_bytes_get_data(body, &size);
+	int64_t start = 0;
+	int64_t end = (int64_t)size - 1;
+	GString* head;
+	if (range && g_str_has_prefix(range, "bytes=")) {
+		gchar* next = NULL;
+		start = g_ascii_strtoll(&range[6], &next, 10);
+		if (next && next[0] == '-' && next[1]) {
+			end = MIN(g_ascii_strtoll(&next[1], NULL, 10), end);
+		}
+		if (start >= (int64_t)size || start > end) {
+			g_bytes_unref(body);
+			gchar* response = g_strdup_printf("HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */%lu\r\nContent-Length: 0\r\n\r\n", size);
+			const bool ok = g_output_stream_write_all(output, response, strlen(response), NULL, NULL, NULL);
+			g_free(response);
+			return ok;
+		}
+		head = g_string_new("HTTP/1.1 206 Partial Content\r\n");
+		g_string_append_printf(head, "Content-Range: bytes %ld-%ld/%lu\r\n", start, end, size);
+	} else {
+		head = g_string_new("HTTP/1.1 200 OK\r\n");
+	}
+	g_string_append_printf(head, "Content-Type: %s\r\nContent-Length: %ld\r\nAccept-Ranges: bytes\r\nETag: \"%lu\"\r\n\r\n", contentType ? contentType : bench_http_guess_type(target), end - start + 1, size);
+	bool ok = g_output_stream_write_all(output, head->str, head->len, NULL, NULL, NULL);
+	g_string_free(head, TRUE);
+	for (int64_t position = start; ok && position <= end && !g_str_equal(method, "HEAD");) {
+		const gsize n = MIN(end + 1 - position, BENCH_HTTP_CHUNK);
+		bench_http_throttle(http, n);
+		ok = g_output_stream_write_all(output, &data[position], n, NULL, NULL, NULL);
+		position += n;
+	}
+	g_bytes_unref(body);
+	return ok;
+}
+
+static gboolean bench_http_run(GThreadedSocketService* service, GSocketConnection* connection, GObject* source, void* data) {
+	BenchHttp* http = data;
+	g_mutex_lock(&http->mutex);
+	http->connections++;
+	g_mutex_unlock(&http->mutex);
+	GDataInputStream* input = g_data_input_stream_new(g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+	g_data_input_stream_set_newline_type(input, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+	GOutputStream* output = g_io_stream_get_output_stream(G_IO_STREAM(connection));
+	bool alive = true;
+	gchar* line;
+	while (alive && (line = g_data_input_stream_read_line(input, NULL, NULL, NULL))) {
+		gchar** request = g_strsplit(line, " ", 3);
+		g_free(line);
+		gchar* range = NULL;
+		while ((line = g_data_input_stream_read_line(input, NULL, NULL, NULL)) && line[0]) {
+			if (!g_ascii_strncasecmp(line, "Range:", 6)) {
+				g_free(range);
+				range = g_strdup(g_strchug(&line[6]));
+			} else if (!g_ascii_strncasecmp(line, "Connection:", 11)) {
+				gchar* value = g_ascii_strdown(&line[11], -1);
+				alive = !strstr(value, "close");
+				g_free(value);
+			}
+			g_free(line);
+		}
+		if (line && request[0] && request[1]) {
+			alive = bench_http_respond(http, output, request[0], request[1], range) && alive;
+		} else {
+			alive = false;
+		}
+		g_free(line);
+		g_free(range);
+		g_strfreev(request);
+	}
+	g_object_unref(input);
+	return FALSE;
+}
+
+static void* bench_http_loop(void* data) {
+	BenchHttp* http = data;
+	g_main_context_push_thread_default(http->context);
+	g_main_loop_run(http->loop);
+	g_main_context_pop_thread_default(http->context);
+	return NULL;
+}
+
+BenchHttp* bench_http_start(void) {
+	BenchHttp* http = g_new0(BenchHttp, 1);
+	g_mutex_init(&http->mutex);
+	http->resources = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_bytes_unref);
+	http->types = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	http->requests = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	http->dirs = g_ptr_array_new_with_free_func(g_free);
+	// connections are accepted in the context of the server thread
+	http->context = g_main_context_new();
+	http->loop = g_main_loop_new(http->context, FALSE);
+	g_main_context_push_thread_default(http->context);
+	http->service = g_threaded_socket_service_new(BENCH_HTTP_THREADS);
+	GInetAddress* loopback = g_inet_address_new_loopback(G_SOCKET_FAMILY_IPV4);
+	GSocketAddress* address = g_inet_socket_address_new(loopback, 0);
+	GSocketAddress* effective = NULL;
+	if (g_socket_listener_add_address(G_SOCKET_LISTENER(http->service), address, G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_TCP, NULL, &effective, NULL)) {
+		http->port = g_inet_socket_address_get_port(G_INET_SOCKET_ADDRESS(effective));
+		g_object_unref(effective);
+		g_signal_connect(http->service, "run", G_CALLBACK(bench_http_run), http);
+		g_socket_service_start(http->service);
+	}
+	g_main_context_pop_thread_default(http->context);
+	g_object_unref(address);
+	g_object_unref(loopback);
+	http->thread = g_thread_new("bench_http", bench_http_loop, http);
+	return http;
+}
+
+static gboolean bench_http_quit(void* data) {
+	g_main_loop_quit(data);
+	return G_SOURCE_REMOVE;
+}
+
+void bench_http_stop(BenchHttp* http) {
+	g_socket_service_stop(http->service);
+	g_socket_listener_close(G_SOCKET_LISTENER(http->service));
+	g_main_context_invoke(http->context, bench_http_quit, http->loop);
+	g_thread_join(http->thread);
+	g_object_unref(http->service);
+	g_main_loop_unref(http->loop);
+	g_main_context_unref(http->context);
+	g_hash_table_unref(http->resources);
+	g_hash_table_unref(http->types);
+	g_hash_table_unref(http->requests);
+	g_ptr_array_free(http->dirs, TRUE);
+	g_mutex_clear(&http->mutex);
+	g_free(http);
+}
+
+uint16_t bench_http_port(BenchHttp* http) {
+	return http->port;
+}
+
+void bench_http_add(BenchHttp* http, const gchar* path, const gchar* contentType, GBytes* body) {
+	g_mutex_lock(&http->mutex);
+	g_hash_table_replace(http->resources, g_strdup(path), g_bytes_ref(body));
+	g_hash_table_replace(http->types, g_strdup(path), g_strdup(contentType ? contentType : bench_http_guess_type(path)));
+	g_mutex_unlock(&http->mutex);
+}
+
+void bench_http_add_dir(BenchHttp* http, const gchar* prefix, const gchar* dir) {
+	g_mutex_lock(&http->mutex);
+	g_ptr_array_add(http->dirs, g_strdup(prefix));
+	g_ptr_array_add(http->dirs, g_strdup(dir));
+	g_mutex_unlock(&http->mutex);
+}
+
+void bench_http_set_rate(BenchHttp* http, const int64_t rate) {
+	g_mutex_lock(&http->mutex);
+	http->rate = rate;
+	http->sent = 0;
+	http->windowStart = g_get_monotonic_time();
+	g_mutex_unlock(&http->mutex);
+}
+
+void bench_http_set_delay(BenchHttp* http, const gint64 delay) {
+	g_mutex_lock(&http->mutex);
+	http->delay = delay;
+	g_mutex_unlock(&http->mutex);
+}
+
+uint32_t bench_http_requests(BenchHttp* http, const gchar* path) {
+	g_mutex_lock(&http->mutex);
+	const uint32_t count = path ? GPOINTER_TO_UINT(g_hash_table_lookup(http->requests, path)) : http->requestCount;
+	g_mutex_unlock(&http->mutex);
+	return count;
+}
+
+uint32_t bench_http_connections(BenchHttp* http) {
+	g_mutex_lock(&http->mutex);
+	const uint32_t count = http->connections;
+	g_mutex_unlock(&http->mutex);
+	return count;
+}
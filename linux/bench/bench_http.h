@@ -0,0 +1,36 @@
+#pragma once
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+G_BEGIN_DECLS
+
+// A local HTTP/1.1 origin standing in for media servers, it serves resources from memory or a directory on a loopback
+// port with keep-alive and single range requests. Connections are served by its own threads and main context, so it
+// works while the calling thread is blocked.
+typedef struct _BenchHttp BenchHttp;
+
+BenchHttp* bench_http_start(void);
+void bench_http_stop(BenchHttp* http);
+
+uint16_t bench_http_port(BenchHttp* http);
+
+// serves body at path, the content type is guessed from the extension if NULL
+void bench_http_add(BenchHttp* http, const gchar* path, const gchar* contentType, GBytes* body);
+
+// serves the files of dir under prefix, which starts and ends with a slash
+void bench_http_add_dir(BenchHttp* http, const gchar* prefix, const gchar* dir);
+
+// bytes per second of all responses together, 0 for no limit
+void bench_http_set_rate(BenchHttp* http, int64_t rate);
+
+// microseconds before each response head is sent, so concurrent requests overlap
+void bench_http_set_delay(BenchHttp* http, gint64 delay);
+
+// requests of path so far, or of all paths if path is NULL
+uint32_t bench_http_requests(BenchHttp* http, const gchar* path);
+
+// connections accepted so far
+uint32_t bench_http_connections(BenchHttp* http);
+
+G_END_DECLS
@@ -0,0 +1,151 @@
+// Measures time to first frame through the method channel of the plugin, with and without the fast-start profile.
+//
+// usage: bench_open [--video PATH]... [--hls DIR] [--runs N] [--timeout S]
+//
+// Each source is opened and played by a new player the given number of times without and then with setFastStart, and
+// a JSON line with the phases of the openTiming event is written per open. DIR is served by a local HTTP server, so
+// its index.m3u8 is opened like a network HLS source, make_hls.sh creates one from a video. A summary line per source
+// and profile holds the medians. The exit code is 1 if an open doesn't reach its first frame before the timeout.
+
+#include <video_view/video_view_plugin.h>
+#include "bench_flutter.h"
+#include "bench_http.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_PHASES 5
+
+static const gchar* phases[BENCH_PHASES] = { "fileLoaded", "playbackRestart", "mediaInfo", "firstPopulate", "firstFrame" };
+
+typedef struct {
+	int64_t id; // player being opened, 0 for none
+	int64_t phases[BENCH_PHASES]; // milliseconds after open, -1 if not reported
+	gchar* demuxer;
+	bool done;
+} BenchTiming;
+
+static void bench_on_event(const gchar* channel, FlValue* event, void* userData) {
+	BenchTiming* timing = userData;
+	const gchar* name = bench_event_name(channel, event, timing->id);
+	if (name && g_str_equal(name, "openTiming")) {
+		for (int i = 0; i < BENCH_PHASES; i++) {
+			FlValue* value = fl_value_lookup_string(event, phases[i]);
+			timing->phases[i] = value ? fl_value_get_int(value) : -1;
+		}
+		FlValue* demuxer = fl_value_lookup_string(event, "demuxer");
+		g_free(timing->demuxer);
+		timing->demuxer = demuxer && fl_value_get_type(demuxer) == FL_VALUE_TYPE_STRING ? g_strdup(fl_value_get_string(demuxer)) : NULL;
+		timing->done = true;
+	}
+}
+
+// opens source with a new player and waits for openTiming, returns false on timeout
+static bool bench_open(const gchar* source, const bool fastStart, const double timeout, BenchTiming* timing) {
+	g_autoptr(FlValue) created = bench_invoke("create", NULL);
+	const int64_t id = fl_value_get_int(fl_value_lookup_string(created, "id"));
+	timing->id = id;
+	timing->done = false;
+	g_autoptr(FlValue) fast = bench_args(id, fl_value_new_bool(fastStart));
+	bench_call("setFastStart", fast);
+	g_autoptr(FlValue) open = bench_args(id, fl_value_new_string(source));
+	bench_call("open", open);
+	g_autoptr(FlValue) play = fl_value_new_int(id);
+	bench_call("play", play);
+	const gint64 end = g_get_monotonic_time() + (gint64)(timeout * G_USEC_PER_SEC);
+	while (!timing->done && g_get_monotonic_time() < end) {
+		g_main_context_iteration(NULL, FALSE);
+		// populate runs on the raster thread in an app, the first frame is only counted once it's populated
+		if (!bench_populate_pending()) {
+			g_usleep(1000);
+		}
+	}
+	bench_call("dispose", play);
+	timing->id = 0;
+	return timing->done;
+}
+
+static bool bench_source(const gchar* source, const uint32_t runs, const double timeout, BenchTiming* timing) {
+	bool ok = true;
+	for (int fastStart = 0; fastStart < 2; fastStart++) {
+		GArray* values[BENCH_PHASES];
+		for (int i = 0; i < BENCH_PHASES; i++) {
+			values[i] = g_array_new(FALSE, FALSE, sizeof(int64_t));
+		}
+		uint32_t timeouts = 0;
+		for (uint32_t run = 0; run < runs; run++) {
+			if (!bench_open(source, fastStart, timeout, timing)) {
+				timeouts++;
+				printf("{\"source\":\"%s\",\"fastStart\":%s,\"run\":%u,\"timeout\":true}\n", source, fastStart ? "true" : "false", run);
+				continue;
+			}
+			printf("{\"source\":\"%s\",\"fastStart\":%s,\"run\":%u,\"demuxer\":\"%s\"", source, fastStart ? "true" : "false", run, timing->demuxer ? timing->demuxer : "");
+			for (int i = 0; i < BENCH_PHASES; i++) {
+				g_array_append_val(values[i], timing->phases[i]);
+				printf(",\"%s\":%ld", phases[i], timing->phases[i]);
+			}
+			printf("}\n");
+			fflush(stdout);
+		}
+		printf("{\"summary\":true,\"source\":\"%s\",\"fastStart\":%s,\"runs\":%u,\"timeouts\":%u", source, fastStart ? "true" : "false", runs, timeouts);
+		for (int i = 0; i < BENCH_PHASES; i++) {
+			printf(",\"%s\":%ld", phases[i], bench_median(values[i]));
+			g_array_free(values[i], TRUE);
+		}
+		printf("}\n");
+		fflush(stdout);
+		ok = ok && timeouts == 0;
+	}
+	return ok;
+}
+
+int main(int argc, char** argv) {
+	GPtrArray* videos = g_ptr_array_new();
+	const gchar* hls = NULL;
+	uint32_t runs = 5;
+	double timeout = 10;
+	for (int i = 1; i < argc; i++) {
+		if (i + 1 >= argc) {
+			fprintf(stderr, "usage: %s [--video PATH]... [--hls DIR] [--runs N] [--timeout S]\n", argv[0]);
+			return 2;
+		} else if (g_str_equal(argv[i], "--video")) {
+			g_ptr_array_add(videos, argv[++i]);
+		} else if (g_str_equal(argv[i], "--hls")) {
+			hls = argv[++i];
+		} else if (g_str_equal(argv[i], "--runs")) {
+			runs = MAX((uint32_t)g_ascii_strtoull(argv[++i], NULL, 10), 1);
+		} else if (g_str_equal(argv[i], "--timeout")) {
+			timeout = g_ascii_strtod(argv[++i], NULL);
+		} else {
+			fprintf(stderr, "unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+	if (videos->len == 0) {
+		g_ptr_array_add(videos, (gchar*)BENCH_VIDEO);
+	}
+	if (!bench_egl_init()) {
+		fprintf(stderr, "surfaceless EGL is not available\n");
+		return 1;
+	}
+	video_view_plugin_register_with_registrar(bench_flutter_init());
+	BenchTiming timing = { 0 };
+	bench_set_event_handler(bench_on_event, true, &timing);
+	bool ok = true;
+	for (guint i = 0; i < videos->len; i++) {
+		gchar* source = g_path_is_absolute(g_ptr_array_index(videos, i)) ? g_strdup(g_ptr_array_index(videos, i)) : g_canonicalize_filename(g_ptr_array_index(videos, i), NULL);
+		ok = bench_source(source, runs, timeout, &timing) && ok;
+		g_free(source);
+	}
+	if (hls) {
+		BenchHttp* http = bench_http_start();
+		bench_http_add_dir(http, "/hls/", hls);
+		gchar* source = g_strdup_printf("http://127.0.0.1:%u/hls/index.m3u8", bench_http_port(http));
+		ok = bench_source(source, runs, timeout, &timing) && ok;
+		g_free(source);
+		bench_http_stop(http);
+	}
+	g_free(timing.demuxer);
+	g_ptr_array_free(videos, TRUE);
+	bench_egl_terminate();
+	return ok ? 0 : 1;
+}
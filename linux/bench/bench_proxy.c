@@ -0,0 +1,362 @@
+// Checks the HTTP proxy of the plugin against a local origin server.
+//
+// usage: bench_proxy [--rate BYTES]
+//
+// Requests are sent to the proxy like mpv does, and each check writes a JSON line: requests with a wrong token are
+// refused, requests on one connection reuse one upstream connection, ranges are relayed, concurrent requests of the same
+// resource share one upstream request, absolute URIs of HLS playlists are rewritten to go through the proxy, and the
+// bandwidth is split by weight between players receiving data. The exit code is 1 if a check fails.
+
+#include "../video_view_proxy.c"
+#include "bench_http.h"
+#include <stdio.h>
+
+#define BENCH_RESOURCE_BYTES (3 << 20)
+#define BENCH_DEDUP_REQUESTS 4
+#define BENCH_SHARE_SECONDS 1.5
+
+typedef struct {
+	GSocketConnection* connection;
+	GDataInputStream* input;
+} BenchClient;
+
+typedef struct {
+	int code;
+	GString* headers;
+	GByteArray* body;
+	bool closing;
+} BenchResponse;
+
+typedef struct {
+	int64_t id;
+	const gchar* path;
+	gint received; // body bytes received so far
+	bool ok;
+} BenchDownload;
+
+static BenchHttp* http;
+static GBytes* resource;
+static int64_t shareRate = 1 << 20;
+static gint checksDone;
+static bool failed;
+
+static bool bench_client_open(BenchClient* client) {
+	GSocketClient* socketClient = g_socket_client_new();
+	client->connection = g_socket_client_connect_to_host(socketClient, "127.0.0.1", proxyPort, NULL, NULL);
+	g_object_unref(socketClient);
+	if (!client->connection) {
+		return false;
+	}
+	client->input = g_data_input_stream_new(g_io_stream_get_input_stream(G_IO_STREAM(client->connection)));
+	g_data_input_stream_set_newline_type(client->input, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+	return true;
+}
+
+static void bench_client_close(BenchClient* client) {
+	if (client->connection) {
+		g_object_unref(client->input);
+		g_io_stream_close(G_IO_STREAM(client->connection), NULL, NULL);
+		g_object_unref(client->connection);
+		client->connection = NULL;
+	}
+}
+
+static void bench_response_clear(BenchResponse* response) {
+	if (response->headers) {
+		g_string_free(response->headers, TRUE);
+	}
+	if (response->body) {
+		g_byte_array_free(response->body, TRUE);
+	}
+	memset(response, 0, sizeof(BenchResponse));
+}
+
+// sends a GET on the connection and reads the response, received counts body bytes as they arrive
+static bool bench_client_get(BenchClient* client, const gchar* target, const gchar* range, BenchResponse* response, gint* received) {
+	memset(response, 0, sizeof(BenchResponse));
+	gchar* request = range ? g_strdup_printf("GET %s HTTP/1.1\r\nHost: 127.0.0.1\r\nRange: %s\r\n\r\n", target, range) : g_strdup_printf("GET %s HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n", target);
+	const bool sent = g_output_stream_write_all(g_io_stream_get_output_stream(G_IO_STREAM(client->connection)), request, strlen(request), NULL, NULL, NULL);
+	g_free(request);
+	gchar* line = sent ? g_data_input_stream_read_line(client->input, NULL, NULL, NULL) : NULL;
+	if (!line) {
+		return false;
+	}
+	response->code = strlen(line) > 9 ? (int)g_ascii_strtoll(&line[9], NULL, 10) : 0;
+	response->headers = g_string_new(NULL);
+	response->body = g_byte_array_new();
+	g_free(line);
+	int64_t length = 0;
+	while ((line = g_data_input_stream_read_line(client->input, NULL, NULL, NULL)) && line[0]) {
+		if (!g_ascii_strncasecmp(line, "Content-Length:", 15)) {
+			length = g_ascii_strtoll(&line[15], NULL, 10);
+		} else if (!g_ascii_strncasecmp(line, "Connection:", 11)) {
+			response->closing = strstr(line, "close") != NULL;
+		}
+		g_string_append_printf(response->headers, "%s\n", line);
+		g_free(line);
+	}
+	if (!line) {
+		return false;
+	}
+	g_free(line);
+	guint8 buffer[16 << 10];
+	while (response->body->len < length) {
+		const gssize n = g_input_stream_read(G_INPUT_STREAM(client->input), buffer, MIN(length - response->body->len, sizeof(buffer)), NULL, NULL);
+		if (n <= 0) {
+			return false;
+		}
+		g_byte_array_append(response->body, buffer, n);
+		if (received) {
+			g_atomic_int_add(received, (gint)n);
+		}
+	}
+	return true;
+}
+
+// the path of the proxy url the plugin gives mpv for a resource of the origin
+static gchar* bench_target(const int64_t id, const gchar* path) {
+	gchar* source = g_strdup_printf("http://127.0.0.1:%u%s", bench_http_port(http), path);
+	gchar* url = video_view_plugin_proxy_url(id, source);
+	gchar* target = g_strdup(strchr(&url[strlen("http://")], '/'));
+	g_free(url);
+	g_free(source);
+	return target;
+}
+
+static bool bench_same_body(const BenchResponse* response, const gsize offset, const gsize size) {
+	gsize total = 0;
+	const guint8* data = g_bytes_get_data(resource, &total);
+	return response->body->len == size && offset + size <= total && !memcmp(response->body->data, &data[offset], size);
+}
+
+static void bench_report(const gchar* check, const bool ok, const gchar* detail) {
+	printf("{\"check\":\"%s\",\"ok\":%s%s%s}\n", check, ok ? "true" : "false", detail ? "," : "", detail ? detail : "");
+	fflush(stdout);
+	failed = failed || !ok;
+}
+
+static void bench_check_token(void) {
+	BenchClient client = { 0 };
+	BenchResponse response = { 0 };
+	gchar* target = g_strdup_printf("/%s/1/http/127.0.0.1:%u/a.bin", "not-the-token", bench_http_port(http));
+	const uint32_t before = bench_http_requests(http, NULL);
+	const bool ok = bench_client_open(&client) && bench_client_get(&client, target, NULL, &response, NULL);
+	gchar* detail = g_strdup_printf("\"code\":%d", response.code);
+	bench_report("token", ok && response.code == 403 && bench_http_requests(http, NULL) == before, detail);
+	g_free(detail);
+	g_free(target);
+	bench_response_clear(&response);
+	bench_client_close(&client);
+}
+
+static void bench_check_keep_alive(void) {
+	const gchar* paths[] = { "/a.bin", "/b.bin", "/a.bin" };
+	const uint32_t connections = bench_http_connections(http);
+	BenchClient client = { 0 };
+	bool ok = bench_client_open(&client);
+	for (guint i = 0; ok && i < G_N_ELEMENTS(paths); i++) {
+		BenchResponse response;
+		gchar* target = bench_target(1, paths[i]);
+		ok = bench_client_get(&client, target, NULL, &response, NULL) && response.code == 200 && !response.closing && bench_same_body(&response, 0, BENCH_RESOURCE_BYTES);
+		bench_response_clear(&response);
+		g_free(target);
+	}
+	bench_client_close(&client);
+	const uint32_t upstream = bench_http_connections(http) - connections;
+	gchar* detail = g_strdup_printf("\"requests\":%u,\"upstreamConnections\":%u", (guint)G_N_ELEMENTS(paths), upstream);
+	bench_report("keepAlive", ok && upstream == 1, detail);
+	g_free(detail);
+}
+
+static void bench_check_range(void) {
+	BenchClient client = { 0 };
+	BenchResponse response = { 0 };
+	gchar* target = bench_target(1, "/a.bin");
+	const bool ok = bench_client_open(&client) && bench_client_get(&client, target, "bytes=1000-1999", &response, NULL);
+	const bool ranged = ok && response.code == 206 && strstr(response.headers->str, "bytes 1000-1999/") && bench_same_body(&response, 1000, 1000);
+	gchar* detail = g_strdup_printf("\"code\":%d,\"bytes\":%u", response.code, response.body ? response.body->len : 0);
+	bench_report("range", ranged, detail);
+	g_free(detail);
+	g_free(target);
+	bench_response_clear(&response);
+	bench_client_close(&client);
+}
+
+static void* bench_download(void* data) {
+	BenchDownload* download = data;
+	BenchClient client = { 0 };
+	BenchResponse response = { 0 };
+	gchar* target = bench_target(download->id, download->path);
+	download->ok = bench_client_open(&client) && bench_client_get(&client, target, NULL, &response, &download->received) && response.code == 200 && bench_same_body(&response, 0, BENCH_RESOURCE_BYTES);
+	g_free(target);
+	bench_response_clear(&response);
+	bench_client_close(&client);
+	return NULL;
+}
+
+static void bench_check_dedup(void) {
+	// the origin holds the response back, so all requests arrive while the first one is in flight
+	bench_http_set_delay(http, 300000);
+	BenchDownload downloads[BENCH_DEDUP_REQUESTS] = { { 0 } };
+	GThread* threads[BENCH_DEDUP_REQUESTS];
+	for (int i = 0; i < BENCH_DEDUP_REQUESTS; i++) {
+		downloads[i].id = i + 1;
+		downloads[i].path = "/shared.bin";
+		threads[i] = g_thread_new("bench_download", bench_download, &downloads[i]);
+	}
+	bool ok = true;
+	for (int i = 0; i < BENCH_DEDUP_REQUESTS; i++) {
+		g_thread_join(threads[i]);
+		ok = ok && downloads[i].ok;
+	}
+	bench_http_set_delay(http, 0);
+	const uint32_t upstream = bench_http_requests(http, "/shared.bin");
+	gchar* detail = g_strdup_printf("\"requests\":%d,\"upstreamRequests\":%u", BENCH_DEDUP_REQUESTS, upstream);
+	bench_report("dedup", ok && upstream == 1, detail);
+	g_free(detail);
+}
+
+// returns the first line after the line starting with prefix, or the value of its URI attribute if attribute is set
+static gchar* bench_playlist_uri(const gchar* text, const gchar* prefix, const bool attribute) {
+	gchar* uri = NULL;
+	gchar** lines = g_strsplit(text, "\n", -1);
+	for (int i = 0; !uri && lines[i]; i++) {
+		if (g_str_has_prefix(lines[i], prefix)) {
+			if (attribute) {
+				const gchar* value = strstr(lines[i], "URI=\"");
+				const gchar* end = value ? strchr(&value[5], '"') : NULL;
+				uri = end ? g_strndup(&value[5], end - &value[5]) : NULL;
+			} else if (lines[i + 1]) {
+				uri = g_strdup(lines[i + 1]);
+			}
+		}
+	}
+	g_strfreev(lines);
+	return uri;
+}
+
+// resolves uri of the proxied playlist, and checks that it is the proxy url of path
+static bool bench_proxied_uri(const gchar* playlist, const gchar* uri, const gchar* path) {
+	gchar* base = g_strdup_printf("http://127.0.0.1:%u%s", proxyPort, playlist);
+	gchar* resolved = uri ? g_uri_resolve_relative(base, uri, G_URI_FLAGS_NONE, NULL) : NULL;
+	gchar* target = bench_target(1, path);
+	gchar* expected = g_strdup_printf("http://127.0.0.1:%u%s", proxyPort, target);
+	const bool ok = resolved && g_str_equal(resolved, expected);
+	g_free(expected);
+	g_free(target);
+	g_free(resolved);
+	g_free(base);
+	return ok;
+}
+
+static void bench_check_playlist(void) {
+	const uint16_t port = bench_http_port(http);
+	gchar* text = g_strdup_printf("#EXTM3U\n#EXT-X-VERSION:3\n#EXT-X-TARGETDURATION:4\n"
+		"#EXT-X-KEY:METHOD=AES-128,URI=\"http://127.0.0.1:%u/hls/key.bin\"\n"
+		"#EXTINF:4,\nhttp://127.0.0.1:%u/hls/seg0.ts\n#EXTINF:4,\nseg1.ts\n#EXT-X-ENDLIST\n", port, port);
+	GBytes* playlist = g_bytes_new_take(text, strlen(text));
+	bench_http_add(http, "/hls/index.m3u8", NULL, playlist);
+	g_bytes_unref(playlist);
+	bench_http_add(http, "/hls/seg0.ts", NULL, resource);
+	BenchClient client = { 0 };
+	BenchResponse response = { 0 };
+	gchar* target = bench_target(1, "/hls/index.m3u8");
+	// mpv asks for the whole resource as a range
+	bool ok = bench_client_open(&client) && bench_client_get(&client, target, "bytes=0-", &response, NULL) && response.code == 200;
+	gchar* body = ok ? g_strndup((const gchar*)response.body->data, response.body->len) : g_strdup("");
+	const bool absolute = strstr(body, "http://") != NULL;
+	gchar* segment = bench_playlist_uri(body, "#EXTINF", false);
+	gchar* key = bench_playlist_uri(body, "#EXT-X-KEY", true);
+	// relative URIs are left as they are
+	const bool relative = strstr(body, "\nseg1.ts\n") != NULL;
+	ok = ok && !absolute && relative && bench_proxied_uri(target, segment, "/hls/seg0.ts") && bench_proxied_uri(target, key, "/hls/key.bin");
+	bench_response_clear(&response);
+	// the rewritten segment goes through the proxy
+	gchar* segmentTarget = bench_target(1, "/hls/seg0.ts");
+	ok = ok && bench_client_get(&client, segmentTarget, NULL, &response, NULL) && response.code == 200 && bench_http_requests(http, "/hls/seg0.ts") == 1;
+	gchar* detail = g_strdup_printf("\"absolute\":%s,\"segment\":\"%s\"", absolute ? "true" : "false", segment ? segment : "");
+	bench_report("playlist", ok, detail);
+	g_free(detail);
+	g_free(segmentTarget);
+	g_free(segment);
+	g_free(key);
+	g_free(body);
+	g_free(target);
+	bench_response_clear(&response);
+	bench_client_close(&client);
+}
+
+static void bench_check_shares(void) {
+	// player 1 is in foreground with 3 times the weight of player 2
+	video_view_plugin_proxy_set_weight(1, 3);
+	video_view_plugin_proxy_set_weight(2, 1);
+	video_view_plugin_set_proxy(true, shareRate);
+	BenchDownload downloads[2] = { { 1, "/p1.bin", 0, false }, { 2, "/p2.bin", 0, false } };
+	GThread* threads[2];
+	for (int i = 0; i < 2; i++) {
+		threads[i] = g_thread_new("bench_download", bench_download, &downloads[i]);
+	}
+	g_usleep((gulong)(BENCH_SHARE_SECONDS * G_USEC_PER_SEC));
+	const gint first = g_atomic_int_get(&downloads[0].received);
+	const gint second = g_atomic_int_get(&downloads[1].received);
+	// the rest is downloaded without limit
+	video_view_plugin_set_proxy(true, 0);
+	for (int i = 0; i < 2; i++) {
+		g_thread_join(threads[i]);
+	}
+	video_view_plugin_proxy_set_weight(1, 0);
+	video_view_plugin_proxy_set_weight(2, 0);
+	const double ratio = second > 0 ? (double)first / second : 0;
+	const double rate = (first + second) / BENCH_SHARE_SECONDS;
+	gchar* detail = g_strdup_printf("\"ratio\":%.2f,\"rate\":%.0f", ratio, rate);
+	bench_report("shares", downloads[0].ok && downloads[1].ok && ratio > 2 && ratio < 4.5 && rate < shareRate * 1.5, detail);
+	g_free(detail);
+}
+
+static void* bench_checks(void* data) {
+	bench_check_token();
+	bench_check_keep_alive();
+	bench_check_range();
+	bench_check_dedup();
+	bench_check_playlist();
+	bench_check_shares();
+	g_atomic_int_set(&checksDone, 1);
+	g_main_context_wakeup(NULL);
+	return NULL;
+}
+
+int main(int argc, char** argv) {
+	for (int i = 1; i < argc; i++) {
+		if (i + 1 < argc && g_str_equal(argv[i], "--rate")) {
+			shareRate = MAX(g_ascii_strtoll(argv[++i], NULL, 10), 1);
+		} else {
+			fprintf(stderr, "usage: %s [--rate BYTES]\n", argv[0]);
+			return 2;
+		}
+	}
+	video_view_plugin_proxy_init();
+	guint8* data = g_malloc(BENCH_RESOURCE_BYTES);
+	for (uint32_t i = 0; i < BENCH_RESOURCE_BYTES; i++) {
+		data[i] = (guint8)(i * 2654435761u >> 24);
+	}
+	resource = g_bytes_new_take(data, BENCH_RESOURCE_BYTES);
+	http = bench_http_start();
+	const gchar* paths[] = { "/a.bin", "/b.bin", "/shared.bin", "/p1.bin", "/p2.bin" };
+	for (guint i = 0; i < G_N_ELEMENTS(paths); i++) {
+		bench_http_add(http, paths[i], NULL, resource);
+	}
+	video_view_plugin_set_proxy(true, 0);
+	if (!proxyPort || !bench_http_port(http)) {
+		fprintf(stderr, "can't listen on loopback\n");
+		return 1;
+	}
+	// the proxy accepts connections in the main context like in the app, so the checks run in another thread
+	GThread* thread = g_thread_new("bench_checks", bench_checks, NULL);
+	while (!g_atomic_int_get(&checksDone)) {
+		g_main_context_iteration(NULL, TRUE);
+	}
+	g_thread_join(thread);
+	bench_http_stop(http);
+	g_bytes_unref(resource);
+	return failed ? 1 : 0;
+}
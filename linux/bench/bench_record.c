@@ -0,0 +1,195 @@
+// Records the events of real mpv playing a media into a trace, which fake_mpv.c replays for bench_events.
+//
+// usage: bench_record [--video PATH] [--seconds S] [--seek-every MS] [--log-level LEVEL] > trace.txt
+//
+// mpv is set up like the plugin does with a software render context, every rendered frame is recorded as a frame
+// step. Properties the plugin reads when a file is loaded or the video is reconfigured are recorded as set steps
+// just before the event.
+
+#include <glib.h>
+#include <math.h>
+#include <mpv/client.h>
+#include <mpv/render.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_RECORD_WIDTH 64 // size of the software render target, frames are not kept
+#define BENCH_RECORD_HEIGHT 36
+
+static const gchar* loadedProperties[] = {
+	"duration/full", "seekable", "partially-seekable", "demuxer-via-network", "demuxer-start-time", "current-demuxer",
+	"hwdec-current", "vid", "container-fps", "estimated-vf-fps", "dwidth", "dheight", "track-list/count", NULL
+};
+
+static const gchar* trackProperties[] = {
+	"type", "id", "demux-w", "demux-h", "hls-bitrate", "default", "lang", "title", "codec", "format-name",
+	"demux-bitrate", "demux-channel-count", "demux-samplerate", NULL
+};
+
+static gint frameAvailable;
+
+static void bench_record_update(void* data) {
+	g_atomic_int_set(&frameAvailable, 1);
+	mpv_wakeup(data);
+}
+
+static void bench_record_set(mpv_handle* mpv, const gint64 time, const gchar* name) {
+	char* value = mpv_get_property_string(mpv, name);
+	if (value) {
+		printf("%ld set %s %s\n", time, name, value);
+		mpv_free(value);
+	} else {
+		printf("%ld set %s\n", time, name);
+	}
+}
+
+static void bench_record_loaded(mpv_handle* mpv, const gint64 time) {
+	for (int i = 0; loadedProperties[i]; i++) {
+		bench_record_set(mpv, time, loadedProperties[i]);
+	}
+	int64_t count = 0;
+	mpv_get_property(mpv, "track-list/count", MPV_FORMAT_INT64, &count);
+	for (int64_t i = 0; i < count; i++) {
+		for (int j = 0; trackProperties[j]; j++) {
+			gchar* name = g_strdup_printf("track-list/%ld/%s", i, trackProperties[j]);
+			bench_record_set(mpv, time, name);
+			g_free(name);
+		}
+	}
+}
+
+static void bench_record_change(const gint64 time, const mpv_event_property* detail) {
+	if (detail->format == MPV_FORMAT_DOUBLE) {
+		printf("%ld change %s %f\n", time, detail->name, *(double*)detail->data);
+	} else if (detail->format == MPV_FORMAT_FLAG) {
+		printf("%ld change %s %s\n", time, detail->name, *(int*)detail->data ? "yes" : "no");
+	} else {
+		printf("%ld change %s\n", time, detail->name);
+	}
+}
+
+static void bench_record_log(const gint64 time, const mpv_event_log_message* detail) {
+	gchar* text = g_strdup(detail->text);
+	g_strchomp(text);
+	g_strdelimit(text, "\n", ' ');
+	printf("%ld log %s %s %s\n", time, detail->level, detail->prefix, text);
+	g_free(text);
+}
+
+int main(int argc, char** argv) {
+	const gchar* video = BENCH_VIDEO;
+	double seconds = 10;
+	gint64 seekEvery = 0;
+	const gchar* logLevel = NULL;
+	for (int i = 1; i < argc; i++) {
+		if (i + 1 >= argc) {
+			fprintf(stderr, "usage: %s [--video PATH] [--seconds S] [--seek-every MS] [--log-level LEVEL]\n", argv[0]);
+			return 2;
+		} else if (g_str_equal(argv[i], "--video")) {
+			video = argv[++i];
+		} else if (g_str_equal(argv[i], "--seconds")) {
+			seconds = g_ascii_strtod(argv[++i], NULL);
+		} else if (g_str_equal(argv[i], "--seek-every")) {
+			seekEvery = g_ascii_strtoll(argv[++i], NULL, 10) * 1000;
+		} else if (g_str_equal(argv[i], "--log-level")) {
+			logLevel = argv[++i];
+		} else {
+			fprintf(stderr, "unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+	mpv_handle* mpv = mpv_create();
+	mpv_set_property_string(mpv, "vo", "libmpv");
+	mpv_set_property_string(mpv, "hwdec", "auto-safe");
+	mpv_set_property_string(mpv, "keep-open", "yes");
+	mpv_set_property_string(mpv, "idle", "yes");
+	mpv_set_property_string(mpv, "framedrop", "yes");
+	mpv_set_property_string(mpv, "ao", "null");
+	if (mpv_initialize(mpv) < 0) {
+		fprintf(stderr, "failed to initialize mpv\n");
+		return 1;
+	}
+	mpv_observe_property(mpv, 0, "time-pos/full", MPV_FORMAT_DOUBLE);
+	mpv_observe_property(mpv, 0, "demuxer-cache-time", MPV_FORMAT_DOUBLE);
+	mpv_observe_property(mpv, 0, "paused-for-cache", MPV_FORMAT_FLAG);
+	mpv_observe_property(mpv, 0, "pause", MPV_FORMAT_FLAG);
+	if (logLevel) {
+		mpv_request_log_messages(mpv, logLevel);
+	}
+	mpv_render_param params[] = {
+		{ MPV_RENDER_PARAM_API_TYPE, MPV_RENDER_API_TYPE_SW },
+		{ MPV_RENDER_PARAM_INVALID, NULL }
+	};
+	mpv_render_context* render;
+	if (mpv_render_context_create(&render, mpv, params) < 0) {
+		fprintf(stderr, "failed to create render context\n");
+		mpv_destroy(mpv);
+		return 1;
+	}
+	mpv_render_context_set_update_callback(render, bench_record_update, mpv);
+	int size[] = { BENCH_RECORD_WIDTH, BENCH_RECORD_HEIGHT };
+	size_t stride = BENCH_RECORD_WIDTH * 4;
+	guint8* buffer = g_malloc(BENCH_RECORD_WIDTH * BENCH_RECORD_HEIGHT * 4);
+	mpv_render_param renderParams[] = {
+		{ MPV_RENDER_PARAM_SW_SIZE, size },
+		{ MPV_RENDER_PARAM_SW_FORMAT, "rgb0" },
+		{ MPV_RENDER_PARAM_SW_STRIDE, &stride },
+		{ MPV_RENDER_PARAM_SW_POINTER, buffer },
+		{ MPV_RENDER_PARAM_INVALID, NULL }
+	};
+
+	printf("# %s\n", video);
+	const gchar* load[] = { "loadfile", video, NULL };
+	mpv_command(mpv, load);
+	const gint64 start = g_get_monotonic_time();
+	const gint64 end = start + (gint64)(seconds * G_USEC_PER_SEC);
+	gint64 nextSeek = seekEvery ? start + seekEvery : G_MAXINT64;
+	double duration = 0;
+	uint32_t seeks = 0;
+	for (gint64 now = start; now < end; now = g_get_monotonic_time()) {
+		const mpv_event* event = mpv_wait_event(mpv, 0.01);
+		const gint64 time = g_get_monotonic_time() - start;
+		if (g_atomic_int_compare_and_exchange(&frameAvailable, 1, 0) && (mpv_render_context_update(render) & MPV_RENDER_UPDATE_FRAME)) {
+			mpv_render_context_render(render, renderParams);
+			printf("%ld frame\n", time);
+		}
+		switch (event->event_id) {
+		case MPV_EVENT_FILE_LOADED:
+			bench_record_loaded(mpv, time);
+			mpv_get_property(mpv, "duration/full", MPV_FORMAT_DOUBLE, &duration);
+			printf("%ld file-loaded\n", time);
+			break;
+		case MPV_EVENT_VIDEO_RECONFIG:
+			bench_record_set(mpv, time, "dwidth");
+			bench_record_set(mpv, time, "dheight");
+			printf("%ld video-reconfig\n", time);
+			break;
+		case MPV_EVENT_PLAYBACK_RESTART:
+			printf("%ld playback-restart\n", time);
+			break;
+		case MPV_EVENT_END_FILE:
+			printf("%ld end-file %d %d\n", time, (int)((mpv_event_end_file*)event->data)->reason, ((mpv_event_end_file*)event->data)->error);
+			break;
+		case MPV_EVENT_PROPERTY_CHANGE:
+			bench_record_change(time, event->data);
+			break;
+		case MPV_EVENT_LOG_MESSAGE:
+			bench_record_log(time, event->data);
+			break;
+		default:
+			break;
+		}
+		if (now >= nextSeek && duration > 0) {
+			// spread seeks over the media in a fixed order
+			gchar* position = g_strdup_printf("%f", fmod(++seeks * 7.3, duration));
+			const gchar* seek[] = { "seek", position, "absolute", NULL };
+			mpv_command(mpv, seek);
+			g_free(position);
+			nextSeek += seekEvery;
+		}
+	}
+	mpv_render_context_free(render);
+	mpv_destroy(mpv);
+	g_free(buffer);
+	return 0;
+}
@@ -0,0 +1,230 @@
+// Renders a media as fast as possible through the texture populate of a player, on the EGL and software paths.
+//
+// usage: bench_render [--video PATH] [--frames N] [--sizes WxH,...] [--mode egl|sw|all] [--max-frame-rate FPS [--max-cost-ratio R]] [--json]
+//
+// For each case it reports frames per second, average, median and p99 time of populate and its render and upload stages,
+// and heap allocations of the main thread per populate. Costs are also reported per second of media, and with a max
+// frame rate each case runs without and with the cap, and a line compares both. The exit code is 1 if the capped
+// populate cost per second of media is over the given ratio of the uncapped one.
+
+#include "../video_view_plugin.c"
+#include "bench_flutter.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_WARMUP_FRAMES 10
+
+typedef struct {
+	gint64* values;
+	uint32_t count;
+} BenchSamples;
+
+typedef struct {
+	const gchar* video;
+	uint32_t frames;
+	double maxFrameRate;
+	double maxCostRatio;
+	bool json;
+} BenchOptions;
+
+typedef struct {
+	double mediaSeconds; // media time covered by the measured frames
+	double populate; // microseconds of populate per second of media
+	double wall; // microseconds of wall time per second of media, which includes decoding
+} BenchCost;
+
+static void bench_print_samples(const gchar* name, BenchSamples* samples, bool json) {
+	gint64 sum = 0;
+	for (uint32_t i = 0; i < samples->count; i++) {
+		sum += samples->values[i];
+	}
+	qsort(samples->values, samples->count, sizeof(gint64), bench_compare_int64);
+	const gint64 avg = samples->count ? sum / samples->count : 0;
+	const gint64 p50 = samples->count ? samples->values[samples->count / 2] : 0;
+	const gint64 p99 = samples->count ? samples->values[samples->count - 1 - samples->count / 100] : 0;
+	if (json) {
+		printf(",\"%s\":{\"avg\":%ld,\"p50\":%ld,\"p99\":%ld}", name, avg, p50, p99);
+	} else {
+		printf("  %s avg %ldus p50 %ldus p99 %ldus", name, avg, p50, p99);
+	}
+}
+
+static bool bench_run(const BenchOptions* options, const bool egl, const int width, const int height, const double frameRate, BenchCost* cost) {
+	g_autoptr(FlValue) created = bench_invoke("create", NULL);
+	if (!created) {
+		return false;
+	}
+	const int64_t id = fl_value_get_int(fl_value_lookup_string(created, "id"));
+	VideoViewPlugin* player = g_tree_lookup(players, (void*)id);
+	gchar* vf = g_strdup_printf("scale=%d:%d", width, height);
+	mpv_set_property_string(player->mpv, "vf", vf);
+	g_free(vf);
+	// decode and render without waiting for presentation time, and repeat the media until enough frames are rendered
+	mpv_set_property_string(player->mpv, "untimed", "yes");
+	mpv_set_property_string(player->mpv, "ao", "null");
+	mpv_set_property_string(player->mpv, "loop-file", "inf");
+	if (egl) {
+		bench_egl_make_current();
+	} else {
+		bench_egl_release();
+	}
+	video_view_plugin_open(player, options->video);
+	bench_egl_make_current();
+	while (player->state == 1) {
+		g_main_context_iteration(NULL, TRUE);
+	}
+	bool ok = player->state == 2 && player->eglRendering == egl;
+	if (ok) {
+		video_view_plugin_set_max_frame_rate(player, frameRate);
+		BenchSamples populate = { g_new(gint64, options->frames), 0 };
+		BenchSamples render = { g_new(gint64, options->frames), 0 };
+		BenchSamples upload = { g_new(gint64, options->frames), 0 };
+		uint64_t allocations = 0;
+		uint64_t allocatedBytes = 0;
+		gint64 start = 0;
+		gint64 populateSum = 0;
+		double mediaSeconds = 0;
+		double lastPosition = -1;
+		uint32_t frames = 0;
+		video_view_plugin_play(player);
+		while (populate.count < options->frames) {
+			if (!bench_take_frame(FL_TEXTURE(player))) {
+				g_main_context_iteration(NULL, TRUE);
+				continue;
+			}
+			const uint32_t renderCount = player->renderCount;
+			const uint32_t uploadCount = player->uploadCount;
+			const uint64_t allocCount = bench_alloc_count();
+			const uint64_t allocBytes = bench_alloc_bytes();
+			const gint64 populateStart = g_get_monotonic_time();
+			uint32_t target, name, w, h;
+			const bool populated = video_view_plugin_texture_populate(FL_TEXTURE_GL(player), &target, &name, &w, &h, NULL);
+			const gint64 populateEnd = g_get_monotonic_time();
+			double position = -1;
+			mpv_get_property(player->mpv, "time-pos", MPV_FORMAT_DOUBLE, &position);
+			if (!populated || ++frames <= BENCH_WARMUP_FRAMES) {
+				lastPosition = position;
+				continue;
+			}
+			// the media loops, so only forward moves are counted
+			if (lastPosition >= 0 && position > lastPosition) {
+				mediaSeconds += position - lastPosition;
+			}
+			lastPosition = position;
+			populateSum += populateEnd - populateStart;
+			if (!start) {
+				start = populateStart;
+			}
+			allocations += bench_alloc_count() - allocCount;
+			allocatedBytes += bench_alloc_bytes() - allocBytes;
+			populate.values[populate.count++] = populateEnd - populateStart;
+			if (player->renderCount != renderCount) {
+				render.values[render.count++] = player->renderTimes[(player->renderCount - 1) % VIDEO_VIEW_PLUGIN_STATS_SAMPLES];
+			}
+			if (player->uploadCount != uploadCount) {
+				upload.values[upload.count++] = player->uploadTimes[(player->uploadCount - 1) % VIDEO_VIEW_PLUGIN_STATS_SAMPLES];
+			}
+		}
+		const double seconds = (g_get_monotonic_time() - start) / 1e6;
+		const gchar* mode = egl ? "egl" : "sw";
+		cost->mediaSeconds = mediaSeconds;
+		cost->populate = mediaSeconds > 0 ? populateSum / mediaSeconds : 0;
+		cost->wall = mediaSeconds > 0 ? seconds * 1e6 / mediaSeconds : 0;
+		if (options->json) {
+			printf("{\"mode\":\"%s\",\"width\":%d,\"height\":%d,\"maxFrameRate\":%g,\"frames\":%u,\"seconds\":%.3f,\"fps\":%.1f", mode, width, height, frameRate, populate.count, seconds, populate.count / seconds);
+			printf(",\"mediaSeconds\":%.3f,\"populatePerMediaSecond\":%.0f,\"wallPerMediaSecond\":%.0f", mediaSeconds, cost->populate, cost->wall);
+		} else {
+			printf("%-3s %4dx%-4d %4g fps cap %6.1f fps  %.0fus populate %.0fus wall per media second", mode, width, height, frameRate, populate.count / seconds, cost->populate, cost->wall);
+		}
+		bench_print_samples("populate", &populate, options->json);
+		bench_print_samples("render", &render, options->json);
+		bench_print_samples("upload", &upload, options->json);
+		if (options->json) {
+			printf(",\"allocations\":%.2f,\"allocatedBytes\":%.0f}\n", (double)allocations / populate.count, (double)allocatedBytes / populate.count);
+		} else {
+			printf("  %.2f allocations %.0f bytes per frame\n", (double)allocations / populate.count, (double)allocatedBytes / populate.count);
+		}
+		g_free(populate.values);
+		g_free(render.values);
+		g_free(upload.values);
+	} else {
+		fprintf(stderr, "%s %dx%d: %s\n", egl ? "egl" : "sw", width, height, player->state == 2 ? "render path not available" : "failed to open media");
+	}
+	g_autoptr(FlValue) disposeArgs = fl_value_new_int(id);
+	g_autoptr(FlValue) disposed = bench_invoke("dispose", disposeArgs);
+	return ok;
+}
+
+int main(int argc, char** argv) {
+	BenchOptions options = { BENCH_VIDEO, 600, 0, 0, false };
+	const gchar* sizes = "640x360,1280x720,1920x1080,3840x2160";
+	const gchar* mode = "all";
+	for (int i = 1; i < argc; i++) {
+		if (g_str_equal(argv[i], "--json")) {
+			options.json = true;
+		} else if (i + 1 < argc && g_str_equal(argv[i], "--video")) {
+			options.video = argv[++i];
+		} else if (i + 1 < argc && g_str_equal(argv[i], "--frames")) {
+			options.frames = (uint32_t)g_ascii_strtoull(argv[++i], NULL, 10);
+		} else if (i + 1 < argc && g_str_equal(argv[i], "--sizes")) {
+			sizes = argv[++i];
+		} else if (i + 1 < argc && g_str_equal(argv[i], "--mode")) {
+			mode = argv[++i];
+		} else if (i + 1 < argc && g_str_equal(argv[i], "--max-frame-rate")) {
+			options.maxFrameRate = MAX(g_ascii_strtod(argv[++i], NULL), 0);
+		} else if (i + 1 < argc && g_str_equal(argv[i], "--max-cost-ratio")) {
+			options.maxCostRatio = g_ascii_strtod(argv[++i], NULL);
+		} else {
+			fprintf(stderr, "usage: %s [--video PATH] [--frames N] [--sizes WxH,...] [--mode egl|sw|all] [--max-frame-rate FPS [--max-cost-ratio R]] [--json]\n", argv[0]);
+			return 2;
+		}
+	}
+	if (options.frames == 0) {
+		options.frames = 1;
+	}
+	if (!bench_egl_init()) {
+		fprintf(stderr, "surfaceless EGL is not available\n");
+		return 1;
+	}
+	video_view_plugin_register_with_registrar(bench_flutter_init());
+	int failed = 0;
+	gchar** list = g_strsplit(sizes, ",", -1);
+	for (int m = 0; m < 2; m++) {
+		const bool egl = m == 0;
+		if (!g_str_equal(mode, "all") && !g_str_equal(mode, egl ? "egl" : "sw")) {
+			continue;
+		}
+		for (gchar** size = list; *size; size++) {
+			int width = 0;
+			int height = 0;
+			if (sscanf(*size, "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+				fprintf(stderr, "invalid size %s\n", *size);
+				failed++;
+			} else {
+				BenchCost full = { 0 };
+				if (!bench_run(&options, egl, width, height, 0, &full)) {
+					failed++;
+				} else if (options.maxFrameRate > 0) {
+					BenchCost capped = { 0 };
+					if (!bench_run(&options, egl, width, height, options.maxFrameRate, &capped)) {
+						failed++;
+					} else {
+						const double populateRatio = full.populate > 0 ? capped.populate / full.populate : 0;
+						const double wallRatio = full.wall > 0 ? capped.wall / full.wall : 0;
+						const bool over = options.maxCostRatio > 0 && populateRatio > options.maxCostRatio;
+						if (options.json) {
+							printf("{\"compare\":true,\"mode\":\"%s\",\"width\":%d,\"height\":%d,\"maxFrameRate\":%g,\"populateRatio\":%.3f,\"wallRatio\":%.3f,\"ok\":%s}\n", egl ? "egl" : "sw", width, height, options.maxFrameRate, populateRatio, wallRatio, over ? "false" : "true");
+						} else {
+							printf("%-3s %4dx%-4d capped at %g fps: %.2f of the populate cost, %.2f of the wall time per media second\n", egl ? "egl" : "sw", width, height, options.maxFrameRate, populateRatio, wallRatio);
+						}
+						failed += over ? 1 : 0;
+					}
+				}
+			}
+			fflush(stdout);
+		}
+	}
+	g_strfreev(list);
+	bench_egl_terminate();
+	return failed ? 1 : 0;
+}
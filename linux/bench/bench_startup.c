@@ -0,0 +1,118 @@
+// Measures what the plugin adds to app startup, and what the first player pays for loading libmpv and ICU instead.
+//
+// usage: bench_startup [--runs N]
+//
+// Each run is a new process, since the libraries stay loaded once they are. It times registering the plugin, the
+// first create, which loads the libraries, and a second create, and reads RSS after each step. A JSON line is written
+// per run and a summary line holds the medians. The plugin is linked without libmpv and ICU like the app bundle, so
+// the first create pays the real dlopen. The exit code is 1 if a create fails.
+
+#include <video_view/video_view_plugin.h>
+#include "bench_flutter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BENCH_STEPS 3
+
+static const gchar* steps[BENCH_STEPS] = { "register", "firstCreate", "secondCreate" };
+
+typedef struct {
+	gint64 time[BENCH_STEPS]; // microseconds of each step
+	uint64_t rss[BENCH_STEPS]; // bytes after each step
+	bool ok;
+} BenchStartup;
+
+// creates a player and returns whether it's created, unsupported is an error response without result
+static bool bench_create(void) {
+	FlValue* result = bench_invoke("create", NULL);
+	const bool ok = result && fl_value_get_type(result) == FL_VALUE_TYPE_MAP;
+	if (result) {
+		fl_value_unref(result);
+	}
+	return ok;
+}
+
+// runs in a new process and writes the result to fd
+static void bench_child(const int fd) {
+	BenchStartup result = { 0 };
+	// the app has its GL context before plugins are registered
+	if (!bench_egl_init()) {
+		_exit(1);
+	}
+	FlPluginRegistrar* registrar = bench_flutter_init();
+	gint64 start = g_get_monotonic_time();
+	video_view_plugin_register_with_registrar(registrar);
+	result.time[0] = g_get_monotonic_time() - start;
+	result.rss[0] = bench_rss();
+	result.ok = true;
+	for (int i = 1; i < BENCH_STEPS; i++) {
+		start = g_get_monotonic_time();
+		result.ok = bench_create() && result.ok;
+		result.time[i] = g_get_monotonic_time() - start;
+		result.rss[i] = bench_rss();
+	}
+	if (write(fd, &result, sizeof(result)) != sizeof(result)) {
+		_exit(1);
+	}
+	_exit(0);
+}
+
+int main(int argc, char** argv) {
+	uint32_t runs = 10;
+	for (int i = 1; i < argc; i++) {
+		if (i + 1 < argc && g_str_equal(argv[i], "--runs")) {
+			runs = MAX((uint32_t)g_ascii_strtoull(argv[++i], NULL, 10), 1);
+		} else {
+			fprintf(stderr, "usage: %s [--runs N]\n", argv[0]);
+			return 2;
+		}
+	}
+	GArray* times[BENCH_STEPS];
+	for (int i = 0; i < BENCH_STEPS; i++) {
+		times[i] = g_array_new(FALSE, FALSE, sizeof(int64_t));
+	}
+	uint64_t rss[BENCH_STEPS] = { 0 };
+	uint32_t failures = 0;
+	for (uint32_t run = 0; run < runs; run++) {
+		int fds[2];
+		if (pipe(fds)) {
+			perror("pipe");
+			return 1;
+		}
+		fflush(stdout);
+		const pid_t pid = fork();
+		if (pid == 0) {
+			close(fds[0]);
+			bench_child(fds[1]);
+		}
+		close(fds[1]);
+		BenchStartup result = { 0 };
+		const bool received = pid > 0 && read(fds[0], &result, sizeof(result)) == sizeof(result);
+		close(fds[0]);
+		if (pid > 0) {
+			waitpid(pid, NULL, 0);
+		}
+		if (!received || !result.ok) {
+			failures++;
+			printf("{\"run\":%u,\"ok\":false}\n", run);
+			continue;
+		}
+		printf("{\"run\":%u,\"ok\":true", run);
+		for (int i = 0; i < BENCH_STEPS; i++) {
+			g_array_append_val(times[i], result.time[i]);
+			rss[i] = result.rss[i];
+			printf(",\"%sUs\":%ld,\"%sRss\":%lu", steps[i], result.time[i], steps[i], result.rss[i]);
+		}
+		printf("}\n");
+	}
+	printf("{\"summary\":true,\"runs\":%u,\"failures\":%u", runs, failures);
+	for (int i = 0; i < BENCH_STEPS; i++) {
+		printf(",\"%sUs\":%ld", steps[i], bench_median(times[i]));
+		g_array_free(times[i], TRUE);
+	}
+	// the libraries mapped by the first create, which registering the plugin no longer pays at startup
+	printf(",\"librariesRss\":%ld}\n", (int64_t)(rss[1] - rss[0]));
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,1165 @@
+#include "fake_mpv.h"
+#include <mpv/client.h>
+#include <mpv/render.h>
+#include <stdio.h>
+#include <string.h>
+
+// A scripted stand-in of the libmpv client and render API used by the plugin. Nothing is decoded or rendered, a
+// thread per player only follows a timeline: either the rates of FakeMpvScript, or a trace recorded from real mpv by
+// bench_record. So the time spent by the plugin for each event, frame and method call can be measured without
+// decoder noise.
+//
+// A trace has one step per line, time is in microseconds from loadfile:
+//   <time> file-loaded | video-reconfig | playback-restart | frame
+//   <time> end-file <reason> <error>
+//   <time> set <name> [value]      sets a property without event, no value for unavailable
+//   <time> change <name> [value]   sets a property and notifies observers
+//   <time> log <level> <prefix> <text>
+
+#define FAKE_MPV_QUEUE_SIZE 1000 // events kept per handle like mpv, the rest is dropped
+#define FAKE_MPV_CATCH_UP 1000 // occurrences of a rate run at once, a rate further behind is rescheduled
+#define FAKE_MPV_CALLBACKS 8
+
+typedef enum {
+	FAKE_FILE_LOADED,
+	FAKE_VIDEO_RECONFIG,
+	FAKE_PLAYBACK_RESTART,
+	FAKE_FRAME,
+	FAKE_END_FILE,
+	FAKE_SET,
+	FAKE_CHANGE,
+	FAKE_LOG,
+} FakeAction;
+
+typedef struct {
+	gint64 time; // microseconds from loadfile in a trace, monotonic time when scheduled
+	FakeAction action;
+	gchar* name; // property name, or log level
+	gchar* value; // property value, NULL for unavailable, or log text
+	gchar* prefix; // log prefix
+	int reason; // end file reason
+	int error;
+} FakeStep;
+
+typedef struct {
+	mpv_event event;
+	union {
+		mpv_event_property property;
+		mpv_event_end_file endFile;
+		mpv_event_log_message log;
+	} data;
+	union {
+		double d;
+		int flag;
+		int64_t i;
+		char* s;
+	} value;
+	gchar* strings[3]; // freed with the event
+} FakeEvent;
+
+typedef struct {
+	gchar* name;
+	mpv_format format;
+	uint64_t userdata;
+} FakeObserved;
+
+typedef struct {
+	uint32_t count;
+	void (*callbacks[FAKE_MPV_CALLBACKS])(void*);
+	void* data[FAKE_MPV_CALLBACKS];
+} FakeCallbacks;
+
+typedef struct FakeCore FakeCore;
+
+struct mpv_handle {
+	FakeCore* core;
+	GQueue events;
+	FakeEvent* current; // the event returned by the last mpv_wait_event
+	mpv_event none;
+	GArray* observed;
+	int logLevel; // minimum level of log messages, 0 for none
+	bool wakeup; // mpv_wakeup is called
+	bool notify; // wakeup callback should be called
+	void (*wakeupCallback)(void*);
+	void* wakeupData;
+};
+
+struct mpv_render_context {
+	FakeCore* core;
+	mpv_render_update_fn callback;
+	void* callbackData;
+	bool frame; // a frame is available since the last render
+	bool notify; // update callback should be called
+};
+
+struct FakeCore {
+	gint refs;
+	GMutex mutex;
+	GCond cond; // wakes up the timeline thread and handles waiting for events
+	GThread* thread;
+	bool stop;
+	FakeMpvScript script;
+	GPtrArray* trace; // steps to replay on each loadfile, NULL for the scripted timeline
+	uint32_t traceIndex;
+	GPtrArray* handles;
+	mpv_handle* main;
+	mpv_render_context* render;
+	GHashTable* properties; // values as strings
+	GQueue scheduled; // pending steps sorted by time
+	gint64 loadTime; // monotonic time of the last loadfile, 0 if no file
+	bool loaded;
+	bool paused;
+	double position; // seconds
+	gint64 lastTick;
+	gint64 nextFrame; // next time of each rate, 0 to start over
+	gint64 nextTime;
+	gint64 nextCache;
+	gint64 nextReconfig;
+	gint64 nextRestart;
+	gint64 nextLog;
+	uint64_t logCount;
+};
+
+static const struct {
+	const gchar* name;
+	int level;
+} fakeLogLevels[] = {
+	{ "no", 0 }, { "fatal", 10 }, { "error", 20 }, { "warn", 30 }, { "info", 40 }, { "status", 45 }, { "v", 50 }, { "debug", 60 }, { "trace", 70 },
+};
+
+static GMutex fakeMutex;
+static FakeMpvScript fakeScript = { 30, 30, 1, 0, 0, 0, 20000, 10000, 1920, 1080, 60, 1 };
+static GPtrArray* fakeTrace;
+static FakeMpvCounters fakeCounters;
+
+#define FAKE_MPV_COUNT(field) __atomic_add_fetch(&fakeCounters.field, 1, __ATOMIC_RELAXED)
+
+/* script and trace */
+
+static void fake_step_free(void* data) {
+	FakeStep* step = data;
+	g_free(step->name);
+	g_free(step->value);
+	g_free(step->prefix);
+	g_free(step);
+}
+
+void fake_mpv_get_script(FakeMpvScript* script) {
+	g_mutex_lock(&fakeMutex);
+	*script = fakeScript;
+	g_mutex_unlock(&fakeMutex);
+}
+
+void fake_mpv_set_script(const FakeMpvScript* script) {
+	g_mutex_lock(&fakeMutex);
+	fakeScript = *script;
+	if (fakeScript.traceSpeed <= 0) {
+		fakeScript.traceSpeed = 1;
+	}
+	g_mutex_unlock(&fakeMutex);
+}
+
+static int fake_log_level(const gchar* name) {
+	for (uint32_t i = 0; i < G_N_ELEMENTS(fakeLogLevels); i++) {
+		if (g_str_equal(fakeLogLevels[i].name, name)) {
+			return fakeLogLevels[i].level;
+		}
+	}
+	return -1;
+}
+
+static FakeStep* fake_parse_step(const gchar* line) {
+	gchar** parts = g_strsplit(line, " ", 3);
+	FakeStep* step = NULL;
+	if (parts[0] && parts[1]) {
+		step = g_new0(FakeStep, 1);
+		step->time = g_ascii_strtoll(parts[0], NULL, 10);
+		const gchar* action = parts[1];
+		const gchar* rest = parts[2] ? parts[2] : "";
+		if (g_str_equal(action, "file-loaded")) {
+			step->action = FAKE_FILE_LOADED;
+		} else if (g_str_equal(action, "video-reconfig")) {
+			step->action = FAKE_VIDEO_RECONFIG;
+		} else if (g_str_equal(action, "playback-restart")) {
+			step->action = FAKE_PLAYBACK_RESTART;
+		} else if (g_str_equal(action, "frame")) {
+			step->action = FAKE_FRAME;
+		} else if (g_str_equal(action, "end-file")) {
+			step->action = FAKE_END_FILE;
+			if (sscanf(rest, "%d %d", &step->reason, &step->error) != 2) {
+				g_clear_pointer(&step, fake_step_free);
+			}
+		} else if (g_str_equal(action, "set") || g_str_equal(action, "change")) {
+			step->action = g_str_equal(action, "set") ? FAKE_SET : FAKE_CHANGE;
+			gchar** property = g_strsplit(rest, " ", 2);
+			if (property[0] && property[0][0]) {
+				step->name = g_strdup(property[0]);
+				step->value = g_strdup(property[1]);
+			} else {
+				g_clear_pointer(&step, fake_step_free);
+			}
+			g_strfreev(property);
+		} else if (g_str_equal(action, "log")) {
+			step->action = FAKE_LOG;
+			gchar** log = g_strsplit(rest, " ", 3);
+			if (log[0] && log[1] && fake_log_level(log[0]) > 0) {
+				step->name = g_strdup(log[0]);
+				step->prefix = g_strdup(log[1]);
+				step->value = g_strdup(log[2] ? log[2] : "");
+			} else {
+				g_clear_pointer(&step, fake_step_free);
+			}
+			g_strfreev(log);
+		} else {
+			g_clear_pointer(&step, fake_step_free);
+		}
+	}
+	g_strfreev(parts);
+	return step;
+}
+
+bool fake_mpv_load_trace(const gchar* path) {
+	GPtrArray* trace = NULL;
+	if (path) {
+		gchar* text = NULL;
+		if (!g_file_get_contents(path, &text, NULL, NULL)) {
+			return false;
+		}
+		trace = g_ptr_array_new_with_free_func(fake_step_free);
+		gchar** lines = g_strsplit(text, "\n", -1);
+		g_free(text);
+		for (gchar** line = lines; *line; line++) {
+			g_strchomp(*line);
+			if (!(*line)[0] || (*line)[0] == '#') {
+				continue;
+			}
+			FakeStep* step = fake_parse_step(*line);
+			if (!step) {
+				g_ptr_array_unref(trace);
+				g_strfreev(lines);
+				return false;
+			}
+			g_ptr_array_add(trace, step);
+		}
+		g_strfreev(lines);
+	}
+	g_mutex_lock(&fakeMutex);
+	if (fakeTrace) {
+		g_ptr_array_unref(fakeTrace);
+	}
+	fakeTrace = trace;
+	g_mutex_unlock(&fakeMutex);
+	return true;
+}
+
+void fake_mpv_get_counters(FakeMpvCounters* counters) {
+	counters->events = __atomic_load_n(&fakeCounters.events, __ATOMIC_RELAXED);
+	counters->clientEvents = __atomic_load_n(&fakeCounters.clientEvents, __ATOMIC_RELAXED);
+	counters->dropped = __atomic_load_n(&fakeCounters.dropped, __ATOMIC_RELAXED);
+	counters->commands = __atomic_load_n(&fakeCounters.commands, __ATOMIC_RELAXED);
+	counters->propertyReads = __atomic_load_n(&fakeCounters.propertyReads, __ATOMIC_RELAXED);
+	counters->propertyWrites = __atomic_load_n(&fakeCounters.propertyWrites, __ATOMIC_RELAXED);
+	counters->renders = __atomic_load_n(&fakeCounters.renders, __ATOMIC_RELAXED);
+}
+
+/* properties and events, called with the core locked */
+
+static void fake_event_free(FakeEvent* event) {
+	if (event) {
+		for (uint32_t i = 0; i < G_N_ELEMENTS(event->strings); i++) {
+			g_free(event->strings[i]);
+		}
+		g_free(event);
+	}
+}
+
+static double fake_duration(FakeCore* core) {
+	const gchar* duration = g_hash_table_lookup(core->properties, "duration/full");
+	return duration ? g_ascii_strtod(duration, NULL) : 0;
+}
+
+// returns the value of a property as string, NULL if unavailable
+static gchar* fake_get_string(FakeCore* core, const gchar* name) {
+	if (g_str_equal(name, "time-pos/full") || g_str_equal(name, "time-pos") || g_str_equal(name, "playback-time")) {
+		return core->loaded ? g_strdup_printf("%f", core->position) : NULL;
+	} else if (g_str_equal(name, "demuxer-cache-time")) {
+		return core->loaded ? g_strdup_printf("%f", MIN(core->position + 10, fake_duration(core))) : NULL;
+	} else if (g_str_equal(name, "pause")) {
+		return g_strdup(core->paused ? "yes" : "no");
+	} else if (g_str_equal(name, "eof-reached")) {
+		return g_strdup(core->loaded && core->position >= fake_duration(core) ? "yes" : "no");
+	}
+	return g_strdup(g_hash_table_lookup(core->properties, name));
+}
+
+static mpv_node* fake_node_list(mpv_node* node, const mpv_format format, const int num) {
+	node->format = format;
+	node->u.list = g_new0(mpv_node_list, 1);
+	node->u.list->num = num;
+	node->u.list->values = g_new0(mpv_node, num);
+	if (format == MPV_FORMAT_NODE_MAP) {
+		node->u.list->keys = g_new0(char*, num);
+	}
+	return node->u.list->values;
+}
+
+static void fake_node_double(mpv_node* map, const int index, const gchar* key, const double value) {
+	map->u.list->keys[index] = g_strdup(key);
+	map->u.list->values[index].format = MPV_FORMAT_DOUBLE;
+	map->u.list->values[index].u.double_ = value;
+}
+
+static void fake_node_int(mpv_node* map, const int index, const gchar* key, const int64_t value) {
+	map->u.list->keys[index] = g_strdup(key);
+	map->u.list->values[index].format = MPV_FORMAT_INT64;
+	map->u.list->values[index].u.int64 = value;
+}
+
+// a local file with the whole remaining media in the demuxer cache at 2 Mbps
+static void fake_cache_state(FakeCore* core, mpv_node* node) {
+	const double duration = fake_duration(core);
+	const double end = MIN(core->position + 10, duration);
+	fake_node_list(node, MPV_FORMAT_NODE_MAP, 7);
+	node->u.list->keys[0] = g_strdup("seekable-ranges");
+	mpv_node* range = fake_node_list(&node->u.list->values[0], MPV_FORMAT_NODE_ARRAY, 1);
+	fake_node_list(range, MPV_FORMAT_NODE_MAP, 2);
+	fake_node_double(range, 0, "start", 0);
+	fake_node_double(range, 1, "end", end);
+	fake_node_double(node, 1, "cache-end", end);
+	fake_node_double(node, 2, "cache-duration", end - core->position);
+	fake_node_int(node, 3, "fw-bytes", (int64_t)((end - core->position) * 250000));
+	fake_node_int(node, 4, "total-bytes", (int64_t)(end * 250000));
+	fake_node_int(node, 5, "file-cache-bytes", 0);
+	fake_node_int(node, 6, "raw-input-rate", 0);
+}
+
+static int fake_convert(const gchar* value, const mpv_format format, void* data) {
+	if (!value) {
+		return MPV_ERROR_PROPERTY_UNAVAILABLE;
+	}
+	gchar* end;
+	switch (format) {
+	case MPV_FORMAT_STRING:
+	case MPV_FORMAT_OSD_STRING:
+		*(char**)data = g_strdup(value);
+		return MPV_ERROR_SUCCESS;
+	case MPV_FORMAT_FLAG:
+		*(int*)data = g_str_equal(value, "yes");
+		return MPV_ERROR_SUCCESS;
+	case MPV_FORMAT_INT64:
+		*(int64_t*)data = g_ascii_strtoll(value, &end, 10);
+		return end == value ? MPV_ERROR_PROPERTY_FORMAT : MPV_ERROR_SUCCESS;
+	case MPV_FORMAT_DOUBLE:
+		*(double*)data = g_ascii_strtod(value, &end);
+		return end == value ? MPV_ERROR_PROPERTY_FORMAT : MPV_ERROR_SUCCESS;
+	case MPV_FORMAT_NODE:
+		((mpv_node*)data)->format = MPV_FORMAT_STRING;
+		((mpv_node*)data)->u.string = g_strdup(value);
+		return MPV_ERROR_SUCCESS;
+	default:
+		return MPV_ERROR_PROPERTY_FORMAT;
+	}
+}
+
+static FakeEvent* fake_post(mpv_handle* handle, const mpv_event_id id) {
+	if (id != MPV_EVENT_SHUTDOWN && handle->events.length >= FAKE_MPV_QUEUE_SIZE) {
+		FAKE_MPV_COUNT(dropped);
+		return NULL;
+	}
+	FakeEvent* event = g_new0(FakeEvent, 1);
+	event->event.event_id = id;
+	g_queue_push_tail(&handle->events, event);
+	handle->notify = true;
+	g_cond_broadcast(&handle->core->cond);
+	return event;
+}
+
+static void fake_post_main(FakeCore* core, const mpv_event_id id) {
+	if (core->main) {
+		fake_post(core->main, id);
+	}
+}
+
+static void fake_post_change(mpv_handle* handle, const FakeObserved* observed, const gchar* value) {
+	FakeEvent* event = fake_post(handle, MPV_EVENT_PROPERTY_CHANGE);
+	if (event) {
+		event->event.reply_userdata = observed->userdata;
+		event->event.data = &event->data.property;
+		event->data.property.name = observed->name;
+		event->data.property.format = MPV_FORMAT_NONE;
+		if (fake_convert(value, observed->format, &event->value) == MPV_ERROR_SUCCESS) {
+			event->data.property.format = observed->format;
+			event->data.property.data = &event->value;
+			if (observed->format == MPV_FORMAT_STRING) {
+				event->strings[0] = event->value.s;
+			}
+		}
+	}
+}
+
+static void fake_change(FakeCore* core, const gchar* name) {
+	gchar* value = NULL;
+	bool read = false;
+	for (guint i = 0; i < core->handles->len; i++) {
+		mpv_handle* handle = g_ptr_array_index(core->handles, i);
+		for (guint j = 0; j < handle->observed->len; j++) {
+			const FakeObserved* observed = &g_array_index(handle->observed, FakeObserved, j);
+			if (g_str_equal(observed->name, name)) {
+				if (!read) {
+					value = fake_get_string(core, name);
+					read = true;
+				}
+				fake_post_change(handle, observed, value);
+			}
+		}
+	}
+	g_free(value);
+}
+
+static void fake_log(FakeCore* core, const gchar* level, const gchar* prefix, const gchar* text) {
+	const int value = fake_log_level(level);
+	for (guint i = 0; i < core->handles->len; i++) {
+		mpv_handle* handle = g_ptr_array_index(core->handles, i);
+		if (handle->logLevel >= value) {
+			FakeEvent* event = fake_post(handle, MPV_EVENT_LOG_MESSAGE);
+			if (event) {
+				event->event.data = &event->data.log;
+				event->data.log.level = event->strings[0] = g_strdup(level);
+				event->data.log.prefix = event->strings[1] = g_strdup(prefix);
+				event->data.log.text = event->strings[2] = g_strdup_printf("%s\n", text);
+				event->data.log.log_level = value;
+			}
+		}
+	}
+}
+
+static void fake_end_file(FakeCore* core, const int reason, const int error) {
+	if (core->main) {
+		FakeEvent* event = fake_post(core->main, MPV_EVENT_END_FILE);
+		if (event) {
+			event->event.data = &event->data.endFile;
+			event->data.endFile.reason = reason;
+			event->data.endFile.error = error;
+		}
+	}
+	core->loaded = false;
+}
+
+static void fake_frame(FakeCore* core) {
+	if (core->render) {
+		core->render->frame = true;
+		core->render->notify = true;
+	}
+}
+
+static void fake_set(FakeCore* core, const gchar* name, const gchar* value) {
+	if (g_str_equal(name, "time-pos/full") || g_str_equal(name, "time-pos")) {
+		if (value) {
+			core->position = g_ascii_strtod(value, NULL);
+		}
+	} else if (g_str_equal(name, "pause")) {
+		// pausing is up to the player in a replay
+	} else if (value) {
+		g_hash_table_replace(core->properties, g_strdup(name), g_strdup(value));
+	} else {
+		g_hash_table_remove(core->properties, name);
+	}
+}
+
+// properties of the scripted media, read by the plugin when the file is loaded
+static void fake_populate(FakeCore* core) {
+	const FakeMpvScript* script = &core->script;
+	const gchar* values[] = {
+		"seekable", "yes",
+		"partially-seekable", "no",
+		"demuxer-via-network", "no",
+		"demuxer-start-time", "0",
+		"current-demuxer", "fake",
+		"hwdec-current", "no",
+		"vid", "1",
+		"avsync", "0",
+		"cache-speed", "0",
+		"decoder-frame-drop-count", "0",
+		"frame-drop-count", "0",
+		"track-list/count", "2",
+		"track-list/0/type", "video",
+		"track-list/0/id", "1",
+		"track-list/0/codec", "h264",
+		"track-list/1/type", "audio",
+		"track-list/1/id", "1",
+		"track-list/1/default", "yes",
+		"track-list/1/lang", "eng",
+		"track-list/1/codec", "aac",
+		"track-list/1/demux-channel-count", "2",
+		"track-list/1/demux-samplerate", "48000",
+		NULL
+	};
+	for (int i = 0; values[i]; i += 2) {
+		g_hash_table_replace(core->properties, g_strdup(values[i]), g_strdup(values[i + 1]));
+	}
+	g_hash_table_replace(core->properties, g_strdup("duration/full"), g_strdup_printf("%f", script->duration));
+	g_hash_table_replace(core->properties, g_strdup("container-fps"), g_strdup_printf("%f", script->frameRate));
+	g_hash_table_replace(core->properties, g_strdup("estimated-vf-fps"), g_strdup_printf("%f", script->frameRate));
+	g_hash_table_replace(core->properties, g_strdup("dwidth"), g_strdup_printf("%d", script->width));
+	g_hash_table_replace(core->properties, g_strdup("dheight"), g_strdup_printf("%d", script->height));
+	g_hash_table_replace(core->properties, g_strdup("track-list/0/demux-w"), g_strdup_printf("%d", script->width));
+	g_hash_table_replace(core->properties, g_strdup("track-list/0/demux-h"), g_strdup_printf("%d", script->height));
+}
+
+static void fake_run_step(FakeCore* core, const FakeStep* step) {
+	switch (step->action) {
+	case FAKE_FILE_LOADED:
+		if (!core->trace) {
+			fake_populate(core);
+		}
+		core->loaded = true;
+		core->position = 0;
+		core->nextFrame = core->nextTime = core->nextCache = core->nextReconfig = core->nextRestart = 0;
+		fake_post_main(core, MPV_EVENT_FILE_LOADED);
+		break;
+	case FAKE_VIDEO_RECONFIG:
+		fake_post_main(core, MPV_EVENT_VIDEO_RECONFIG);
+		break;
+	case FAKE_PLAYBACK_RESTART:
+		fake_post_main(core, MPV_EVENT_PLAYBACK_RESTART);
+		fake_frame(core);
+		break;
+	case FAKE_FRAME:
+		fake_frame(core);
+		break;
+	case FAKE_END_FILE:
+		fake_end_file(core, step->reason, step->error);
+		break;
+	case FAKE_SET:
+		fake_set(core, step->name, step->value);
+		break;
+	case FAKE_CHANGE:
+		fake_set(core, step->name, step->value);
+		if (!g_str_equal(step->name, "pause")) {
+			fake_change(core, step->name);
+		}
+		break;
+	case FAKE_LOG:
+		fake_log(core, step->name, step->prefix, step->value);
+		break;
+	}
+}
+
+static gint fake_compare_steps(gconstpointer a, gconstpointer b, gpointer data) {
+	const gint64 x = ((const FakeStep*)a)->time;
+	const gint64 y = ((const FakeStep*)b)->time;
+	return x < y ? -1 : x > y;
+}
+
+static void fake_schedule(FakeCore* core, const gint64 delay, const FakeAction action) {
+	FakeStep* step = g_new0(FakeStep, 1);
+	step->time = g_get_monotonic_time() + delay;
+	step->action = action;
+	g_queue_insert_sorted(&core->scheduled, step, fake_compare_steps, NULL);
+	g_cond_broadcast(&core->cond);
+}
+
+static void fake_unload(FakeCore* core) {
+	g_queue_clear_full(&core->scheduled, fake_step_free);
+	if (core->loadTime) {
+		fake_end_file(core, MPV_END_FILE_REASON_STOP, 0);
+	}
+	core->loadTime = 0;
+	core->position = 0;
+}
+
+static void fake_load(FakeCore* core) {
+	fake_unload(core);
+	core->loadTime = g_get_monotonic_time();
+	core->traceIndex = 0;
+	if (!core->trace) {
+		const gint64 delay = core->script.openDelay;
+		fake_schedule(core, delay, FAKE_FILE_LOADED);
+		fake_schedule(core, delay + 1, FAKE_VIDEO_RECONFIG);
+		fake_schedule(core, delay + 2, FAKE_PLAYBACK_RESTART);
+	}
+	g_cond_broadcast(&core->cond);
+}
+
+static void fake_set_pause(FakeCore* core, const bool paused) {
+	if (core->paused != paused) {
+		core->paused = paused;
+		core->nextFrame = core->nextTime = 0;
+		fake_change(core, "pause");
+		g_cond_broadcast(&core->cond);
+	}
+}
+
+static int fake_command(FakeCore* core, const gchar** args) {
+	FAKE_MPV_COUNT(commands);
+	if (!args[0]) {
+		return MPV_ERROR_INVALID_PARAMETER;
+	} else if (g_str_equal(args[0], "loadfile")) {
+		if (!args[1]) {
+			return MPV_ERROR_INVALID_PARAMETER;
+		}
+		fake_load(core);
+	} else if (g_str_equal(args[0], "stop")) {
+		fake_unload(core);
+	} else if (g_str_equal(args[0], "seek")) {
+		if (!args[1]) {
+			return MPV_ERROR_INVALID_PARAMETER;
+		} else if (!core->loaded) {
+			return MPV_ERROR_COMMAND;
+		}
+		const double value = g_ascii_strtod(args[1], NULL);
+		const double position = args[2] && strstr(args[2], "relative") ? core->position + value : value;
+		core->position = CLAMP(position, 0, fake_duration(core));
+		fake_change(core, "time-pos/full");
+		fake_schedule(core, core->script.seekDelay, FAKE_PLAYBACK_RESTART);
+	} else if (g_str_equal(args[0], "frame-step") || g_str_equal(args[0], "frame-back-step")) {
+		if (!core->loaded) {
+			return MPV_ERROR_COMMAND;
+		}
+		const double step = core->script.frameRate > 0 ? 1 / core->script.frameRate : 0.04;
+		core->position = CLAMP(core->position + (args[0][6] == 'b' ? -step : step), 0, fake_duration(core));
+		fake_set_pause(core, true);
+		fake_change(core, "time-pos/full");
+		fake_schedule(core, 1000, FAKE_FRAME);
+	}
+	return MPV_ERROR_SUCCESS;
+}
+
+static void fake_collect(FakeCore* core, FakeCallbacks* callbacks) {
+	callbacks->count = 0;
+	for (guint i = 0; i < core->handles->len; i++) {
+		mpv_handle* handle = g_ptr_array_index(core->handles, i);
+		if (handle->notify) {
+			handle->notify = false;
+			if (handle->wakeupCallback && callbacks->count < FAKE_MPV_CALLBACKS) {
+				callbacks->callbacks[callbacks->count] = handle->wakeupCallback;
+				callbacks->data[callbacks->count++] = handle->wakeupData;
+			}
+		}
+	}
+	if (core->render && core->render->notify) {
+		core->render->notify = false;
+		if (core->render->callback && callbacks->count < FAKE_MPV_CALLBACKS) {
+			callbacks->callbacks[callbacks->count] = core->render->callback;
+			callbacks->data[callbacks->count++] = core->render->callbackData;
+		}
+	}
+}
+
+// callbacks are called without the lock, they may block on locks held by threads calling into mpv
+static void fake_unlock(FakeCore* core) {
+	FakeCallbacks callbacks;
+	fake_collect(core, &callbacks);
+	g_mutex_unlock(&core->mutex);
+	for (uint32_t i = 0; i < callbacks.count; i++) {
+		callbacks.callbacks[i](callbacks.data[i]);
+	}
+}
+
+/* timeline thread */
+
+static uint32_t fake_due(gint64* next, const double rate, const gint64 now) {
+	if (rate <= 0) {
+		return 0;
+	}
+	const gint64 period = MAX((gint64)(G_USEC_PER_SEC / rate), 1);
+	if (*next == 0) {
+		*next = now + period;
+		return 0;
+	}
+	uint32_t count = 0;
+	while (*next <= now && count < FAKE_MPV_CATCH_UP) {
+		count++;
+		*next += period;
+	}
+	if (*next <= now) {
+		*next = now + period;
+	}
+	return count;
+}
+
+static gint64 fake_deadline(const gint64 deadline, const gint64 next, const double rate, const gint64 now) {
+	return rate <= 0 ? deadline : MIN(deadline, next ? next : now);
+}
+
+static void fake_advance(FakeCore* core, const gint64 now) {
+	if (core->loaded && !core->paused && !core->trace) {
+		const gchar* speed = g_hash_table_lookup(core->properties, "speed");
+		core->position += (now - core->lastTick) / 1e6 * (speed ? g_ascii_strtod(speed, NULL) : 1);
+		const double duration = fake_duration(core);
+		if (core->position >= duration) {
+			// keep-open pauses at the end
+			core->position = duration;
+			fake_set_pause(core, true);
+		}
+	}
+	core->lastTick = now;
+}
+
+static void fake_unref(FakeCore* core);
+
+static void* fake_run(void* data) {
+	FakeCore* core = data;
+	g_mutex_lock(&core->mutex);
+	core->lastTick = g_get_monotonic_time();
+	while (!core->stop) {
+		const gint64 now = g_get_monotonic_time();
+		fake_advance(core, now);
+		for (FakeStep* step = g_queue_peek_head(&core->scheduled); step && step->time <= now; step = g_queue_peek_head(&core->scheduled)) {
+			g_queue_pop_head(&core->scheduled);
+			fake_run_step(core, step);
+			fake_step_free(step);
+		}
+		gint64 deadline = G_MAXINT64;
+		const FakeMpvScript* script = &core->script;
+		if (core->trace && core->loadTime) {
+			for (; core->traceIndex < core->trace->len; core->traceIndex++) {
+				const FakeStep* step = g_ptr_array_index(core->trace, core->traceIndex);
+				const gint64 time = core->loadTime + (gint64)(step->time / script->traceSpeed);
+				if (time > now) {
+					deadline = time;
+					break;
+				}
+				fake_run_step(core, step);
+			}
+		} else if (core->loaded) {
+			const bool playing = !core->paused;
+			for (uint32_t i = fake_due(&core->nextFrame, playing ? script->frameRate : 0, now); i > 0; i--) {
+				fake_frame(core);
+			}
+			for (uint32_t i = fake_due(&core->nextTime, playing ? script->timeRate : 0, now); i > 0; i--) {
+				fake_change(core, "time-pos/full");
+			}
+			for (uint32_t i = fake_due(&core->nextCache, script->cacheRate, now); i > 0; i--) {
+				fake_change(core, "demuxer-cache-time");
+			}
+			for (uint32_t i = fake_due(&core->nextReconfig, script->reconfigRate, now); i > 0; i--) {
+				fake_post_main(core, MPV_EVENT_VIDEO_RECONFIG);
+			}
+			for (uint32_t i = fake_due(&core->nextRestart, script->restartRate, now); i > 0; i--) {
+				fake_post_main(core, MPV_EVENT_PLAYBACK_RESTART);
+			}
+			deadline = fake_deadline(deadline, core->nextFrame, playing ? script->frameRate : 0, now);
+			deadline = fake_deadline(deadline, core->nextTime, playing ? script->timeRate : 0, now);
+			deadline = fake_deadline(deadline, core->nextCache, script->cacheRate, now);
+			deadline = fake_deadline(deadline, core->nextReconfig, script->reconfigRate, now);
+			deadline = fake_deadline(deadline, core->nextRestart, script->restartRate, now);
+		}
+		for (uint32_t i = fake_due(&core->nextLog, script->logRate, now); i > 0; i--) {
+			gchar* text = g_strdup_printf("message %lu", ++core->logCount);
+			fake_log(core, "info", "fake", text);
+			g_free(text);
+		}
+		deadline = fake_deadline(deadline, core->nextLog, script->logRate, now);
+		const FakeStep* scheduled = g_queue_peek_head(&core->scheduled);
+		if (scheduled) {
+			deadline = MIN(deadline, scheduled->time);
+		}
+		FakeCallbacks callbacks;
+		fake_collect(core, &callbacks);
+		if (callbacks.count) {
+			g_mutex_unlock(&core->mutex);
+			for (uint32_t i = 0; i < callbacks.count; i++) {
+				callbacks.callbacks[i](callbacks.data[i]);
+			}
+			g_mutex_lock(&core->mutex);
+		} else if (deadline == G_MAXINT64) {
+			g_cond_wait(&core->cond, &core->mutex);
+		} else if (deadline > now) {
+			g_cond_wait_until(&core->cond, &core->mutex, deadline);
+		}
+	}
+	g_mutex_unlock(&core->mutex);
+	fake_unref(core);
+	return NULL;
+}
+
+/* core and handles */
+
+static void fake_unref(FakeCore* core) {
+	if (g_atomic_int_dec_and_test(&core->refs)) {
+		g_queue_clear_full(&core->scheduled, fake_step_free);
+		g_hash_table_unref(core->properties);
+		g_ptr_array_unref(core->handles);
+		if (core->trace) {
+			g_ptr_array_unref(core->trace);
+		}
+		g_mutex_clear(&core->mutex);
+		g_cond_clear(&core->cond);
+		g_free(core);
+	}
+}
+
+static void fake_observed_free(void* data) {
+	g_free(((FakeObserved*)data)->name);
+}
+
+static mpv_handle* fake_handle_new(FakeCore* core) {
+	mpv_handle* handle = g_new0(mpv_handle, 1);
+	handle->core = core;
+	g_queue_init(&handle->events);
+	handle->observed = g_array_new(FALSE, FALSE, sizeof(FakeObserved));
+	g_array_set_clear_func(handle->observed, fake_observed_free);
+	g_atomic_int_inc(&core->refs);
+	g_ptr_array_add(core->handles, handle);
+	return handle;
+}
+
+mpv_handle* mpv_create(void) {
+	FakeCore* core = g_new0(FakeCore, 1);
+	g_mutex_init(&core->mutex);
+	g_cond_init(&core->cond);
+	core->properties = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	core->handles = g_ptr_array_new();
+	g_queue_init(&core->scheduled);
+	g_mutex_lock(&fakeMutex);
+	core->script = fakeScript;
+	core->trace = fakeTrace ? g_ptr_array_ref(fakeTrace) : NULL;
+	g_mutex_unlock(&fakeMutex);
+	g_mutex_lock(&core->mutex);
+	core->main = fake_handle_new(core);
+	g_mutex_unlock(&core->mutex);
+	return core->main;
+}
+
+mpv_handle* mpv_create_client(mpv_handle* ctx, const char* name) {
+	FakeCore* core = ctx->core;
+	g_mutex_lock(&core->mutex);
+	mpv_handle* handle = core->stop ? NULL : fake_handle_new(core);
+	g_mutex_unlock(&core->mutex);
+	return handle;
+}
+
+int mpv_initialize(mpv_handle* ctx) {
+	FakeCore* core = ctx->core;
+	g_mutex_lock(&core->mutex);
+	if (core->thread) {
+		g_mutex_unlock(&core->mutex);
+		return MPV_ERROR_INVALID_PARAMETER;
+	}
+	g_atomic_int_inc(&core->refs);
+	core->thread = g_thread_new("fake_mpv", fake_run, core);
+	g_mutex_unlock(&core->mutex);
+	return MPV_ERROR_SUCCESS;
+}
+
+// the timeline thread is not joined, a callback it is calling may wait for a lock held by the caller
+void mpv_destroy(mpv_handle* ctx) {
+	FakeCore* core = ctx->core;
+	g_mutex_lock(&core->mutex);
+	g_ptr_array_remove(core->handles, ctx);
+	if (ctx == core->main) {
+		core->main = NULL;
+		core->stop = true;
+		if (core->render) {
+			core->render->callback = NULL;
+		}
+		for (guint i = 0; i < core->handles->len; i++) {
+			fake_post(g_ptr_array_index(core->handles, i), MPV_EVENT_SHUTDOWN);
+		}
+		if (core->thread) {
+			g_thread_unref(core->thread);
+			core->thread = NULL;
+		}
+		g_cond_broadcast(&core->cond);
+	}
+	fake_unlock(core);
+	g_queue_clear_full(&ctx->events, (GDestroyNotify)fake_event_free);
+	fake_event_free(ctx->current);
+	g_array_free(ctx->observed, TRUE);
+	g_free(ctx);
+	fake_unref(core);
+}
+
+const char* mpv_error_string(int error) {
+	switch (error) {
+	case MPV_ERROR_SUCCESS:
+		return "success";
+	case MPV_ERROR_INVALID_PARAMETER:
+		return "invalid parameter";
+	case MPV_ERROR_PROPERTY_FORMAT:
+		return "unsupported format for accessing property";
+	case MPV_ERROR_PROPERTY_UNAVAILABLE:
+		return "property unavailable";
+	case MPV_ERROR_COMMAND:
+		return "error running command";
+	case MPV_ERROR_LOADING_FAILED:
+		return "loading failed";
+	case MPV_ERROR_NOT_IMPLEMENTED:
+		return "operation not implemented";
+	default:
+		return "unknown error";
+	}
+}
+
+void mpv_free(void* data) {
+	g_free(data);
+}
+
+void mpv_free_node_contents(mpv_node* node) {
+	if (node->format == MPV_FORMAT_STRING) {
+		g_free(node->u.string);
+	} else if (node->format == MPV_FORMAT_NODE_ARRAY || node->format == MPV_FORMAT_NODE_MAP) {
+		mpv_node_list* list = node->u.list;
+		for (int i = 0; i < list->num; i++) {
+			mpv_free_node_contents(&list->values[i]);
+			if (list->keys) {
+				g_free(list->keys[i]);
+			}
+		}
+		g_free(list->values);
+		g_free(list->keys);
+		g_free(list);
+	}
+	node->format = MPV_FORMAT_NONE;
+}
+
+/* properties and commands */
+
+int mpv_set_property_string(mpv_handle* ctx, const char* name, const char* data) {
+	FakeCore* core = ctx->core;
+	FAKE_MPV_COUNT(propertyWrites);
+	g_mutex_lock(&core->mutex);
+	if (g_str_equal(name, "pause")) {
+		fake_set_pause(core, g_str_equal(data, "yes"));
+	} else {
+		g_hash_table_replace(core->properties, g_strdup(name), g_strdup(data));
+		fake_change(core, name);
+	}
+	fake_unlock(core);
+	return MPV_ERROR_SUCCESS;
+}
+
+int mpv_set_option_string(mpv_handle* ctx, const char* name, const char* data) {
+	return mpv_set_property_string(ctx, name, data);
+}
+
+int mpv_set_property(mpv_handle* ctx, const char* name, mpv_format format, void* data) {
+	gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+	const gchar* value;
+	switch (format) {
+	case MPV_FORMAT_STRING:
+		value = *(char**)data;
+		break;
+	case MPV_FORMAT_FLAG:
+		value = *(int*)data ? "yes" : "no";
+		break;
+	case MPV_FORMAT_INT64:
+		g_snprintf(buffer, sizeof(buffer), "%" G_GINT64_FORMAT, *(int64_t*)data);
+		value = buffer;
+		break;
+	case MPV_FORMAT_DOUBLE:
+		value = g_ascii_dtostr(buffer, sizeof(buffer), *(double*)data);
+		break;
+	case MPV_FORMAT_NODE:
+		if (((mpv_node*)data)->format == MPV_FORMAT_STRING) {
+			value = ((mpv_node*)data)->u.string;
+			break;
+		}
+		return MPV_ERROR_PROPERTY_FORMAT;
+	default:
+		return MPV_ERROR_PROPERTY_FORMAT;
+	}
+	return mpv_set_property_string(ctx, name, value);
+}
+
+int mpv_get_property(mpv_handle* ctx, const char* name, mpv_format format, void* data) {
+	FakeCore* core = ctx->core;
+	FAKE_MPV_COUNT(propertyReads);
+	g_mutex_lock(&core->mutex);
+	int result;
+	if (g_str_equal(name, "demuxer-cache-state") && format == MPV_FORMAT_NODE) {
+		if (core->loaded) {
+			fake_cache_state(core, data);
+			result = MPV_ERROR_SUCCESS;
+		} else {
+			result = MPV_ERROR_PROPERTY_UNAVAILABLE;
+		}
+	} else {
+		gchar* value = fake_get_string(core, name);
+		result = fake_convert(value, format, data);
+		g_free(value);
+	}
+	g_mutex_unlock(&core->mutex);
+	return result;
+}
+
+char* mpv_get_property_string(mpv_handle* ctx, const char* name) {
+	FakeCore* core = ctx->core;
+	FAKE_MPV_COUNT(propertyReads);
+	g_mutex_lock(&core->mutex);
+	gchar* value = fake_get_string(core, name);
+	g_mutex_unlock(&core->mutex);
+	return value;
+}
+
+int mpv_observe_property(mpv_handle* mpv, uint64_t reply_userdata, const char* name, mpv_format format) {
+	FakeCore* core = mpv->core;
+	g_mutex_lock(&core->mutex);
+	FakeObserved observed = { g_strdup(name), format, reply_userdata };
+	g_array_append_val(mpv->observed, observed);
+	// mpv reports the current value of a newly observed property
+	gchar* value = fake_get_string(core, name);
+	fake_post_change(mpv, &g_array_index(mpv->observed, FakeObserved, mpv->observed->len - 1), value);
+	g_free(value);
+	fake_unlock(core);
+	return MPV_ERROR_SUCCESS;
+}
+
+int mpv_command(mpv_handle* ctx, const char** args) {
+	FakeCore* core = ctx->core;
+	g_mutex_lock(&core->mutex);
+	const int result = fake_command(core, args);
+	fake_unlock(core);
+	return result;
+}
+
+int mpv_command_node(mpv_handle* ctx, mpv_node* args, mpv_node* result) {
+	const gchar* argv[8] = { NULL };
+	if (args->format == MPV_FORMAT_NODE_ARRAY) {
+		for (int i = 0; i < args->u.list->num && i < (int)G_N_ELEMENTS(argv) - 1; i++) {
+			if (args->u.list->values[i].format == MPV_FORMAT_STRING) {
+				argv[i] = args->u.list->values[i].u.string;
+			}
+		}
+	} else if (args->format == MPV_FORMAT_NODE_MAP) {
+		// named arguments, only the ones of loadfile and seek are used by the plugin
+		const gchar* names[] = { "name", "url", "target", "flags" };
+		for (int i = 0; i < args->u.list->num; i++) {
+			for (int j = 0; j < (int)G_N_ELEMENTS(names); j++) {
+				if (g_str_equal(args->u.list->keys[i], names[j]) && args->u.list->values[i].format == MPV_FORMAT_STRING) {
+					argv[j < 2 ? j : j - 1] = args->u.list->values[i].u.string;
+				}
+			}
+		}
+	} else {
+		return MPV_ERROR_INVALID_PARAMETER;
+	}
+	if (result) {
+		result->format = MPV_FORMAT_NONE;
+	}
+	return mpv_command(ctx, argv);
+}
+
+/* events */
+
+mpv_event* mpv_wait_event(mpv_handle* ctx, double timeout) {
+	FakeCore* core = ctx->core;
+	g_mutex_lock(&core->mutex);
+	g_clear_pointer(&ctx->current, fake_event_free);
+	if (timeout != 0) {
+		const gint64 deadline = timeout > 0 ? g_get_monotonic_time() + (gint64)(timeout * G_USEC_PER_SEC) : G_MAXINT64;
+		while (g_queue_is_empty(&ctx->events) && !ctx->wakeup) {
+			if (deadline == G_MAXINT64) {
+				g_cond_wait(&core->cond, &core->mutex);
+			} else if (!g_cond_wait_until(&core->cond, &core->mutex, deadline)) {
+				break;
+			}
+		}
+	}
+	ctx->wakeup = false;
+	ctx->current = g_queue_pop_head(&ctx->events);
+	const bool client = ctx != core->main;
+	g_mutex_unlock(&core->mutex);
+	if (ctx->current) {
+		if (client) {
+			FAKE_MPV_COUNT(clientEvents);
+		} else {
+			FAKE_MPV_COUNT(events);
+		}
+		return &ctx->current->event;
+	}
+	ctx->none.event_id = MPV_EVENT_NONE;
+	return &ctx->none;
+}
+
+void mpv_wakeup(mpv_handle* ctx) {
+	FakeCore* core = ctx->core;
+	g_mutex_lock(&core->mutex);
+	ctx->wakeup = true;
+	g_cond_broadcast(&core->cond);
+	g_mutex_unlock(&core->mutex);
+	if (ctx->wakeupCallback) {
+		ctx->wakeupCallback(ctx->wakeupData);
+	}
+}
+
+void mpv_set_wakeup_callback(mpv_handle* ctx, void (*cb)(void* d), void* d) {
+	FakeCore* core = ctx->core;
+	g_mutex_lock(&core->mutex);
+	ctx->wakeupCallback = cb;
+	ctx->wakeupData = d;
+	g_mutex_unlock(&core->mutex);
+}
+
+int mpv_request_log_messages(mpv_handle* ctx, const char* min_level) {
+	const int level = fake_log_level(min_level);
+	if (level < 0) {
+		return MPV_ERROR_INVALID_PARAMETER;
+	}
+	FakeCore* core = ctx->core;
+	g_mutex_lock(&core->mutex);
+	ctx->logLevel = level;
+	g_cond_broadcast(&core->cond);
+	g_mutex_unlock(&core->mutex);
+	return MPV_ERROR_SUCCESS;
+}
+
+/* render API */
+
+int mpv_render_context_create(mpv_render_context** res, mpv_handle* mpv, mpv_render_param* params) {
+	const char* api = NULL;
+	for (mpv_render_param* param = params; param->type != MPV_RENDER_PARAM_INVALID; param++) {
+		if (param->type == MPV_RENDER_PARAM_API_TYPE) {
+			api = param->data;
+		}
+	}
+	if (!api || (!g_str_equal(api, MPV_RENDER_API_TYPE_OPENGL) && !g_str_equal(api, MPV_RENDER_API_TYPE_SW))) {
+		return MPV_ERROR_NOT_IMPLEMENTED;
+	}
+	FakeCore* core = mpv->core;
+	g_mutex_lock(&core->mutex);
+	if (core->render) {
+		g_mutex_unlock(&core->mutex);
+		return MPV_ERROR_UNSUPPORTED;
+	}
+	mpv_render_context* ctx = g_new0(mpv_render_context, 1);
+	ctx->core = core;
+	ctx->frame = core->loaded;
+	core->render = ctx;
+	g_atomic_int_inc(&core->refs);
+	g_mutex_unlock(&core->mutex);
+	*res = ctx;
+	return MPV_ERROR_SUCCESS;
+}
+
+void mpv_render_context_set_update_callback(mpv_render_context* ctx, mpv_render_update_fn callback, void* callback_ctx) {
+	g_mutex_lock(&ctx->core->mutex);
+	ctx->callback = callback;
+	ctx->callbackData = callback_ctx;
+	g_mutex_unlock(&ctx->core->mutex);
+}
+
+uint64_t mpv_render_context_update(mpv_render_context* ctx) {
+	g_mutex_lock(&ctx->core->mutex);
+	const uint64_t flags = ctx->frame ? MPV_RENDER_UPDATE_FRAME : 0;
+	g_mutex_unlock(&ctx->core->mutex);
+	return flags;
+}
+
+int mpv_render_context_render(mpv_render_context* ctx, mpv_render_param* params) {
+	FAKE_MPV_COUNT(renders);
+	g_mutex_lock(&ctx->core->mutex);
+	ctx->frame = false;
+	g_mutex_unlock(&ctx->core->mutex);
+	return MPV_ERROR_SUCCESS;
+}
+
+void mpv_render_context_free(mpv_render_context* ctx) {
+	FakeCore* core = ctx->core;
+	g_mutex_lock(&core->mutex);
+	core->render = NULL;
+	g_mutex_unlock(&core->mutex);
+	g_free(ctx);
+	fake_unref(core);
+}
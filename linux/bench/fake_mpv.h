@@ -0,0 +1,43 @@
+#pragma once
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+G_BEGIN_DECLS
+
+// Timeline of a media played by fake_mpv.c, rates are per second and 0 disables the event.
+typedef struct {
+	double frameRate; // frames rendered while playing
+	double timeRate; // time-pos changes while playing
+	double cacheRate; // demuxer-cache-time changes while loaded
+	double reconfigRate; // video reconfigs while loaded
+	double restartRate; // playback restarts while loaded
+	double logRate; // log messages to clients requesting them
+	gint64 openDelay; // microseconds from loadfile to file loaded
+	gint64 seekDelay; // microseconds from seek to playback restart
+	int width;
+	int height;
+	double duration; // seconds
+	double traceSpeed; // replay speed of a loaded trace
+} FakeMpvScript;
+
+typedef struct {
+	uint64_t events; // events returned by mpv_wait_event of main handles
+	uint64_t clientEvents; // events returned to handles of mpv_create_client
+	uint64_t dropped; // events dropped because the queue of a handle is full
+	uint64_t commands;
+	uint64_t propertyReads;
+	uint64_t propertyWrites;
+	uint64_t renders;
+} FakeMpvCounters;
+
+// the script and trace apply to handles created afterwards
+void fake_mpv_get_script(FakeMpvScript* script);
+void fake_mpv_set_script(const FakeMpvScript* script);
+
+// replays a trace written by bench_record on each loadfile instead of the scripted timeline, NULL to stop replaying
+bool fake_mpv_load_trace(const gchar* path);
+
+void fake_mpv_get_counters(FakeMpvCounters* counters);
+
+G_END_DECLS
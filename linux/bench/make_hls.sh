@@ -0,0 +1,25 @@
+#!/bin/sh
+# Creates a multi-variant HLS fixture from a video for bench_open and bench_abr.
+#
+# usage: make_hls.sh [VIDEO] [DIR]
+#
+# DIR/index.m3u8 is the master playlist of three renditions at 240p, 480p and 720p, with 2 second segments under
+# DIR/0, DIR/1 and DIR/2. Audio is left out, so the variants only differ by video bitrate.
+set -e
+
+input="${1:-$(dirname "$0")/../../example/videos/01.mp4}"
+out="${2:-build/bench/hls}"
+
+mkdir -p "$out"
+ffmpeg -hide_banner -loglevel error -y -i "$input" \
+  -filter_complex "[0:v]split=3[a][b][c];[a]scale=-2:240[v0];[b]scale=-2:480[v1];[c]scale=-2:720[v2]" \
+  -map "[v0]" -map "[v1]" -map "[v2]" -an \
+  -c:v libx264 -preset veryfast -g 48 -keyint_min 48 -sc_threshold 0 \
+  -b:v:0 400k -maxrate:v:0 440k -bufsize:v:0 800k \
+  -b:v:1 1200k -maxrate:v:1 1320k -bufsize:v:1 2400k \
+  -b:v:2 3000k -maxrate:v:2 3300k -bufsize:v:2 6000k \
+  -f hls -hls_time 2 -hls_playlist_type vod \
+  -hls_segment_filename "$out/%v/seg%03d.ts" \
+  -master_pl_name index.m3u8 -var_stream_map "v:0 v:1 v:2" \
+  "$out/%v/index.m3u8"
+echo "$out/index.m3u8"
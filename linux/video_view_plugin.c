@@ -1,4 +1,5 @@
 #include "include/video_view/video_view_plugin.h"
+#include "video_view_proxy.h"
 #include <ctype.h>
 #include <locale.h>
 #include <gdk/gdkx.h>
@@ -9,6 +10,68 @@
 #include <mpv/render.h>
 #include <mpv/render_gl.h>
 #include <unicode/uloc.h>
+#include <dlfcn.h>
+#ifdef VIDEO_VIEW_PLUGIN_SDT
+#include <sys/sdt.h>
+#define VIDEO_VIEW_PLUGIN_PROBE(name, span, id) DTRACE_PROBE2(video_view, name, span, id)
+#else
+#define VIDEO_VIEW_PLUGIN_PROBE(name, span, id)
+#endif
+
+// libmpv and ICU are loaded by video_view_plugin_load_libraries on the first create, mpv functions are called through
+// pointers of the same names
+#define VIDEO_VIEW_PLUGIN_MPV_SYMBOLS(X) \
+	X(mpv_command) \
+	X(mpv_command_node) \
+	X(mpv_create) \
+	X(mpv_create_client) \
+	X(mpv_destroy) \
+	X(mpv_error_string) \
+	X(mpv_free) \
+	X(mpv_free_node_contents) \
+	X(mpv_get_property) \
+	X(mpv_get_property_string) \
+	X(mpv_initialize) \
+	X(mpv_observe_property) \
+	X(mpv_render_context_create) \
+	X(mpv_render_context_free) \
+	X(mpv_render_context_render) \
+	X(mpv_render_context_set_update_callback) \
+	X(mpv_render_context_update) \
+	X(mpv_request_log_messages) \
+	X(mpv_set_option_string) \
+	X(mpv_set_property) \
+	X(mpv_set_property_string) \
+	X(mpv_set_wakeup_callback) \
+	X(mpv_wait_event) \
+	X(mpv_wakeup)
+#define VIDEO_VIEW_PLUGIN_DECLARE_SYMBOL(name) static __typeof__(name)* name##_p;
+VIDEO_VIEW_PLUGIN_MPV_SYMBOLS(VIDEO_VIEW_PLUGIN_DECLARE_SYMBOL)
+static __typeof__(uloc_toLanguageTag)* ulocToLanguageTag;
+#define mpv_command mpv_command_p
+#define mpv_command_node mpv_command_node_p
+#define mpv_create mpv_create_p
+#define mpv_create_client mpv_create_client_p
+#define mpv_destroy mpv_destroy_p
+#define mpv_error_string mpv_error_string_p
+#define mpv_free mpv_free_p
+#define mpv_free_node_contents mpv_free_node_contents_p
+#define mpv_get_property mpv_get_property_p
+#define mpv_get_property_string mpv_get_property_string_p
+#define mpv_initialize mpv_initialize_p
+#define mpv_observe_property mpv_observe_property_p
+#define mpv_render_context_create mpv_render_context_create_p
+#define mpv_render_context_free mpv_render_context_free_p
+#define mpv_render_context_render mpv_render_context_render_p
+#define mpv_render_context_set_update_callback mpv_render_context_set_update_callback_p
+#define mpv_render_context_update mpv_render_context_update_p
+#define mpv_request_log_messages mpv_request_log_messages_p
+#define mpv_set_option_string mpv_set_option_string_p
+#define mpv_set_property mpv_set_property_p
+#define mpv_set_property_string mpv_set_property_string_p
+#define mpv_set_wakeup_callback mpv_set_wakeup_callback_p
+#define mpv_wait_event mpv_wait_event_p
+#define mpv_wakeup mpv_wakeup_p
 
 /* player definitions */
 
@@ -18,19 +81,32 @@ typedef struct {
 	mpv_handle* mpv;
 	mpv_render_context* mpvRenderContext;
 	FlEventChannel* eventChannel;
+	mpv_handle* logMpv; // client handle receiving log messages in logThread, NULL if logging is never enabled
+	GThread* logThread;
+	gchar* logBuffer; // ring of the last VIDEO_VIEW_PLUGIN_LOG_SIZE messages, written by logThread only
+	gint* logSequences; // odd while the message in the same slot is being written
+	gint logHead; // messages written into the ring
+	gint logStop;
 	gchar* source;
 	int64_t id;
 	int64_t position;
 	int64_t bufferPosition;
 	double speed;
 	double volume;
+	double maxFrameRate; // set by user, 0 for no cap
 	gchar* preferredAudioLanguage;
 	gchar* preferredSubtitleLanguage;
 	GArray* videoTracks; // video tracks with id, width, height, bitrate
 	GArray* audioTracks; // audio tracks with id, language
 	GArray* subtitleTracks; // subtitle tracks with id, language
+	GArray* stepFrames; // rendered frames around the current position while stepping, used by populate only
+	GArray* stepStale; // textures of released frames not deleted yet since the isolated context wasn't current
+	FlValue* probed; // mediaInfo sent from the probe cache before the demuxer is done
+	gchar** fastStartDefaults; // buffering options restored when fast start ramps back
+	gchar** qualityDefaults; // options restored when the quality governor steps back up
 	GLuint texture; // Flutter texture (created in Flutter context)
 	GLuint mpvTexture; // mpv render target (created in isolated context)
+	GLuint stepFbo; // used to render and copy cached frames (created in isolated context)
 	EGLDisplay eglDisplay;
 	EGLContext eglContext;
 	EGLImageKHR eglImage;
@@ -39,19 +115,104 @@ typedef struct {
 	size_t swStride;
 	GLsizei width;
 	GLsizei height;
+	double liveSpeed; // speed applied by latency controller
+	int64_t targetLatency; // target latency to the live edge in ms, 0 to disable the controller
+	guint liveTimer;
+	guint statsTimer;
+	int64_t timeShift; // time-shift window of live streams in ms, 0 to disable
+	int64_t timeShiftBytes; // current size of demuxer back buffer for time-shift
+	double scanSpeed; // 0 if not scanning
+	double scanPosition; // position in seconds the scan has reached
+	gint64 scanTime; // monotonic time of the last scan tick
+	guint scanTimer;
+	double stepDuration; // duration of a single frame in seconds
+	double stepWant; // pts to show when a backward fill is done
+	double stepFillEnd; // pts where a backward fill stops
+	double stepShown; // pts of the cached frame on screen if mpv is past it, -1 otherwise, guarded by mutex
+	gint64 stepStart; // monotonic time of the pending step request, 0 if idle, guarded by mutex
+	gint64 stepLatency; // latency of the last step in microseconds, guarded by mutex
+	gint64 stepLatencySum; // latency of all steps and their count, guarded by mutex
+	uint32_t stepLatencyCount;
+	int32_t stepIndex; // cached frame on screen, -1 for the live frame
+	int32_t stepQueued; // frames requested and not yet run by populate, guarded by mutex
+	uint32_t stepCount; // frames in stepFrames as of the last populate, guarded by mutex
+	uint32_t stepRemaining; // frame-step commands not yet captured
+	uint32_t stepCapacity; // max cached frames for current video size
+	int64_t cacheBytes; // bytes held by demuxer cache, in memory or on disk
+	int64_t cacheDiskBytes; // bytes written to the cache file
+	gint64 cacheUsed; // monotonic time of the last open, play or seek, used by LRU eviction
+	gint64 openStart; // monotonic time of the last open, 0 if its timing is already sent
+	uint32_t probeSerial; // incremented by open, so probe cache lookups of previous sources are dropped
+	gint64 openFileLoaded; // microseconds from openStart to each phase of the open, 0 if not reached yet
+	gint64 openRestart;
+	gint64 openLoaded;
+	gint64 openPopulate;
+	gint64 openFrame;
+	uint32_t* populateTimes; // rings of the last populate, render and upload durations in microseconds
+	uint32_t* renderTimes;
+	uint32_t* uploadTimes;
+	uint32_t populateCount; // durations recorded into each ring
+	uint32_t renderCount;
+	uint32_t uploadCount;
+	uint32_t cacheHits; // seeks served from demuxer cache
+	uint32_t cacheMisses; // seeks that need to fetch again
+	uint32_t cacheReported; // hits and misses at the last cache report
+	guint dropSource; // drops the pending frame of a hidden player on the main thread, guarded by mutex
+	guint qualityTimer;
+	uint32_t qualityFrames; // populateCount at the last check of the quality governor
+	int64_t qualityDrops; // decoder and output drops at the last check
+	guint abrTimer;
+	double abrFast; // bandwidth estimates in bits per second, moving averages reacting fast and slowly
+	double abrSlow;
+	bool abrReading; // whether the demuxer was reading at the last check of the ABR controller
+	gint64 abrSwitched; // monotonic time the ABR controller last switched the rendition
 	guint inhibit_cookie;
 	uint32_t maxBitRate; // 0 for auto
+	uint32_t abrBitRate; // max rendition bit rate chosen by the ABR controller, 0 for no cap
 	uint16_t maxWidth;
 	uint16_t maxHeight;
 	uint16_t overrideAudio; // 0 for auto otherwise track id
 	uint16_t overrideSubtitle;
+	uint16_t qualityHeight; // max rendition height chosen by the quality governor, 0 for no cap
 	uint8_t state; // 0: idle, 1: opening, 2: paused, 3: playing
+	uint8_t visibility; // set by user, 0: visible, 1: hidden, 2: audio only
+	uint8_t priority; // 0: foreground, 1: background, 2: thumbnail
+	uint8_t appliedVisibility; // visibility in effect, which is hidden at least while the window is minimized
+	uint8_t quality; // step of the quality governor, 0: full, 1: fast scaling, 2: half render size, 3: lower rendition, 4: decoder shortcuts
+	uint8_t qualityCalm; // checks in a row with headroom
+	uint8_t qualitySettle; // checks ignored after a step
 	bool looping;
 	bool streaming;
 	bool networking;
 	bool seeking;
 	bool keepScreenOn;
 	bool eglRendering;
+	bool timeShifted; // live playback is kept behind the edge by user
+	bool liveJumping; // a catch-up seek of the latency controller is in flight until playback restarts
+	bool scanSeeking; // waiting for a keyframe seek of the scan
+	bool speedScanning; // the scan is started by a playback speed over VIDEO_VIEW_PLUGIN_SCAN_SPEED
+	bool stepFilling; // decoding frames before the current position into cache
+	bool stepSeeking; // waiting for the seek of a backward fill, guarded by mutex
+	bool stepCapture; // next populate should capture a new frame into cache
+	bool stepRunning; // populate is running a step, set until stepEnd
+	bool stepClearPending; // populate releases the cached frames, guarded by mutex
+	bool cacheSpilled; // the current file is opened with cache on disk
+	bool cacheEvicted; // demuxer cache is dropped by eviction until the player is used again
+	bool playPending; // play is requested after mediaInfo is sent from the probe cache
+	bool fastStart; // open with the fast-start profile
+	bool fastStarting; // buffering is lowered until playback begins
+	bool videoDropped; // vid=no is set because the player is audio only
+	bool skipMutedAudio; // deselect audio while the volume is 0
+	bool audioDropped; // aid=no is set because the player is muted
+	bool trimPending; // populate frees the software buffer to meet the memory budget, guarded by mutex
+	bool cacheShrunk; // demuxer-max-bytes is lowered by the memory budget until the next open
+	bool adaptiveQuality; // the quality governor is enabled
+	bool framesSkipped; // vd-lavc-skipframe=nonref is set for the frame-rate cap
+	bool skipReload; // the decoder is reloaded to apply vd-lavc-skipframe once the player is hidden
+	bool frameRateFiltered; // the fps filter of the frame-rate cap is in the filter chain
+	bool dropping; // the main thread is dropping a frame with or freeing the render context, guarded by mutex
+	bool rendering; // populate is using the render context, guarded by mutex
+	bool adaptiveBitRate; // the ABR controller is enabled
 } VideoViewPlugin;
 #define VIDEO_VIEW_PLUGIN(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), video_view_plugin_get_type(), VideoViewPlugin))
 typedef struct {
@@ -59,6 +220,40 @@ typedef struct {
 } VideoViewPluginClass;
 G_DEFINE_TYPE(VideoViewPlugin, video_view_plugin, fl_texture_gl_get_type())
 
+#define VIDEO_VIEW_PLUGIN_LIVE_INTERVAL 500 // ms between latency reports of live streams
+#define VIDEO_VIEW_PLUGIN_LIVE_JUMP 4000 // ms behind the target latency to jump forward instead of speeding up
+#define VIDEO_VIEW_PLUGIN_LIVE_MAX_RATE 0.1 // max speed change applied by latency controller
+#define VIDEO_VIEW_PLUGIN_TIME_SHIFT_MAX_BYTES (256 << 20) // hard cap of demuxer back buffer for time-shift
+#define VIDEO_VIEW_PLUGIN_TIME_SHIFT_RATE (1 << 20) // bytes per second assumed before the stream rate is known
+#define VIDEO_VIEW_PLUGIN_SCAN_INTERVAL 80 // ms between keyframe seeks while scanning
+#define VIDEO_VIEW_PLUGIN_SCAN_SPEED 4 // playback speeds over this scan keyframes instead
+#define VIDEO_VIEW_PLUGIN_STEP_CACHE_SIZE 32
+#define VIDEO_VIEW_PLUGIN_STEP_CACHE_BYTES (128 << 20)
+#define VIDEO_VIEW_PLUGIN_CACHE_INTERVAL 1000 // ms between cache reports and disk budget checks
+#define VIDEO_VIEW_PLUGIN_MEMORY_MIN_CACHE (16 << 20) // forward cache left to playing players over the memory budget
+#define VIDEO_VIEW_PLUGIN_QUALITY_INTERVAL 1000 // ms between checks of the quality governor
+#define VIDEO_VIEW_PLUGIN_QUALITY_DROPS 3 // frames dropped in a check to step down
+#define VIDEO_VIEW_PLUGIN_QUALITY_LOAD 0.8 // share of the frame time populate may take before stepping down
+#define VIDEO_VIEW_PLUGIN_QUALITY_HEADROOM 0.4 // share of the frame time populate takes at most in a check with headroom
+#define VIDEO_VIEW_PLUGIN_QUALITY_CALM 5 // checks in a row with headroom to step up
+#define VIDEO_VIEW_PLUGIN_QUALITY_SETTLE 2 // checks ignored after a step, while the decoder or renderer warms up
+#define VIDEO_VIEW_PLUGIN_ABR_INTERVAL 500 // ms between checks of the ABR controller
+#define VIDEO_VIEW_PLUGIN_ABR_SAFETY 0.8 // share of the estimated bandwidth a rendition may take
+#define VIDEO_VIEW_PLUGIN_ABR_UP_BUFFER 10 // seconds buffered ahead to switch up, the switch refetches from the position
+#define VIDEO_VIEW_PLUGIN_ABR_DOWN_BUFFER 4 // seconds buffered ahead below which a rendition over the estimate is switched down
+#define VIDEO_VIEW_PLUGIN_ABR_HOLD 8000000 // microseconds after a switch before switching up
+#define VIDEO_VIEW_PLUGIN_ABR_MAX_JUMP 2 // max ratio of a bandwidth sample to the slow estimate
+#define VIDEO_VIEW_PLUGIN_PROBE_CACHE_SIZE 1024 // max media kept in the probe cache
+#define VIDEO_VIEW_PLUGIN_PROBE_PRUNE_INTERVAL 64 // entries saved between checks of the probe cache size
+#define VIDEO_VIEW_PLUGIN_PROBE_TTL 3600 // seconds an entry is trusted if the validator of its source is unknown
+#define VIDEO_VIEW_PLUGIN_STATS_SAMPLES 128 // durations kept for render timing stats
+#define VIDEO_VIEW_PLUGIN_LOG_SIZE 256 // messages kept in the log ring of each player
+#define VIDEO_VIEW_PLUGIN_LOG_ERROR_TAIL 20 // last messages of the log ring sent with error events
+#define VIDEO_VIEW_PLUGIN_LOG_LENGTH 256 // max bytes of each message, longer ones are truncated
+#define VIDEO_VIEW_PLUGIN_LOG_RATE 200 // max messages per second, the rest are counted as dropped
+#define VIDEO_VIEW_PLUGIN_TRACE_BUFFER (64 << 10) // trace events kept in memory before writing to the file
+#define VIDEO_VIEW_PLUGIN_FAST_START_PROBE "demuxer-lavf-probesize=524288,demuxer-lavf-analyzeduration=0.5" // probing limits of the fast-start profile
+
 /* plugin definitions */
 
 #ifndef eglCreateImageKHR
@@ -74,6 +269,20 @@ typedef void (*GlEglImageTargetTexture2DProc)(GLenum target, GLeglImageOES image
 static GlEglImageTargetTexture2DProc glEGLImageTargetTexture2DOES = NULL;
 #endif
 
+typedef struct {
+	uint32_t threadWeight; // share of the decoder thread budget
+	uint32_t proxyWeight; // bandwidth weight while opening or playing
+	double frameRate; // max rendered frames per second, 0 for no cap
+	const gchar* readahead; // demuxer-readahead-secs, NULL for the default
+	const gchar* cacheSecs; // cache-secs, NULL for the default
+} VideoViewPluginPriority;
+
+typedef struct {
+	const gchar* name;
+	uint8_t step; // first step of the quality governor with the value
+	const gchar* value;
+} VideoViewPluginQualityOption;
+
 static GTree* players; // all write operations on the tree are done in the main thread
 static GMutex mutex;   // so we just need to lock the mutex when reading in other threads
 static FlBinaryMessenger* messenger;
@@ -81,7 +290,122 @@ static FlTextureRegistrar* textureRegistrar;
 static FlMethodCodec* codec;
 static FlMethodChannel* methodChannel;
 static FlView* pluginView;
+static GtkWidget* pluginWindow; // toplevel of pluginView, NULL if it's not in a window when registered
+static gulong windowStateHandler;
+static bool windowHidden; // pluginWindow is minimized or withdrawn
 static GdkGLContext* platformGlContext;
+static int8_t librariesLoaded; // 0: not tried yet, 1: loaded, -1: failed
+static const gchar* const mpvLibraries[] = { "libmpv.so.2", "libmpv.so.1", NULL };
+static const gchar* const icuLibraries[] = { "libicuuc.so." G_STRINGIFY(U_ICU_VERSION_MAJOR_NUM), "libicuuc.so", NULL };
+static const gchar* const fastStartOptions[] = { // buffering options lowered by the fast-start profile, and their values
+	"demuxer-readahead-secs", "0.5",
+	"cache-secs", "2",
+	"cache-pause-wait", "0.2",
+	NULL
+};
+static const VideoViewPluginQualityOption qualityOptions[] = { // options changed by steps of the quality governor
+	{ "scale", 1, "bilinear" },
+	{ "cscale", 1, "bilinear" },
+	{ "dscale", 1, "bilinear" },
+	{ "deband", 1, "no" },
+	{ "vd-lavc-skiploopfilter", 4, "all" },
+	{ "vd-lavc-fast", 4, "yes" },
+};
+static const gchar* const audioExtensions[] = { // sources opened without a render context until video is found in them
+	"aac", "ac3", "aif", "aiff", "ape", "flac", "m4a", "mka", "mp2", "mp3", "oga", "ogg", "opus", "wav", "wma", NULL
+};
+static const VideoViewPluginPriority priorities[] = {
+	{ 8, VIDEO_VIEW_PLUGIN_PROXY_WEIGHT_ACTIVE, 0, NULL, NULL }, // foreground
+	{ 2, 2, 30, "1", "10" }, // background
+	{ 1, VIDEO_VIEW_PLUGIN_PROXY_WEIGHT_IDLE, 15, "0.5", "2" }, // thumbnail
+};
+static uint32_t decoderThreads; // decoder threads shared by all opened players, split by priority
+static int64_t cacheMemoryBudget; // demuxer cache limit of each player in memory, 0 for mpv defaults
+static int64_t cacheDiskBudget; // disk budget shared by all players, 0 to keep demuxer cache in memory
+static int64_t memoryBudget; // memory budget shared by all players, 0 for no budget
+static gchar* cacheDir;
+static gchar* shaderCacheDir; // created with the first EGL render context, kept until the process exits
+static guint cacheTimer;
+static GThreadPool* probePool; // reads and writes the probe cache off the main thread, one entry at a time
+static gint traceEnabled; // read by hot paths without locking, so tracing costs nothing when disabled
+static GMutex traceMutex; // guards the trace states below, spans may end in the raster thread
+static GOutputStream* traceStream;
+static GString* traceBuffer;
+static uint64_t traceEvents;
+static gint traceThreads;
+static GPrivate traceThread; // small thread ids for trace viewers
+
+/* trace implementation */
+
+// returns the start time of a span if tracing to file is enabled, otherwise 0
+static int64_t video_view_plugin_trace_begin(const gchar* span, const int64_t id) {
+	VIDEO_VIEW_PLUGIN_PROBE(begin, span, id);
+	return g_atomic_int_get(&traceEnabled) ? g_get_monotonic_time() : 0;
+}
+
+static void video_view_plugin_trace_flush() {
+	if (traceBuffer->len > 0) {
+		g_output_stream_write_all(traceStream, traceBuffer->str, traceBuffer->len, NULL, NULL, NULL);
+		g_string_truncate(traceBuffer, 0);
+	}
+}
+
+// detail must not contain characters escaped by JSON
+static void video_view_plugin_trace_end(const gchar* span, const int64_t id, const int64_t start, const gchar* detail) {
+	VIDEO_VIEW_PLUGIN_PROBE(end, span, id);
+	if (!start) {
+		return;
+	}
+	const gint64 end = g_get_monotonic_time();
+	gint thread = GPOINTER_TO_INT(g_private_get(&traceThread));
+	if (!thread) {
+		thread = g_atomic_int_add(&traceThreads, 1) + 1;
+		g_private_set(&traceThread, GINT_TO_POINTER(thread));
+	}
+	g_mutex_lock(&traceMutex);
+	if (traceStream) {
+		g_string_append_printf(traceBuffer, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%ld,\"dur\":%ld,\"args\":{\"id\":%ld", traceEvents++ ? ",\n" : "", span, thread, start, end - start, id);
+		if (detail) {
+			g_string_append_printf(traceBuffer, ",\"detail\":\"%s\"", detail);
+		}
+		g_string_append(traceBuffer, "}}");
+		if (traceBuffer->len >= VIDEO_VIEW_PLUGIN_TRACE_BUFFER) {
+			video_view_plugin_trace_flush();
+		}
+	}
+	g_mutex_unlock(&traceMutex);
+}
+
+static void video_view_plugin_stop_trace() {
+	g_atomic_int_set(&traceEnabled, 0);
+	g_mutex_lock(&traceMutex);
+	if (traceStream) {
+		g_string_append(traceBuffer, "\n]}\n");
+		video_view_plugin_trace_flush();
+		g_output_stream_close(traceStream, NULL, NULL);
+		g_object_unref(traceStream);
+		traceStream = NULL;
+		g_string_free(traceBuffer, TRUE);
+		traceBuffer = NULL;
+	}
+	g_mutex_unlock(&traceMutex);
+}
+
+// writes spans of the render and event paths to a Chrome trace file, which can be opened by Perfetto
+static void video_view_plugin_start_trace(const gchar* path) {
+	video_view_plugin_stop_trace();
+	GFile* file = g_file_new_for_path(path);
+	GFileOutputStream* stream = g_file_replace(file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, NULL);
+	g_object_unref(file);
+	if (stream) {
+		g_mutex_lock(&traceMutex);
+		traceStream = G_OUTPUT_STREAM(stream);
+		traceBuffer = g_string_new("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+		traceEvents = 0;
+		g_mutex_unlock(&traceMutex);
+		g_atomic_int_set(&traceEnabled, 1);
+	}
+}
 
 /* player implementation */
 
@@ -99,6 +423,7 @@ typedef struct {
 	uint32_t bitrate;
 } VideoViewPluginVideoTrack;
 
+
 typedef struct {
 	uint16_t id;
 	uint8_t size;
@@ -106,7 +431,33 @@ typedef struct {
 	gchar* language[3];
 } VideoViewPluginTrack;
 
+typedef struct {
+	double pts;
+	GLuint texture; // used by EGL rendering
+	guint8* buffer; // used by software rendering
+} VideoViewPluginStepFrame;
+
+typedef struct {
+	int64_t id;
+	int64_t position;
+	gint64 latency;
+} VideoViewPluginStepEnd;
+
+typedef struct {
+	int64_t cache; // demuxer cache in memory
+	int64_t buffer; // software render buffer
+	int64_t texture; // Flutter texture on the EGL path, which shares its storage with the mpv render target
+	int64_t stepCache; // cached frames of frame stepping
+	int64_t tracks;
+} VideoViewPluginMemory;
+
 static void video_view_plugin_texture_update_callback(void* id);
+static void video_view_plugin_set_scan_speed(VideoViewPlugin* self, double speed);
+static void video_view_plugin_speed_scan(VideoViewPlugin* self);
+static void video_view_plugin_play(VideoViewPlugin* self);
+static void video_view_plugin_init_render_context(VideoViewPlugin* self);
+static gboolean video_view_plugin_free_render_context(void* id);
+static void video_view_plugin_apply_quality(VideoViewPlugin* self, const uint8_t quality);
 
 static void video_view_plugin_track_free(void* item) {
 	const VideoViewPluginTrack* track = item;
@@ -190,7 +541,7 @@ static uint16_t video_view_plugin_find_lang(const GArray* lang1, const GArray* l
 }
 
 static void video_view_plugin_set_default_track(const VideoViewPlugin* self, const uint8_t type) {
-	if (self->state > 1) {
+	if ((self->state > 1 || self->probed) && (type || !self->audioDropped)) {
 		gchar* language = type ? self->preferredSubtitleLanguage : self->preferredAudioLanguage;
 		if (!language) {
 			language = setlocale(LC_CTYPE, NULL);
@@ -232,12 +583,20 @@ static void video_view_plugin_set_default_track(const VideoViewPlugin* self, con
 	}
 }
 
+// the caps set by user, and the height cap of the quality governor
+static bool video_view_plugin_fits_caps(const VideoViewPlugin* self, const VideoViewPluginVideoTrack* track) {
+	return (self->maxWidth == 0 || track->width <= self->maxWidth) && (self->maxHeight == 0 || track->height <= self->maxHeight) && (self->qualityHeight == 0 || track->height <= self->qualityHeight) && (self->maxBitRate == 0 || track->bitrate <= self->maxBitRate);
+}
+
 static void video_view_plugin_set_max_size(VideoViewPlugin* self) {
-	int64_t oldId;
+	if (self->videoDropped) {
+		return;
+	}
+	int64_t oldId = 0;
 	double pos;
 	mpv_get_property(self->mpv, "vid", MPV_FORMAT_INT64, &oldId);
 	mpv_get_property(self->mpv, "time-pos/full", MPV_FORMAT_DOUBLE, &pos);
-	if (self->maxWidth > 0 || self->maxHeight > 0) {
+	if (self->maxWidth > 0 || self->maxHeight > 0 || self->maxBitRate > 0 || self->qualityHeight > 0 || self->abrBitRate > 0) {
 		uint16_t id = 0;
 		uint16_t maxWidth = 0;
 		uint16_t maxHeight = 0;
@@ -248,7 +607,7 @@ static void video_view_plugin_set_max_size(VideoViewPlugin* self) {
 		uint16_t minId = 0;
 		for (uint32_t i = 0; i < self->videoTracks->len; i++) {
 			const VideoViewPluginVideoTrack* data = &g_array_index(self->videoTracks, VideoViewPluginVideoTrack, i);
-			if ((self->maxWidth == 0 || data->width <= self->maxWidth) && (self->maxHeight == 0 || data->height <= self->maxHeight) && (self->maxBitRate == 0 || data->bitrate <= self->maxBitRate) && data->width > maxWidth && data->height > maxHeight && data->bitrate > maxBitrate) {
+			if (video_view_plugin_fits_caps(self, data) && (self->abrBitRate == 0 || data->bitrate <= self->abrBitRate) && data->width > maxWidth && data->height > maxHeight && data->bitrate > maxBitrate) {
 				id = data->id;
 				maxWidth = data->width;
 				maxHeight = data->height;
@@ -272,13 +631,125 @@ static void video_view_plugin_set_max_size(VideoViewPlugin* self) {
 	} else {
 		mpv_set_property_string(self->mpv, "vid", "auto");
 	}
-	int64_t newId;
+	int64_t newId = 0;
 	mpv_get_property(self->mpv, "vid", MPV_FORMAT_INT64, &newId);
-	if (newId != oldId) {
+	// mpv refreshes the video itself when it's selected from none
+	if (oldId && newId != oldId) {
 		video_view_plugin_just_seek_to(self, (int64_t)(pos * 1000), true, false);
 	}
 }
 
+static const VideoViewPluginVideoTrack* video_view_plugin_get_video_track(const VideoViewPlugin* self) {
+	int64_t vid = 0;
+	mpv_get_property(self->mpv, "vid", MPV_FORMAT_INT64, &vid);
+	for (uint32_t i = 0; i < self->videoTracks->len; i++) {
+		const VideoViewPluginVideoTrack* data = &g_array_index(self->videoTracks, VideoViewPluginVideoTrack, i);
+		if (data->id == vid) {
+			return data;
+		}
+	}
+	return NULL;
+}
+
+// the highest bit rate within the caps that fits the budget, the lowest one if none fits, 0 if no rendition has a bit rate
+static uint32_t video_view_plugin_abr_choose(const VideoViewPlugin* self, const double budget) {
+	uint32_t best = 0;
+	uint32_t lowest = UINT32_MAX;
+	for (uint32_t i = 0; i < self->videoTracks->len; i++) {
+		const VideoViewPluginVideoTrack* data = &g_array_index(self->videoTracks, VideoViewPluginVideoTrack, i);
+		if (data->bitrate > 0 && video_view_plugin_fits_caps(self, data)) {
+			lowest = MIN(lowest, data->bitrate);
+			if (data->bitrate <= budget && data->bitrate > best) {
+				best = data->bitrate;
+			}
+		}
+	}
+	return best ? best : lowest == UINT32_MAX ? 0 : lowest;
+}
+
+// audio only players never decode video, others select the track by max size
+static void video_view_plugin_select_video(VideoViewPlugin* self) {
+	// the render context is created once video is found or needed again
+	if (!self->mpvRenderContext && self->appliedVisibility < 2 && self->videoTracks->len > 0) {
+		video_view_plugin_init_render_context(self);
+	}
+	self->videoDropped = self->appliedVisibility > 1 || !self->mpvRenderContext;
+	if (self->videoDropped) {
+		mpv_set_property_string(self->mpv, "vid", "no");
+	} else {
+		video_view_plugin_set_max_size(self);
+	}
+}
+
+// muted players deselect audio if they show video, which keeps the clock, so no audio decoder or output is kept for them
+static void video_view_plugin_update_audio(VideoViewPlugin* self) {
+	const bool drop = self->skipMutedAudio && self->volume == 0 && self->state > 0 && self->mpvRenderContext && self->appliedVisibility < 2 && self->videoTracks->len > 0;
+	if (drop != self->audioDropped) {
+		self->audioDropped = drop;
+		if (drop) {
+			mpv_set_property_string(self->mpv, "aid", "no");
+		} else if (self->overrideAudio) {
+			// mpv refreshes the demuxer of the selected track, so playback isn't interrupted
+			gchar* p = g_strdup_printf("%d", self->overrideAudio);
+			mpv_set_property_string(self->mpv, "aid", p);
+			g_free(p);
+		} else {
+			video_view_plugin_set_default_track(self, 0);
+		}
+	}
+}
+
+// decoder options apply when the decoder is initialized, mpv refreshes the video when it's selected from none
+static void video_view_plugin_reload_decoder(VideoViewPlugin* self) {
+	int64_t vid = 0;
+	mpv_get_property(self->mpv, "vid", MPV_FORMAT_INT64, &vid);
+	if (vid > 0) {
+		gchar* p = g_strdup_printf("%ld", vid);
+		mpv_set_property_string(self->mpv, "vid", "no");
+		mpv_set_property_string(self->mpv, "vid", p);
+		g_free(p);
+	}
+}
+
+// the lower frame-rate cap of the priority class and the user, 0 for no cap
+static double video_view_plugin_get_frame_rate(const VideoViewPlugin* self) {
+	const double frameRate = priorities[self->priority].frameRate;
+	return frameRate > 0 && (self->maxFrameRate <= 0 || frameRate < self->maxFrameRate) ? frameRate : self->maxFrameRate;
+}
+
+// the fps filter of mpv drops frames over the cap before they reach the VO, so every frame mpv presents is rendered and
+// it never waits for frames held back, and non-reference frames are not decoded if the cap is at most half the frame
+// rate of the media, so the frames left are still spread evenly enough
+static void video_view_plugin_apply_frame_rate(VideoViewPlugin* self) {
+	const double frameRate = video_view_plugin_get_frame_rate(self);
+	if (self->state > 1 && !self->videoDropped) {
+		double fps = 0;
+		mpv_get_property(self->mpv, "container-fps", MPV_FORMAT_DOUBLE, &fps);
+		// the filter only passes frames through, so hardware decoded frames are not copied back
+		if (frameRate > 0 && (fps <= 0 || fps > frameRate)) {
+			gchar* filter = g_strdup_printf("@video_view_fps:fps=fps=%g", frameRate);
+			const gchar* cmd[] = { "vf", "add", filter, NULL };
+			self->frameRateFiltered = mpv_command(self->mpv, cmd) == MPV_ERROR_SUCCESS;
+			g_free(filter);
+		} else if (self->frameRateFiltered) {
+			const gchar* cmd[] = { "vf", "remove", "@video_view_fps", NULL };
+			mpv_command(self->mpv, cmd);
+			self->frameRateFiltered = false;
+		}
+		const bool skip = frameRate > 0 && fps >= frameRate * 2;
+		if (skip != self->framesSkipped) {
+			self->framesSkipped = skip;
+			mpv_set_property_string(self->mpv, "vd-lavc-skipframe", skip ? "nonref" : "default");
+			// reloading the decoder of a player on screen shows a hitch, so it waits until the player is hidden unless
+			// nothing is shown yet, the option applies to the next decoder anyway
+			self->skipReload = self->appliedVisibility == 0 && self->openFrame;
+			if (!self->skipReload) {
+				video_view_plugin_reload_decoder(self);
+			}
+		}
+	}
+}
+
 static void video_view_plugin_send_time(const VideoViewPlugin* self, int64_t pos) {
 	g_autoptr(FlValue) evt = fl_value_new_map();
 	fl_value_set_string_take(evt, "event", fl_value_new_string("position"));
@@ -294,6 +765,99 @@ static void video_view_plugin_send_buffer(const VideoViewPlugin* self, int64_t p
 	fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
 }
 
+static void video_view_plugin_set_back_bytes(VideoViewPlugin* self, const int64_t bytes) {
+	self->timeShiftBytes = bytes;
+	if (bytes > 0) {
+		gchar* p = g_strdup_printf("%ld", bytes);
+		mpv_set_property_string(self->mpv, "demuxer-max-back-bytes", p);
+		mpv_set_property_string(self->mpv, "demuxer-seekable-cache", "yes");
+		g_free(p);
+	} else {
+		gchar* p = cacheDiskBudget > 0 ? g_strdup_printf("%ld", cacheDiskBudget / 4) : cacheMemoryBudget > 0 ? g_strdup_printf("%ld", cacheMemoryBudget / 4) : g_strdup("50MiB");
+		mpv_set_property_string(self->mpv, "demuxer-max-back-bytes", p);
+		mpv_set_property_string(self->mpv, "demuxer-seekable-cache", "auto");
+		g_free(p);
+	}
+}
+
+static const mpv_node* video_view_plugin_node_get(const mpv_node* node, const gchar* key, const mpv_format format) {
+	if (node && node->format == MPV_FORMAT_NODE_MAP) {
+		for (int i = 0; i < node->u.list->num; i++) {
+			if (g_str_equal(node->u.list->keys[i], key)) {
+				return node->u.list->values[i].format == format ? &node->u.list->values[i] : NULL;
+			}
+		}
+	}
+	return NULL;
+}
+
+// returns the start of the seekable window of a live stream in ms
+static int64_t video_view_plugin_time_shift_start(VideoViewPlugin* self) {
+	int64_t start = self->bufferPosition;
+	mpv_node state;
+	if (!mpv_get_property(self->mpv, "demuxer-cache-state", MPV_FORMAT_NODE, &state)) {
+		const mpv_node* ranges = video_view_plugin_node_get(&state, "seekable-ranges", MPV_FORMAT_NODE_ARRAY);
+		if (ranges && ranges->u.list->num > 0) {
+			// the last range is the one being appended by the live edge
+			const mpv_node* value = video_view_plugin_node_get(&ranges->u.list->values[ranges->u.list->num - 1], "start", MPV_FORMAT_DOUBLE);
+			if (value) {
+				start = (int64_t)(value->u.double_ * 1000);
+			}
+		}
+		mpv_free_node_contents(&state);
+	}
+	return CLAMP(start, self->bufferPosition - self->timeShift, self->bufferPosition);
+}
+
+// apply the plugin cache policy to the next file, mpv reads these options when a file is loaded
+static void video_view_plugin_apply_cache_policy(VideoViewPlugin* self) {
+	// split the limit as mpv defaults do, 3/4 ahead and 1/4 behind the playback position
+	const int64_t bytes = cacheDiskBudget > 0 ? cacheDiskBudget : cacheMemoryBudget;
+	gchar* forward = bytes > 0 ? g_strdup_printf("%ld", bytes - bytes / 4) : g_strdup("150MiB");
+	mpv_set_property_string(self->mpv, "demuxer-max-bytes", forward);
+	g_free(forward);
+	self->cacheShrunk = false;
+	video_view_plugin_set_back_bytes(self, 0);
+	self->cacheSpilled = cacheDiskBudget > 0;
+	mpv_set_property_string(self->mpv, "cache-on-disk", self->cacheSpilled ? "yes" : "no");
+	if (self->cacheSpilled) {
+		mpv_set_property_string(self->mpv, "demuxer-cache-dir", cacheDir);
+	}
+}
+
+static bool video_view_plugin_is_cached(VideoViewPlugin* self, const int64_t position) {
+	bool cached = false;
+	mpv_node state;
+	if (!mpv_get_property(self->mpv, "demuxer-cache-state", MPV_FORMAT_NODE, &state)) {
+		const mpv_node* ranges = video_view_plugin_node_get(&state, "seekable-ranges", MPV_FORMAT_NODE_ARRAY);
+		for (int i = 0; ranges && !cached && i < ranges->u.list->num; i++) {
+			const mpv_node* start = video_view_plugin_node_get(&ranges->u.list->values[i], "start", MPV_FORMAT_DOUBLE);
+			const mpv_node* end = video_view_plugin_node_get(&ranges->u.list->values[i], "end", MPV_FORMAT_DOUBLE);
+			cached = start && end && position >= start->u.double_ * 1000 && position <= end->u.double_ * 1000;
+		}
+		mpv_free_node_contents(&state);
+	}
+	return cached;
+}
+
+static void video_view_plugin_use_cache(VideoViewPlugin* self) {
+	self->cacheUsed = g_get_monotonic_time();
+	if (self->cacheEvicted) {
+		self->cacheEvicted = false;
+		if (self->timeShiftBytes <= 0) {
+			video_view_plugin_set_back_bytes(self, 0);
+		}
+	}
+}
+
+// drops the demuxer cache of a player not playing until it's used again
+static void video_view_plugin_evict_cache(VideoViewPlugin* self) {
+	self->cacheEvicted = true;
+	mpv_set_property_string(self->mpv, "demuxer-max-back-bytes", "0");
+	const gchar* cmd[] = { "drop-buffers", NULL };
+	mpv_command(self->mpv, cmd);
+}
+
 static void video_view_plugin_set_inhibit(VideoViewPlugin* self, const bool enable) {
 	if ((enable && self->inhibit_cookie != 0) || (!enable && self->inhibit_cookie == 0)) {
 		return;
@@ -311,147 +875,735 @@ static void video_view_plugin_set_inhibit(VideoViewPlugin* self, const bool enab
 	}
 }
 
-static void video_view_plugin_loaded(VideoViewPlugin* self) {
-	int64_t count;
-	mpv_get_property(self->mpv, "track-list/count", MPV_FORMAT_INT64, &count);
-	FlValue* audioTracks = fl_value_new_map();
-	FlValue* subtitleTracks = fl_value_new_map();
-	for (uint32_t i = 0; i < count; i++) {
-		gchar* str;
-		gchar p[33];
-		sprintf(p, "track-list/%d/type", i);
-		mpv_get_property(self->mpv, p, MPV_FORMAT_STRING, &str);
-		const uint8_t type = g_str_equal(str, "video") ? 2 : g_str_equal(str, "audio") ? 0 : 1;
-		mpv_free(str);
-		int64_t trackId;
-		sprintf(p, "track-list/%d/id", i);
-		mpv_get_property(self->mpv, p, MPV_FORMAT_INT64, &trackId);
-		int64_t size;
-		if (type == 2) {
-			VideoViewPluginVideoTrack data = { .id = (uint16_t)trackId };
-			sprintf(p, "track-list/%d/demux-w", i);
-			if (!mpv_get_property(self->mpv, p, MPV_FORMAT_INT64, &size)) {
-				data.width = (uint16_t)size;
-			}
-			sprintf(p, "track-list/%d/demux-h", i);
-			if (!mpv_get_property(self->mpv, p, MPV_FORMAT_INT64, &size)) {
-				data.height = (uint16_t)size;
-			}
-			sprintf(p, "track-list/%d/hls-bitrate", i);
-			if (!mpv_get_property(self->mpv, p, MPV_FORMAT_INT64, &size)) {
-				data.bitrate = (uint32_t)size;
-			}
-			g_array_append_val(self->videoTracks, data);
+static gchar* video_view_plugin_probe_path(const gchar* source) {
+	gchar* hash = g_compute_checksum_for_string(G_CHECKSUM_SHA256, source, -1);
+	gchar* name = g_strdup_printf("%s.ini", hash);
+	gchar* path = g_build_filename(g_get_user_cache_dir(), "video_view", "probe", name, NULL);
+	g_free(name);
+	g_free(hash);
+	return path;
+}
+
+// returns size and mtime of local files, or the ETag or Last-Modified seen by the proxy for network sources, NULL if unknown
+static gchar* video_view_plugin_probe_validator(const gchar* source) {
+	gchar* validator = NULL;
+	if (g_str_has_prefix(source, "http://") || g_str_has_prefix(source, "https://")) {
+		validator = video_view_plugin_proxy_validator(source);
+	} else {
+		gchar* path;
+		if (g_str_has_prefix(source, "asset://")) {
+			g_autoptr(FlDartProject) project = fl_dart_project_new();
+			path = g_strdup_printf("%s%s", fl_dart_project_get_assets_path(project), &source[7]);
+		} else if (g_str_has_prefix(source, "file://")) {
+			path = g_filename_from_uri(source, NULL, NULL);
 		} else {
-			VideoViewPluginTrack t = { .id = (uint16_t)trackId };
-			sprintf(p, "track-list/%d/default", i);
-			if (!mpv_get_property(self->mpv, p, MPV_FORMAT_STRING, &str)) {
-				t.def = g_str_equal(str, "yes");
-				mpv_free(str);
-			}
-			FlValue* info = fl_value_new_map();
-			sprintf(p, "track-list/%d/lang", i);
-			if (!mpv_get_property(self->mpv, p, MPV_FORMAT_STRING, &str)) {
-				UErrorCode status = U_ZERO_ERROR;
-				char langtag[ULOC_FULLNAME_CAPACITY];
-				uloc_toLanguageTag(str, langtag, ULOC_FULLNAME_CAPACITY, FALSE, &status); // we don't want ISO 639-2 codes
-				const gchar* lang = U_FAILURE(status) ? str : langtag;
-				fl_value_set_string_take(info, "language", fl_value_new_string(lang));
-				t.size = video_view_plugin_split_lang(lang, t.language);
-				mpv_free(str);
-			}
-			g_array_append_val(type ? self->subtitleTracks : self->audioTracks, t);
-			sprintf(p, "track-list/%d/title", i);
-			if (!mpv_get_property(self->mpv, p, MPV_FORMAT_STRING, &str)) {
-				fl_value_set_string_take(info, "label", fl_value_new_string(str));
-				mpv_free(str);
-			}
-			sprintf(p, "track-list/%d/codec", i);
-			if (!mpv_get_property(self->mpv, p, MPV_FORMAT_STRING, &str)) {
-				fl_value_set_string_take(info, "format", fl_value_new_string(str));
-				mpv_free(str);
-			} else {
-				sprintf(p, "track-list/%d/format-name", i);
-				if (!mpv_get_property(self->mpv, p, MPV_FORMAT_STRING, &str)) {
-					fl_value_set_string_take(info, "format", fl_value_new_string(str));
-					mpv_free(str);
-				}
-			}
-			if (type) {
-				sprintf(p, "%d.%ld", type, trackId);
-				fl_value_set_string_take(subtitleTracks, p, info);
-			} else {
-				sprintf(p, "track-list/%d/demux-bitrate", i);
-				if (!mpv_get_property(self->mpv, p, MPV_FORMAT_INT64, &size)) {
-					fl_value_set_string_take(info, "bitrate", fl_value_new_int(size));
-				}
-				sprintf(p, "track-list/%d/demux-channel-count", i);
-				if (!mpv_get_property(self->mpv, p, MPV_FORMAT_INT64, &size)) {
-					fl_value_set_string_take(info, "channels", fl_value_new_int(size));
-				}
-				sprintf(p, "track-list/%d/demux-samplerate", i);
-				if (!mpv_get_property(self->mpv, p, MPV_FORMAT_INT64, &size)) {
-					fl_value_set_string_take(info, "sampleRate", fl_value_new_int(size));
-				}
-				sprintf(p, "%d.%ld", type, trackId);
-				fl_value_set_string_take(audioTracks, p, info);
-			}
+			path = g_strdup(source);
 		}
+		GStatBuf st;
+		if (path && !g_stat(path, &st)) {
+			validator = g_strdup_printf("%ld:%ld", (long)st.st_size, (long)st.st_mtime);
+		}
+		g_free(path);
 	}
-	double duration;
-	if (self->streaming) {
-		duration = 0;
-	} else {
-		mpv_get_property(self->mpv, "duration/full", MPV_FORMAT_DOUBLE, &duration);
+	return validator;
+}
+
+typedef struct {
+	gchar* path;
+	gint64 time;
+} VideoViewPluginProbeEntry;
+
+typedef struct {
+	int64_t id;
+	uint32_t serial; // probeSerial of the open which looks the entry up
+	gchar* source;
+	GKeyFile* file; // the entry to save, or the valid entry found
+} VideoViewPluginProbeTask;
+
+static gint video_view_plugin_compare_probe_entry(const void* a, const void* b) {
+	const gint64 ta = ((const VideoViewPluginProbeEntry*)a)->time;
+	const gint64 tb = ((const VideoViewPluginProbeEntry*)b)->time;
+	return ta < tb ? -1 : ta > tb;
+}
+
+// removes the oldest entries if there are too many, entries are only stat once they are over the limit
+static void video_view_plugin_probe_prune(const gchar* dir) {
+	GDir* handle = g_dir_open(dir, 0, NULL);
+	if (!handle) {
+		return;
 	}
-	self->state = 2;
-	video_view_plugin_set_max_size(self);
-	video_view_plugin_set_default_track(self, 0);
-	video_view_plugin_set_default_track(self, 1);
-	g_autoptr(FlValue) evt = fl_value_new_map();
-	fl_value_set_string_take(evt, "event", fl_value_new_string("mediaInfo"));
-	fl_value_set_string_take(evt, "source", fl_value_new_string(self->source));
-	fl_value_set_string_take(evt, "duration", fl_value_new_int((int64_t)(duration * 1000)));
-	fl_value_set_string_take(evt, "audioTracks", audioTracks);
-	fl_value_set_string_take(evt, "subtitleTracks", subtitleTracks);
-	fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
-	if (!self->streaming) {
-		int64_t pos = video_view_plugin_get_pos(self);
-		if (pos > 0) {
-			video_view_plugin_send_time(self, pos);
+	GPtrArray* names = g_ptr_array_new_with_free_func(g_free);
+	const gchar* name;
+	while ((name = g_dir_read_name(handle))) {
+		g_ptr_array_add(names, g_strdup(name));
+	}
+	g_dir_close(handle);
+	if (names->len > VIDEO_VIEW_PLUGIN_PROBE_CACHE_SIZE) {
+		GArray* entries = g_array_sized_new(FALSE, FALSE, sizeof(VideoViewPluginProbeEntry), names->len);
+		for (guint i = 0; i < names->len; i++) {
+			VideoViewPluginProbeEntry entry = { g_build_filename(dir, g_ptr_array_index(names, i), NULL), G_MININT64 };
+			GStatBuf st;
+			if (!g_stat(entry.path, &st)) {
+				entry.time = st.st_mtime;
+			}
+			g_array_append_val(entries, entry);
 		}
-		if (self->networking && self->bufferPosition > pos) {
-			video_view_plugin_send_buffer(self, pos);
+		g_array_sort(entries, video_view_plugin_compare_probe_entry);
+		for (guint i = 0; i < entries->len; i++) {
+			VideoViewPluginProbeEntry* entry = &g_array_index(entries, VideoViewPluginProbeEntry, i);
+			if (i < entries->len - VIDEO_VIEW_PLUGIN_PROBE_CACHE_SIZE) {
+				g_remove(entry->path);
+			}
+			g_free(entry->path);
 		}
+		g_array_free(entries, TRUE);
 	}
+	g_ptr_array_free(names, TRUE);
 }
 
-static void* video_view_plugin_init_mpv_gl(void* addrCtx, const char* name) {
-	return eglGetProcAddress(name);
+static void video_view_plugin_probe_save_tracks(GKeyFile* file, const gchar* type, FlValue* tracks, const GArray* array) {
+	for (size_t i = 0; i < fl_value_get_length(tracks); i++) {
+		FlValue* info = fl_value_get_map_value(tracks, i);
+		const VideoViewPluginTrack* track = &g_array_index(array, VideoViewPluginTrack, i);
+		gchar* group = g_strdup_printf("%s %s", type, fl_value_get_string(fl_value_get_map_key(tracks, i)));
+		g_key_file_set_int64(file, group, "id", track->id);
+		g_key_file_set_boolean(file, group, "default", track->def);
+		for (size_t j = 0; j < fl_value_get_length(info); j++) {
+			const gchar* key = fl_value_get_string(fl_value_get_map_key(info, j));
+			FlValue* value = fl_value_get_map_value(info, j);
+			if (fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+				g_key_file_set_int64(file, group, key, fl_value_get_int(value));
+			} else {
+				g_key_file_set_string(file, group, key, fl_value_get_string(value));
+			}
+		}
+		g_free(group);
+	}
 }
 
-static void video_view_plugin_capture_egl_state(VideoViewPluginEglState* state) {
-	state->display = eglGetCurrentDisplay();
-	state->context = eglGetCurrentContext();
-	state->draw = eglGetCurrentSurface(EGL_DRAW);
-	state->read = eglGetCurrentSurface(EGL_READ);
+static void video_view_plugin_probe_task_free(void* data) {
+	VideoViewPluginProbeTask* task = data;
+	if (task->file) {
+		g_key_file_free(task->file);
+	}
+	g_free(task->source);
+	g_free(task);
 }
 
-static void video_view_plugin_restore_egl_state(const VideoViewPluginEglState* state, EGLDisplay fallbackDisplay) {
-	if (state->display != EGL_NO_DISPLAY) {
-		eglMakeCurrent(state->display, state->draw, state->read, state->context);
-	} else if (fallbackDisplay != EGL_NO_DISPLAY) {
-		eglMakeCurrent(fallbackDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+// returns the probe cache of the source if it's still valid
+static GKeyFile* video_view_plugin_probe_open(const gchar* source) {
+	gchar* path = video_view_plugin_probe_path(source);
+	GKeyFile* file = g_key_file_new();
+	const bool loaded = g_key_file_load_from_file(file, path, G_KEY_FILE_NONE, NULL);
+	g_free(path);
+	gchar* cached = loaded ? g_key_file_get_string(file, "media", "validator", NULL) : NULL;
+	gchar* validator = cached ? video_view_plugin_probe_validator(source) : NULL;
+	const gint64 age = g_get_real_time() / G_USEC_PER_SEC - (loaded ? g_key_file_get_int64(file, "media", "time", NULL) : 0);
+	// network sources the proxy hasn't seen yet are trusted for a while, and corrected after loading if they have changed
+	if (!cached || (validator ? !g_str_equal(validator, cached) : age > VIDEO_VIEW_PLUGIN_PROBE_TTL)) {
+		g_key_file_free(file);
+		file = NULL;
 	}
+	g_free(validator);
+	g_free(cached);
+	return file;
 }
 
-static bool video_view_plugin_make_platform_gl_current() {
-	if (!pluginView) {
-		return false;
+static void video_view_plugin_probe_write(VideoViewPluginProbeTask* task) {
+	static uint32_t saved = 0;
+	const bool networking = g_str_has_prefix(task->source, "http://") || g_str_has_prefix(task->source, "https://");
+	gchar* validator = video_view_plugin_probe_validator(task->source);
+	if (validator || networking) {
+		g_key_file_set_string(task->file, "media", "validator", validator ? validator : "");
+		g_key_file_set_int64(task->file, "media", "time", g_get_real_time() / G_USEC_PER_SEC);
+		gchar* path = video_view_plugin_probe_path(task->source);
+		gchar* dir = g_path_get_dirname(path);
+		g_mkdir_with_parents(dir, 0700);
+		g_key_file_save_to_file(task->file, path, NULL);
+		if (++saved % VIDEO_VIEW_PLUGIN_PROBE_PRUNE_INTERVAL == 0) {
+			video_view_plugin_probe_prune(dir);
+		}
+		g_free(dir);
+		g_free(path);
 	}
-	GtkWidget* widget = GTK_WIDGET(pluginView);
-	if (!gtk_widget_get_realized(widget)) {
-		return false;
+	g_free(validator);
+}
+
+// guesses from the extension whether the source has no video, so it's opened without a render context, video found
+// after loading is still played, and the render context of other sources without video is freed once they are loaded
+static bool video_view_plugin_is_audio_source(const gchar* source) {
+	bool audio = false;
+	const bool networking = g_str_has_prefix(source, "http://") || g_str_has_prefix(source, "https://");
+	const size_t length = networking ? strcspn(source, "?#") : strlen(source);
+	const gchar* dot = g_strrstr_len(source, length, ".");
+	if (dot && !memchr(dot, '/', source + length - dot)) {
+		gchar* extension = g_ascii_strdown(dot + 1, source + length - dot - 1);
+		audio = g_strv_contains(audioExtensions, extension);
+		g_free(extension);
+	}
+	return audio;
+}
+
+// sends mediaInfo from the cache before the demuxer is done, the result of the demuxer is reconciled in video_view_plugin_loaded
+static void video_view_plugin_probe_load(VideoViewPlugin* self, GKeyFile* file) {
+	if (file) {
+		FlValue* audioTracks = fl_value_new_map();
+		FlValue* subtitleTracks = fl_value_new_map();
+		gchar** groups = g_key_file_get_groups(file, NULL);
+		for (int i = 0; groups[i]; i++) {
+			const gchar* group = groups[i];
+			if (g_str_has_prefix(group, "video ")) {
+				VideoViewPluginVideoTrack track = { .id = (uint16_t)g_ascii_strtoll(&group[6], NULL, 10) };
+				track.width = (uint16_t)g_key_file_get_int64(file, group, "width", NULL);
+				track.height = (uint16_t)g_key_file_get_int64(file, group, "height", NULL);
+				track.bitrate = (uint32_t)g_key_file_get_int64(file, group, "bitrate", NULL);
+				g_array_append_val(self->videoTracks, track);
+			} else if (g_str_has_prefix(group, "audio ") || g_str_has_prefix(group, "subtitle ")) {
+				const uint8_t type = group[0] == 's' ? 1 : 0;
+				VideoViewPluginTrack track = { .id = (uint16_t)g_key_file_get_int64(file, group, "id", NULL) };
+				track.def = g_key_file_get_boolean(file, group, "default", NULL);
+				FlValue* info = fl_value_new_map();
+				gchar** keys = g_key_file_get_keys(file, group, NULL, NULL);
+				for (int j = 0; keys && keys[j]; j++) {
+					const gchar* key = keys[j];
+					if (g_str_equal(key, "bitrate") || g_str_equal(key, "channels") || g_str_equal(key, "sampleRate")) {
+						fl_value_set_string_take(info, key, fl_value_new_int(g_key_file_get_int64(file, group, key, NULL)));
+					} else if (!g_str_equal(key, "id") && !g_str_equal(key, "default")) {
+						gchar* value = g_key_file_get_string(file, group, key, NULL);
+						fl_value_set_string_take(info, key, fl_value_new_string(value));
+						if (g_str_equal(key, "language")) {
+							track.size = video_view_plugin_split_lang(value, track.language);
+						}
+						g_free(value);
+					}
+				}
+				g_strfreev(keys);
+				g_array_append_val(type ? self->subtitleTracks : self->audioTracks, track);
+				fl_value_set_string_take(type ? subtitleTracks : audioTracks, strchr(group, ' ') + 1, info);
+			}
+		}
+		g_strfreev(groups);
+		const double duration = g_key_file_get_double(file, "media", "duration", NULL);
+		self->probed = fl_value_new_map();
+		fl_value_set_string_take(self->probed, "duration", fl_value_new_int((int64_t)(duration * 1000)));
+		fl_value_set_string_take(self->probed, "audioTracks", audioTracks);
+		fl_value_set_string_take(self->probed, "subtitleTracks", subtitleTracks);
+		// select tracks now, so the demuxer opens the preferred ones
+		video_view_plugin_set_default_track(self, 0);
+		video_view_plugin_set_default_track(self, 1);
+		g_autoptr(FlValue) evt = fl_value_new_map();
+		fl_value_set_string_take(evt, "event", fl_value_new_string("mediaInfo"));
+		fl_value_set_string_take(evt, "source", fl_value_new_string(self->source));
+		fl_value_set_string_take(evt, "duration", fl_value_new_int((int64_t)(duration * 1000)));
+		fl_value_set_string_take(evt, "audioTracks", fl_value_ref(audioTracks));
+		fl_value_set_string_take(evt, "subtitleTracks", fl_value_ref(subtitleTracks));
+		fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+		g_key_file_free(file);
+	}
+}
+
+static gboolean video_view_plugin_probe_found(void* data) {
+	VideoViewPluginProbeTask* task = data;
+	VideoViewPlugin* self = g_tree_lookup(players, (void*)task->id);
+	// the demuxer may be done already, or another source is opened
+	if (self && self->state == 1 && self->probeSerial == task->serial && !self->probed) {
+		video_view_plugin_probe_load(self, task->file);
+		task->file = NULL;
+		// tracks are known from the probe cache
+		video_view_plugin_update_audio(self);
+	}
+	return G_SOURCE_REMOVE;
+}
+
+static void video_view_plugin_probe_run(void* data, void* user_data) {
+	VideoViewPluginProbeTask* task = data;
+	if (task->file) {
+		video_view_plugin_probe_write(task);
+		video_view_plugin_probe_task_free(task);
+	} else {
+		task->file = video_view_plugin_probe_open(task->source);
+		if (task->file) {
+			g_idle_add_full(G_PRIORITY_DEFAULT, video_view_plugin_probe_found, task, video_view_plugin_probe_task_free);
+		} else {
+			video_view_plugin_probe_task_free(task);
+		}
+	}
+}
+
+// saves file if it's set, otherwise looks the entry of the source up and loads it if it's found while the player is still opening
+static void video_view_plugin_probe_push(const VideoViewPlugin* self, GKeyFile* file) {
+	if (!probePool) {
+		probePool = g_thread_pool_new(video_view_plugin_probe_run, NULL, 1, FALSE, NULL);
+	}
+	VideoViewPluginProbeTask* task = g_new(VideoViewPluginProbeTask, 1);
+	task->id = self->id;
+	task->serial = self->probeSerial;
+	task->source = g_strdup(self->source);
+	task->file = file;
+	g_thread_pool_push(probePool, task, NULL);
+}
+
+// caches what the demuxer found, so the next open of the same source doesn't need to wait for it
+static void video_view_plugin_probe_save(const VideoViewPlugin* self, const double duration, FlValue* audioTracks, FlValue* subtitleTracks) {
+	GKeyFile* file = g_key_file_new();
+	g_key_file_set_double(file, "media", "duration", duration);
+	for (guint i = 0; i < self->videoTracks->len; i++) {
+		const VideoViewPluginVideoTrack* track = &g_array_index(self->videoTracks, VideoViewPluginVideoTrack, i);
+		gchar* group = g_strdup_printf("video %d", track->id);
+		g_key_file_set_int64(file, group, "width", track->width);
+		g_key_file_set_int64(file, group, "height", track->height);
+		g_key_file_set_int64(file, group, "bitrate", track->bitrate);
+		g_free(group);
+	}
+	video_view_plugin_probe_save_tracks(file, "audio", audioTracks, self->audioTracks);
+	video_view_plugin_probe_save_tracks(file, "subtitle", subtitleTracks, self->subtitleTracks);
+	// the validator is checked and the file written by the probe thread
+	video_view_plugin_probe_push(self, file);
+}
+
+static void video_view_plugin_log_write(VideoViewPlugin* self, const gchar* prefix, const gchar* level, const gchar* text) {
+	const guint head = (guint)g_atomic_int_get(&self->logHead);
+	const guint slot = head % VIDEO_VIEW_PLUGIN_LOG_SIZE;
+	gchar* message = &self->logBuffer[slot * VIDEO_VIEW_PLUGIN_LOG_LENGTH];
+	g_atomic_int_inc(&self->logSequences[slot]);
+	g_snprintf(message, VIDEO_VIEW_PLUGIN_LOG_LENGTH, "[%s] %s: %s", prefix, level, text);
+	g_strchomp(message);
+	g_atomic_int_inc(&self->logSequences[slot]);
+	g_atomic_int_inc(&self->logHead);
+}
+
+// drains log messages out of the main thread, so verbose logging doesn't flood the main loop
+static void* video_view_plugin_log_run(void* data) {
+	VideoViewPlugin* self = data;
+	gint64 windowStart = 0;
+	uint32_t count = 0;
+	uint32_t dropped = 0;
+	while (!g_atomic_int_get(&self->logStop)) {
+		const mpv_event* event = mpv_wait_event(self->logMpv, -1);
+		if (event->event_id == MPV_EVENT_SHUTDOWN) {
+			break;
+		} else if (event->event_id == MPV_EVENT_LOG_MESSAGE) {
+			const mpv_event_log_message* detail = (mpv_event_log_message*)event->data;
+			const gint64 now = g_get_monotonic_time();
+			if (now - windowStart >= G_USEC_PER_SEC) {
+				if (dropped > 0) {
+					gchar* text = g_strdup_printf("%u messages dropped", dropped);
+					video_view_plugin_log_write(self, "video_view", "warn", text);
+					g_free(text);
+				}
+				windowStart = now;
+				count = dropped = 0;
+			}
+			if (count < VIDEO_VIEW_PLUGIN_LOG_RATE) {
+				count++;
+				video_view_plugin_log_write(self, detail->prefix, detail->level, detail->text);
+			} else {
+				dropped++;
+			}
+		}
+	}
+	return NULL;
+}
+
+// level is one of mpv log levels: no, fatal, error, warn, info, v, debug, trace
+static void video_view_plugin_set_log_level(VideoViewPlugin* self, const gchar* level) {
+	if (!self->logMpv) {
+		if (g_str_equal(level, "no")) {
+			return;
+		}
+		self->logMpv = mpv_create_client(self->mpv, "video_view_log");
+		if (!self->logMpv) {
+			return;
+		}
+		self->logBuffer = g_malloc0(VIDEO_VIEW_PLUGIN_LOG_SIZE * VIDEO_VIEW_PLUGIN_LOG_LENGTH);
+		self->logSequences = g_new0(gint, VIDEO_VIEW_PLUGIN_LOG_SIZE);
+		self->logThread = g_thread_new("video_view_log", video_view_plugin_log_run, self);
+	}
+	mpv_request_log_messages(self->logMpv, level);
+}
+
+// returns up to max of the last messages, from the oldest
+static FlValue* video_view_plugin_get_logs(VideoViewPlugin* self, guint max) {
+	FlValue* logs = fl_value_new_list();
+	if (self->logMpv) {
+		const guint head = (guint)g_atomic_int_get(&self->logHead);
+		max = MIN(max, VIDEO_VIEW_PLUGIN_LOG_SIZE);
+		gchar message[VIDEO_VIEW_PLUGIN_LOG_LENGTH];
+		for (guint i = head > max ? head - max : 0; i < head; i++) {
+			const guint slot = i % VIDEO_VIEW_PLUGIN_LOG_SIZE;
+			const gint sequence = g_atomic_int_get(&self->logSequences[slot]);
+			if (sequence & 1) {
+				continue;
+			}
+			g_strlcpy(message, &self->logBuffer[slot * VIDEO_VIEW_PLUGIN_LOG_LENGTH], VIDEO_VIEW_PLUGIN_LOG_LENGTH);
+			// skip the message if it is overwritten while copying
+			if (g_atomic_int_get(&self->logSequences[slot]) == sequence && (guint)g_atomic_int_get(&self->logHead) - i <= VIDEO_VIEW_PLUGIN_LOG_SIZE) {
+				fl_value_append_take(logs, fl_value_new_string(message));
+			}
+		}
+	}
+	return logs;
+}
+
+// sends an error event with the last log messages, so the cause is known without calling getLogs
+static void video_view_plugin_send_error(VideoViewPlugin* self, const gchar* message) {
+	g_autoptr(FlValue) evt = fl_value_new_map();
+	fl_value_set_string_take(evt, "event", fl_value_new_string("error"));
+	fl_value_set_string_take(evt, "value", fl_value_new_string(message));
+	fl_value_set_string_take(evt, "logs", video_view_plugin_get_logs(self, VIDEO_VIEW_PLUGIN_LOG_ERROR_TAIL));
+	fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+}
+
+static void video_view_plugin_add_time(uint32_t* times, uint32_t* count, const gint64 start) {
+	times[(*count)++ % VIDEO_VIEW_PLUGIN_STATS_SAMPLES] = (uint32_t)(g_get_monotonic_time() - start);
+}
+
+static void video_view_plugin_set_times(FlValue* stats, const gchar* name, const uint32_t* times, const uint32_t count) {
+	const uint32_t n = MIN(count, VIDEO_VIEW_PLUGIN_STATS_SAMPLES);
+	uint32_t sorted[VIDEO_VIEW_PLUGIN_STATS_SAMPLES];
+	uint64_t sum = 0;
+	for (uint32_t i = 0; i < n; i++) {
+		uint32_t j = i;
+		for (; j > 0 && sorted[j - 1] > times[i]; j--) {
+			sorted[j] = sorted[j - 1];
+		}
+		sorted[j] = times[i];
+		sum += times[i];
+	}
+	gchar* key = g_strdup_printf("%sAverage", name);
+	fl_value_set_string_take(stats, key, fl_value_new_int(n ? (int64_t)(sum / n) : 0));
+	g_free(key);
+	key = g_strdup_printf("%sP99", name);
+	fl_value_set_string_take(stats, key, fl_value_new_int(n ? sorted[n - 1 - n / 100] : 0));
+	g_free(key);
+}
+
+static uint32_t video_view_plugin_step_count(const VideoViewPlugin* self) {
+	g_mutex_lock(&mutex);
+	const uint32_t count = self->stepCount;
+	g_mutex_unlock(&mutex);
+	return count;
+}
+
+static FlValue* video_view_plugin_get_stats(VideoViewPlugin* self) {
+	FlValue* stats = fl_value_new_map();
+	int64_t value = 0;
+	mpv_get_property(self->mpv, "decoder-frame-drop-count", MPV_FORMAT_INT64, &value);
+	fl_value_set_string_take(stats, "decoderDrops", fl_value_new_int(value));
+	value = 0;
+	mpv_get_property(self->mpv, "frame-drop-count", MPV_FORMAT_INT64, &value);
+	fl_value_set_string_take(stats, "outputDrops", fl_value_new_int(value));
+	double fps = 0;
+	mpv_get_property(self->mpv, "estimated-vf-fps", MPV_FORMAT_DOUBLE, &fps);
+	fl_value_set_string_take(stats, "fps", fl_value_new_float(fps));
+	double avsync = 0;
+	mpv_get_property(self->mpv, "avsync", MPV_FORMAT_DOUBLE, &avsync);
+	fl_value_set_string_take(stats, "avSync", fl_value_new_float(avsync * 1000));
+	video_view_plugin_set_times(stats, "populate", self->populateTimes, self->populateCount);
+	video_view_plugin_set_times(stats, "render", self->renderTimes, self->renderCount);
+	video_view_plugin_set_times(stats, "upload", self->uploadTimes, self->uploadCount);
+	g_mutex_lock(&mutex);
+	const gint64 stepLatency = self->stepLatency;
+	const gint64 stepLatencyAverage = self->stepLatencyCount > 0 ? self->stepLatencySum / self->stepLatencyCount : 0;
+	g_mutex_unlock(&mutex);
+	fl_value_set_string_take(stats, "stepLatency", fl_value_new_int(stepLatency));
+	fl_value_set_string_take(stats, "stepLatencyAverage", fl_value_new_int(stepLatencyAverage));
+	// each frame is counted once: the texture shares its storage with mpv's one on the EGL path, while on the software
+	// path the texture is an upload of the buffer, and cached step frames are textures or buffers of their path
+	const int64_t stepBytes = (int64_t)self->fbo.w * self->fbo.h * 4 * video_view_plugin_step_count(self);
+	if (self->eglRendering) {
+		fl_value_set_string_take(stats, "textureBytes", fl_value_new_int(self->texture ? (int64_t)self->fbo.w * self->fbo.h * 4 + stepBytes : 0));
+		fl_value_set_string_take(stats, "bufferBytes", fl_value_new_int(0));
+	} else {
+		fl_value_set_string_take(stats, "textureBytes", fl_value_new_int(0));
+		fl_value_set_string_take(stats, "bufferBytes", fl_value_new_int(self->swBufferSize + stepBytes));
+	}
+	fl_value_set_string_take(stats, "cacheBytes", fl_value_new_int(self->cacheBytes));
+	value = 0;
+	mpv_get_property(self->mpv, "cache-speed", MPV_FORMAT_INT64, &value);
+	fl_value_set_string_take(stats, "cacheSpeed", fl_value_new_int(value));
+	gchar* hwdec = mpv_get_property_string(self->mpv, "hwdec-current");
+	fl_value_set_string_take(stats, "hwdec", fl_value_new_string(hwdec && !g_str_equal(hwdec, "no") ? hwdec : ""));
+	mpv_free(hwdec);
+	return stats;
+}
+
+// memory held for the player that the plugin can account for, GL objects are estimated from their size
+static int64_t video_view_plugin_get_memory(const VideoViewPlugin* self, VideoViewPluginMemory* memory) {
+	const int64_t frameBytes = (int64_t)self->fbo.w * self->fbo.h * 4;
+	memory->cache = MAX(self->cacheBytes - self->cacheDiskBytes, 0);
+	// the frame on screen is counted once, as the buffer on the software path
+	memory->buffer = self->eglRendering ? 0 : self->swBufferSize;
+	memory->texture = self->eglRendering && self->texture ? frameBytes : 0;
+	memory->stepCache = video_view_plugin_step_count(self) * frameBytes;
+	memory->tracks = self->videoTracks->len * sizeof(VideoViewPluginVideoTrack) + (self->audioTracks->len + self->subtitleTracks->len) * sizeof(VideoViewPluginTrack);
+	return memory->cache + memory->buffer + memory->texture + memory->stepCache + memory->tracks;
+}
+
+static FlValue* video_view_plugin_get_memory_usage(const VideoViewPlugin* self, int64_t* total) {
+	VideoViewPluginMemory memory;
+	*total = video_view_plugin_get_memory(self, &memory);
+	FlValue* usage = fl_value_new_map();
+	fl_value_set_string_take(usage, "cache", fl_value_new_int(memory.cache));
+	fl_value_set_string_take(usage, "buffer", fl_value_new_int(memory.buffer));
+	fl_value_set_string_take(usage, "texture", fl_value_new_int(memory.texture));
+	fl_value_set_string_take(usage, "stepCache", fl_value_new_int(memory.stepCache));
+	fl_value_set_string_take(usage, "tracks", fl_value_new_int(memory.tracks));
+	fl_value_set_string_take(usage, "total", fl_value_new_int(*total));
+	return usage;
+}
+
+static gboolean video_view_plugin_stats_callback(void* id) {
+	VideoViewPlugin* self = g_tree_lookup(players, id);
+	if (!self) {
+		return G_SOURCE_REMOVE;
+	}
+	if (self->state > 1) {
+		g_autoptr(FlValue) evt = video_view_plugin_get_stats(self);
+		fl_value_set_string_take(evt, "event", fl_value_new_string("stats"));
+		fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+	}
+	return G_SOURCE_CONTINUE;
+}
+
+static void video_view_plugin_set_stats_interval(VideoViewPlugin* self, const int64_t interval) {
+	if (self->statsTimer) {
+		g_source_remove(self->statsTimer);
+		self->statsTimer = 0;
+	}
+	if (interval > 0) {
+		self->statsTimer = g_timeout_add(interval, video_view_plugin_stats_callback, (void*)self->id);
+	}
+}
+
+// sends the timing of the last open once mediaInfo is sent and the first frame is drawn
+static void video_view_plugin_send_open_timing(VideoViewPlugin* self) {
+	if (!self->openStart || !self->openLoaded || (!self->openFrame && self->videoTracks->len > 0)) {
+		return;
+	}
+	g_autoptr(FlValue) evt = fl_value_new_map();
+	fl_value_set_string_take(evt, "event", fl_value_new_string("openTiming"));
+	fl_value_set_string_take(evt, "fileLoaded", fl_value_new_int(self->openFileLoaded / 1000));
+	fl_value_set_string_take(evt, "playbackRestart", fl_value_new_int(self->openRestart / 1000));
+	fl_value_set_string_take(evt, "mediaInfo", fl_value_new_int(self->openLoaded / 1000));
+	if (self->openPopulate) {
+		fl_value_set_string_take(evt, "firstPopulate", fl_value_new_int(self->openPopulate / 1000));
+	}
+	if (self->openFrame) {
+		fl_value_set_string_take(evt, "firstFrame", fl_value_new_int(self->openFrame / 1000));
+	}
+	fl_value_set_string_take(evt, "network", fl_value_new_bool(self->networking));
+	fl_value_set_string_take(evt, "fastStart", fl_value_new_bool(self->fastStart));
+	gchar* demuxer = mpv_get_property_string(self->mpv, "current-demuxer");
+	if (demuxer) {
+		fl_value_set_string_take(evt, "demuxer", fl_value_new_string(demuxer));
+		mpv_free(demuxer);
+	}
+	mpv_node state;
+	if (!mpv_get_property(self->mpv, "demuxer-cache-state", MPV_FORMAT_NODE, &state)) {
+		const mpv_node* value = video_view_plugin_node_get(&state, "fw-bytes", MPV_FORMAT_INT64);
+		if (value) {
+			fl_value_set_string_take(evt, "cacheBytes", fl_value_new_int(value->u.int64));
+		}
+		value = video_view_plugin_node_get(&state, "cache-duration", MPV_FORMAT_DOUBLE);
+		if (value) {
+			fl_value_set_string_take(evt, "cacheDuration", fl_value_new_int((int64_t)(value->u.double_ * 1000)));
+		}
+		value = video_view_plugin_node_get(&state, "raw-input-rate", MPV_FORMAT_INT64);
+		if (value) {
+			fl_value_set_string_take(evt, "inputRate", fl_value_new_int(value->u.int64));
+		}
+		mpv_free_node_contents(&state);
+	}
+	fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+	self->openStart = 0;
+}
+
+static gboolean video_view_plugin_open_timing_callback(void* id) {
+	VideoViewPlugin* self = g_tree_lookup(players, id);
+	if (self) {
+		video_view_plugin_send_open_timing(self);
+	}
+	return G_SOURCE_REMOVE;
+}
+
+static void video_view_plugin_loaded(VideoViewPlugin* self) {
+	int64_t count;
+	// tracks may be filled from the probe cache
+	g_array_set_size(self->videoTracks, 0);
+	g_array_set_size(self->audioTracks, 0);
+	g_array_set_size(self->subtitleTracks, 0);
+	mpv_get_property(self->mpv, "track-list/count", MPV_FORMAT_INT64, &count);
+	FlValue* audioTracks = fl_value_new_map();
+	FlValue* subtitleTracks = fl_value_new_map();
+	for (uint32_t i = 0; i < count; i++) {
+		gchar* str;
+		gchar p[33];
+		sprintf(p, "track-list/%d/type", i);
+		mpv_get_property(self->mpv, p, MPV_FORMAT_STRING, &str);
+		const uint8_t type = g_str_equal(str, "video") ? 2 : g_str_equal(str, "audio") ? 0 : 1;
+		mpv_free(str);
+		int64_t trackId;
+		sprintf(p, "track-list/%d/id", i);
+		mpv_get_property(self->mpv, p, MPV_FORMAT_INT64, &trackId);
+		int64_t size;
+		if (type == 2) {
+			VideoViewPluginVideoTrack data = { .id = (uint16_t)trackId };
+			sprintf(p, "track-list/%d/demux-w", i);
+			if (!mpv_get_property(self->mpv, p, MPV_FORMAT_INT64, &size)) {
+				data.width = (uint16_t)size;
+			}
+			sprintf(p, "track-list/%d/demux-h", i);
+			if (!mpv_get_property(self->mpv, p, MPV_FORMAT_INT64, &size)) {
+				data.height = (uint16_t)size;
+			}
+			sprintf(p, "track-list/%d/hls-bitrate", i);
+			if (!mpv_get_property(self->mpv, p, MPV_FORMAT_INT64, &size)) {
+				data.bitrate = (uint32_t)size;
+			}
+			g_array_append_val(self->videoTracks, data);
+		} else {
+			VideoViewPluginTrack t = { .id = (uint16_t)trackId };
+			sprintf(p, "track-list/%d/default", i);
+			if (!mpv_get_property(self->mpv, p, MPV_FORMAT_STRING, &str)) {
+				t.def = g_str_equal(str, "yes");
+				mpv_free(str);
+			}
+			FlValue* info = fl_value_new_map();
+			sprintf(p, "track-list/%d/lang", i);
+			if (!mpv_get_property(self->mpv, p, MPV_FORMAT_STRING, &str)) {
+				UErrorCode status = U_ZERO_ERROR;
+				char langtag[ULOC_FULLNAME_CAPACITY];
+				ulocToLanguageTag(str, langtag, ULOC_FULLNAME_CAPACITY, FALSE, &status); // we don't want ISO 639-2 codes
+				const gchar* lang = U_FAILURE(status) ? str : langtag;
+				fl_value_set_string_take(info, "language", fl_value_new_string(lang));
+				t.size = video_view_plugin_split_lang(lang, t.language);
+				mpv_free(str);
+			}
+			g_array_append_val(type ? self->subtitleTracks : self->audioTracks, t);
+			sprintf(p, "track-list/%d/title", i);
+			if (!mpv_get_property(self->mpv, p, MPV_FORMAT_STRING, &str)) {
+				fl_value_set_string_take(info, "label", fl_value_new_string(str));
+				mpv_free(str);
+			}
+			sprintf(p, "track-list/%d/codec", i);
+			if (!mpv_get_property(self->mpv, p, MPV_FORMAT_STRING, &str)) {
+				fl_value_set_string_take(info, "format", fl_value_new_string(str));
+				mpv_free(str);
+			} else {
+				sprintf(p, "track-list/%d/format-name", i);
+				if (!mpv_get_property(self->mpv, p, MPV_FORMAT_STRING, &str)) {
+					fl_value_set_string_take(info, "format", fl_value_new_string(str));
+					mpv_free(str);
+				}
+			}
+			if (type) {
+				sprintf(p, "%d.%ld", type, trackId);
+				fl_value_set_string_take(subtitleTracks, p, info);
+			} else {
+				sprintf(p, "track-list/%d/demux-bitrate", i);
+				if (!mpv_get_property(self->mpv, p, MPV_FORMAT_INT64, &size)) {
+					fl_value_set_string_take(info, "bitrate", fl_value_new_int(size));
+				}
+				sprintf(p, "track-list/%d/demux-channel-count", i);
+				if (!mpv_get_property(self->mpv, p, MPV_FORMAT_INT64, &size)) {
+					fl_value_set_string_take(info, "channels", fl_value_new_int(size));
+				}
+				sprintf(p, "track-list/%d/demux-samplerate", i);
+				if (!mpv_get_property(self->mpv, p, MPV_FORMAT_INT64, &size)) {
+					fl_value_set_string_take(info, "sampleRate", fl_value_new_int(size));
+				}
+				sprintf(p, "%d.%ld", type, trackId);
+				fl_value_set_string_take(audioTracks, p, info);
+			}
+		}
+	}
+	double duration;
+	if (self->streaming) {
+		duration = 0;
+	} else {
+		mpv_get_property(self->mpv, "duration/full", MPV_FORMAT_DOUBLE, &duration);
+	}
+	self->state = 2;
+	if (!self->streaming) {
+		video_view_plugin_speed_scan(self);
+	}
+	if (self->adaptiveBitRate && self->abrFast > 0) {
+		// the estimate from the last media is the best guess to start with
+		self->abrBitRate = video_view_plugin_abr_choose(self, MIN(self->abrFast, self->abrSlow) * VIDEO_VIEW_PLUGIN_ABR_SAFETY);
+	}
+	if (self->videoTracks->len == 0 && self->mpvRenderContext) {
+		// the extension doesn't tell every source without video, the track list does
+		video_view_plugin_free_render_context((void*)self->id);
+	}
+	video_view_plugin_select_video(self);
+	video_view_plugin_apply_frame_rate(self);
+	video_view_plugin_set_default_track(self, 0);
+	video_view_plugin_set_default_track(self, 1);
+	video_view_plugin_update_audio(self);
+	if (!self->streaming) {
+		video_view_plugin_probe_save(self, duration, audioTracks, subtitleTracks);
+	}
+	g_autoptr(FlValue) evt = fl_value_new_map();
+	fl_value_set_string_take(evt, "event", fl_value_new_string("mediaInfo"));
+	fl_value_set_string_take(evt, "source", fl_value_new_string(self->source));
+	fl_value_set_string_take(evt, "duration", fl_value_new_int((int64_t)(duration * 1000)));
+	fl_value_set_string_take(evt, "audioTracks", audioTracks);
+	fl_value_set_string_take(evt, "subtitleTracks", subtitleTracks);
+	if (!self->probed) {
+		fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+	} else {
+		// only send changes if mediaInfo is already sent from the probe cache
+		if (fl_value_get_int(fl_value_lookup_string(self->probed, "duration")) != (int64_t)(duration * 1000) || !fl_value_equal(fl_value_lookup_string(self->probed, "audioTracks"), audioTracks) || !fl_value_equal(fl_value_lookup_string(self->probed, "subtitleTracks"), subtitleTracks)) {
+			fl_value_set_string_take(evt, "event", fl_value_new_string("mediaInfoUpdate"));
+			fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+		}
+		fl_value_unref(self->probed);
+		self->probed = NULL;
+	}
+	if (!self->streaming) {
+		int64_t pos = video_view_plugin_get_pos(self);
+		if (pos > 0) {
+			video_view_plugin_send_time(self, pos);
+		}
+		if (self->networking && self->bufferPosition > pos) {
+			video_view_plugin_send_buffer(self, pos);
+		}
+	}
+	if (self->playPending) {
+		self->playPending = false;
+		video_view_plugin_play(self);
+	}
+}
+
+static void* video_view_plugin_init_mpv_gl(void* addrCtx, const char* name) {
+	return eglGetProcAddress(name);
+}
+
+static void video_view_plugin_capture_egl_state(VideoViewPluginEglState* state) {
+	state->display = eglGetCurrentDisplay();
+	state->context = eglGetCurrentContext();
+	state->draw = eglGetCurrentSurface(EGL_DRAW);
+	state->read = eglGetCurrentSurface(EGL_READ);
+}
+
+static void video_view_plugin_restore_egl_state(const VideoViewPluginEglState* state, EGLDisplay fallbackDisplay) {
+	const int64_t trace = video_view_plugin_trace_begin("restoreCurrent", 0);
+	if (state->display != EGL_NO_DISPLAY) {
+		eglMakeCurrent(state->display, state->draw, state->read, state->context);
+	} else if (fallbackDisplay != EGL_NO_DISPLAY) {
+		eglMakeCurrent(fallbackDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	}
+	video_view_plugin_trace_end("restoreCurrent", 0, trace, NULL);
+}
+
+static bool video_view_plugin_make_platform_gl_current() {
+	if (!pluginView) {
+		return false;
+	}
+	GtkWidget* widget = GTK_WIDGET(pluginView);
+	if (!gtk_widget_get_realized(widget)) {
+		return false;
 	}
 	GdkWindow* window = gtk_widget_get_window(widget);
 	if (!window) {
@@ -473,7 +1625,10 @@ static bool video_view_plugin_make_platform_gl_current() {
 
 static bool video_view_plugin_make_isolated_egl_current(const VideoViewPlugin* self) {
 	if (self->eglDisplay != EGL_NO_DISPLAY && self->eglContext != EGL_NO_CONTEXT) {
-		return eglMakeCurrent(self->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, self->eglContext);
+		const int64_t trace = video_view_plugin_trace_begin("makeCurrent", self->id);
+		const bool result = eglMakeCurrent(self->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, self->eglContext);
+		video_view_plugin_trace_end("makeCurrent", self->id, trace, NULL);
+		return result;
 	}
 	return false;
 }
@@ -526,8 +1681,121 @@ static void video_view_plugin_clear_mpv_gl_resources(VideoViewPlugin* self) {
 		eglDestroyImageKHR(self->eglDisplay, self->eglImage);
 		self->eglImage = EGL_NO_IMAGE_KHR;
 	}
-	self->fbo.w = 0;
-	self->fbo.h = 0;
+	self->fbo.w = 0;
+	self->fbo.h = 0;
+}
+
+// deletes textures of frames released while the isolated context couldn't be made current, called with it current
+static void video_view_plugin_step_delete_stale(VideoViewPlugin* self) {
+	if (self->stepStale->len > 0) {
+		glDeleteTextures(self->stepStale->len, (GLuint*)self->stepStale->data);
+		g_array_set_size(self->stepStale, 0);
+	}
+}
+
+// frees the cached frames, called by populate or once the texture is unregistered
+static void video_view_plugin_step_release(VideoViewPlugin* self) {
+	self->stepIndex = -1;
+	self->stepRemaining = 0;
+	self->stepFilling = self->stepCapture = self->stepRunning = false;
+	if (self->stepFrames->len > 0 || self->stepFbo || self->stepStale->len > 0) {
+		VideoViewPluginEglState previousState = { 0 };
+		video_view_plugin_capture_egl_state(&previousState);
+		const bool madeCurrent = self->eglRendering && video_view_plugin_make_isolated_egl_current(self);
+		// the GL objects are kept to be deleted by the next populate or release, unless the context is gone
+		const bool keep = self->eglRendering && !madeCurrent;
+		for (guint i = 0; i < self->stepFrames->len; i++) {
+			VideoViewPluginStepFrame* frame = &g_array_index(self->stepFrames, VideoViewPluginStepFrame, i);
+			if (frame->texture && madeCurrent) {
+				glDeleteTextures(1, &frame->texture);
+			} else if (frame->texture && keep) {
+				g_array_append_val(self->stepStale, frame->texture);
+			}
+			g_free(frame->buffer);
+		}
+		if (madeCurrent) {
+			video_view_plugin_step_delete_stale(self);
+			if (self->stepFbo) {
+				glDeleteFramebuffers(1, &self->stepFbo);
+			}
+			video_view_plugin_restore_egl_state(&previousState, self->eglDisplay);
+		}
+		if (!keep) {
+			self->stepFbo = 0;
+			g_array_set_size(self->stepStale, 0);
+		}
+		g_array_set_size(self->stepFrames, 0);
+	}
+}
+
+// the cached frames are in use by populate, so they are released on the next frame
+// called with mutex locked, returns whether frames were cached
+static bool video_view_plugin_step_reset(VideoViewPlugin* self) {
+	const bool cached = self->stepCount > 0;
+	self->stepStart = 0;
+	self->stepQueued = 0;
+	self->stepCount = 0;
+	self->stepShown = -1;
+	self->stepSeeking = false;
+	self->stepClearPending = true;
+	return cached;
+}
+
+static void video_view_plugin_step_clear(VideoViewPlugin* self) {
+	g_mutex_lock(&mutex);
+	const bool cached = video_view_plugin_step_reset(self);
+	g_mutex_unlock(&mutex);
+	if (cached && self->state > 0 && self->texture) {
+		fl_texture_registrar_mark_texture_frame_available(textureRegistrar, FL_TEXTURE(self));
+	}
+}
+
+// queues the release of cached step frames and optionally the software buffer, populate frees them since it may be using them
+static void video_view_plugin_trim(VideoViewPlugin* self, const bool buffer) {
+	g_mutex_lock(&mutex);
+	const bool cached = video_view_plugin_step_reset(self);
+	const bool trimming = buffer && !self->trimPending;
+	self->trimPending = self->trimPending || buffer;
+	g_mutex_unlock(&mutex);
+	if (self->texture && ((cached && self->state > 0) || trimming)) {
+		fl_texture_registrar_mark_texture_frame_available(textureRegistrar, FL_TEXTURE(self));
+	}
+}
+
+static bool video_view_plugin_is_stepping(VideoViewPlugin* self) {
+	g_mutex_lock(&mutex);
+	const bool stepping = self->stepStart || self->stepCount > 0;
+	g_mutex_unlock(&mutex);
+	return stepping;
+}
+
+// returns true if the seek of a backward fill is done
+static bool video_view_plugin_step_seeked(VideoViewPlugin* self) {
+	g_mutex_lock(&mutex);
+	const bool seeked = self->stepSeeking;
+	self->stepSeeking = false;
+	g_mutex_unlock(&mutex);
+	return seeked;
+}
+
+// the render size is halved by the quality governor, the texture is scaled to the view anyway
+static void video_view_plugin_update_render_size(VideoViewPlugin* self, int64_t* width, int64_t* height) {
+	*width = *height = 0;
+	mpv_get_property(self->mpv, "dwidth", MPV_FORMAT_INT64, width);
+	mpv_get_property(self->mpv, "dheight", MPV_FORMAT_INT64, height);
+	const int shift = self->quality >= 2 ? 1 : 0;
+	self->width = (GLsizei)(*width >> shift);
+	self->height = (GLsizei)(*height >> shift);
+	if (self->width != self->fbo.w || self->height != self->fbo.h) {
+		video_view_plugin_step_clear(self);
+	}
+}
+
+static void video_view_plugin_step_seek(VideoViewPlugin* self, const double pts) {
+	gchar* t = g_strdup_printf("%lf", pts);
+	const gchar* cmd[] = { "seek", t, "absolute+exact", NULL };
+	mpv_command(self->mpv, cmd);
+	g_free(t);
 }
 
 static void video_view_plugin_set_render_callback(VideoViewPlugin* self) {
@@ -542,12 +1810,133 @@ static bool video_view_plugin_create_render_context(VideoViewPlugin* self, mpv_r
 	return false;
 }
 
+// consumes the pending frame of a hidden player without rendering it, while populate keeps off the render context
+static void video_view_plugin_drop_frame(VideoViewPlugin* self) {
+	if (!self->mpvRenderContext || !(mpv_render_context_update(self->mpvRenderContext) & MPV_RENDER_UPDATE_FRAME)) {
+		return;
+	}
+	int skip = 1;
+	int block = 0;
+	if (self->eglRendering) {
+		// mpv may still reconfigure its renderer, which needs the GL context
+		mpv_opengl_fbo fbo = self->fbo;
+		if (!fbo.fbo) {
+			fbo.w = self->width;
+			fbo.h = self->height;
+		}
+		VideoViewPluginEglState flutterState = { 0 };
+		video_view_plugin_capture_egl_state(&flutterState);
+		if (video_view_plugin_make_isolated_egl_current(self)) {
+			mpv_render_param params[] = {
+				{ MPV_RENDER_PARAM_OPENGL_FBO, &fbo },
+				{ MPV_RENDER_PARAM_SKIP_RENDERING, &skip },
+				{ MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &block },
+				{ MPV_RENDER_PARAM_INVALID, NULL }
+			};
+			mpv_render_context_render(self->mpvRenderContext, params);
+		}
+		video_view_plugin_restore_egl_state(&flutterState, self->eglDisplay);
+	} else {
+		// the buffer may be trimmed, the parameters are only checked since nothing is rendered
+		static guint8 pixel[4];
+		const bool buffered = self->swBuffer && self->swBufferSize >= (size_t)self->width * 4 * self->height;
+		int swSize[] = { buffered ? self->width : 1, buffered ? self->height : 1 };
+		char swFormat[] = "rgb0";
+		size_t swStride = buffered ? (size_t)self->width * 4 : 4;
+		mpv_render_param params[] = {
+			{ MPV_RENDER_PARAM_SW_SIZE, swSize },
+			{ MPV_RENDER_PARAM_SW_FORMAT, swFormat },
+			{ MPV_RENDER_PARAM_SW_STRIDE, &swStride },
+			{ MPV_RENDER_PARAM_SW_POINTER, buffered ? self->swBuffer : pixel },
+			{ MPV_RENDER_PARAM_SKIP_RENDERING, &skip },
+			{ MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &block },
+			{ MPV_RENDER_PARAM_INVALID, NULL }
+		};
+		mpv_render_context_render(self->mpvRenderContext, params);
+	}
+}
+
+static gboolean video_view_plugin_drop_callback(void* id) {
+	g_mutex_lock(&mutex);
+	VideoViewPlugin* self = g_tree_lookup(players, id);
+	bool drop = false;
+	if (self) {
+		self->dropSource = 0;
+		if (self->appliedVisibility > 0) {
+			drop = !self->rendering;
+			self->dropping = drop;
+			if (!drop) {
+				// populate is still using the render context
+				self->dropSource = g_timeout_add(1, video_view_plugin_drop_callback, id);
+			}
+		}
+	}
+	g_mutex_unlock(&mutex);
+	if (drop) {
+		video_view_plugin_drop_frame(self);
+		g_mutex_lock(&mutex);
+		self->dropping = false;
+		g_mutex_unlock(&mutex);
+	}
+	return G_SOURCE_REMOVE;
+}
+
+// frees the render context of media without video once populate is off it, the texture keeps the last frame
+static gboolean video_view_plugin_free_render_context(void* id) {
+	g_mutex_lock(&mutex);
+	VideoViewPlugin* self = g_tree_lookup(players, id);
+	// another media may be opened meanwhile
+	bool release = self && self->state > 1 && self->videoTracks->len == 0 && self->mpvRenderContext && !self->dropping;
+	if (release) {
+		self->dropping = !self->rendering;
+		if (!self->dropping) {
+			release = false;
+			g_timeout_add(1, video_view_plugin_free_render_context, id);
+		}
+	}
+	g_mutex_unlock(&mutex);
+	if (!release) {
+		return G_SOURCE_REMOVE;
+	}
+	// cached frames of the previous media live in the isolated context
+	video_view_plugin_step_release(self);
+	VideoViewPluginEglState flutterState = { 0 };
+	video_view_plugin_capture_egl_state(&flutterState);
+	const bool madeCurrent = self->eglRendering && video_view_plugin_make_isolated_egl_current(self);
+	mpv_render_context_set_update_callback(self->mpvRenderContext, NULL, NULL);
+	mpv_render_context_free(self->mpvRenderContext);
+	self->mpvRenderContext = NULL;
+	if (madeCurrent) {
+		video_view_plugin_clear_mpv_gl_resources(self);
+	}
+	video_view_plugin_restore_egl_state(&flutterState, self->eglDisplay);
+	if (self->eglContext != EGL_NO_CONTEXT && self->eglDisplay != EGL_NO_DISPLAY) {
+		eglDestroyContext(self->eglDisplay, self->eglContext);
+	}
+	self->eglContext = EGL_NO_CONTEXT;
+	self->eglDisplay = EGL_NO_DISPLAY;
+	self->eglImage = EGL_NO_IMAGE_KHR;
+	self->mpvTexture = 0;
+	self->eglRendering = false;
+	g_free(self->swBuffer);
+	self->swBuffer = NULL;
+	self->swBufferSize = 0;
+	g_mutex_lock(&mutex);
+	self->dropping = false;
+	g_mutex_unlock(&mutex);
+	return G_SOURCE_REMOVE;
+}
+
 static void video_view_plugin_texture_update_callback(void* id) {
 	// this function may be called from mpv event thread, so we need to lock the mutex
 	g_mutex_lock(&mutex);
 	VideoViewPlugin* self = g_tree_lookup(players, id);
-	if (self) {
+	if (self && self->appliedVisibility == 0) {
 		fl_texture_registrar_mark_texture_frame_available(textureRegistrar, FL_TEXTURE(self));
+	} else if (self && !self->dropSource) {
+		// hidden players are not rendered, but mpv waits for each frame to be rendered before presenting the next one, so
+		// their frames are dropped, and the latest frame is rendered when they become visible again
+		self->dropSource = g_idle_add(video_view_plugin_drop_callback, id);
 	}
 	g_mutex_unlock(&mutex);
 }
@@ -555,11 +1944,48 @@ static void video_view_plugin_texture_update_callback(void* id) {
 static void video_view_plugin_close(VideoViewPlugin* self) {
 	video_view_plugin_set_inhibit(self, false);
 	self->state = 0;
+	video_view_plugin_set_scan_speed(self, 0);
+	if (self->liveTimer) {
+		g_source_remove(self->liveTimer);
+		self->liveTimer = 0;
+	}
+	self->liveSpeed = 1;
+	if (self->timeShiftBytes > 0) {
+		video_view_plugin_set_back_bytes(self, 0);
+	}
+	self->timeShifted = false;
+	self->liveJumping = false;
 	self->width = self->height = 0;
 	self->position = self->bufferPosition = 0;
 	self->overrideAudio = self->overrideSubtitle = 0;
 	self->streaming = self->seeking = self->networking = false;
+	self->cacheBytes = self->cacheDiskBytes = 0;
+	self->cacheHits = self->cacheMisses = self->cacheReported = 0;
+	self->cacheEvicted = self->cacheShrunk = false;
+	self->playPending = self->fastStarting = false;
+	video_view_plugin_apply_quality(self, 0);
+	self->abrBitRate = 0;
+	self->abrSwitched = 0;
+	self->abrReading = false;
+	if (self->framesSkipped) {
+		self->framesSkipped = false;
+		mpv_set_property_string(self->mpv, "vd-lavc-skipframe", "default");
+	}
+	self->skipReload = false;
+	self->videoDropped = false;
+	if (self->audioDropped) {
+		// aid is not file local
+		self->audioDropped = false;
+		mpv_set_property_string(self->mpv, "aid", "auto");
+	}
+	self->openStart = 0;
+	video_view_plugin_step_clear(self);
+	if (self->probed) {
+		fl_value_unref(self->probed);
+		self->probed = NULL;
+	}
 	if (self->source) {
+		video_view_plugin_proxy_forget(self->source);
 		g_free(self->source);
 		self->source = NULL;
 	}
@@ -573,13 +1999,103 @@ static void video_view_plugin_close(VideoViewPlugin* self) {
 	mpv_set_property_string(self->mpv, "profile", "libmpv");
 }
 
-static void video_view_plugin_open(VideoViewPlugin* self, const gchar* source) {
-	video_view_plugin_close(self);
+static int video_view_plugin_load_file(VideoViewPlugin* self, const gchar* url) {
+	mpv_node values[] = {
+		{ .u.string = "loadfile", .format = MPV_FORMAT_STRING },
+		{ .u.string = (char*)url, .format = MPV_FORMAT_STRING },
+		{ .u.string = NULL, .format = MPV_FORMAT_STRING }
+	};
+	char* keys[] = { "name", "url", "options" };
+	mpv_node_list list = { .num = 2, .values = values, .keys = keys };
+	mpv_node cmd = { .u.list = &list, .format = MPV_FORMAT_NODE_MAP };
+	// options given to loadfile are file local, mpv restores them when the file is closed
+	GString* options = g_string_new(NULL);
+	if (self->fastStart) {
+		g_string_append(options, VIDEO_VIEW_PLUGIN_FAST_START_PROBE);
+		for (int i = 0; fastStartOptions[i]; i += 2) {
+			g_string_append_printf(options, ",%s=%s", fastStartOptions[i], fastStartOptions[i + 1]);
+		}
+	}
+	if (!self->mpvRenderContext || self->appliedVisibility > 1) {
+		// video is selected in video_view_plugin_select_video if it's needed
+		g_string_append(options, options->len ? ",vid=no" : "vid=no");
+	}
+	if (options->len) {
+		values[2].u.string = options->str;
+		list.num = 3;
+	}
+	int result = mpv_command_node(self->mpv, &cmd, NULL);
+	self->fastStarting = self->fastStart && result == MPV_ERROR_SUCCESS;
+	g_string_free(options, TRUE);
+	return result;
+}
+
+static const gchar* video_view_plugin_default_option(const VideoViewPlugin* self, const gchar* name) {
+	for (int i = 0; fastStartOptions[i]; i += 2) {
+		if (g_str_equal(fastStartOptions[i], name)) {
+			return self->fastStartDefaults[i / 2];
+		}
+	}
+	return NULL;
+}
+
+// readahead of the priority class, fast start lowers it further until playback begins
+static void video_view_plugin_apply_readahead(VideoViewPlugin* self) {
+	if (!self->fastStarting) {
+		const VideoViewPluginPriority* priority = &priorities[self->priority];
+		const gchar* readahead = priority->readahead ? priority->readahead : video_view_plugin_default_option(self, "demuxer-readahead-secs");
+		const gchar* cacheSecs = priority->cacheSecs ? priority->cacheSecs : video_view_plugin_default_option(self, "cache-secs");
+		if (readahead) {
+			mpv_set_property_string(self->mpv, "demuxer-readahead-secs", readahead);
+		}
+		if (cacheSecs) {
+			mpv_set_property_string(self->mpv, "cache-secs", cacheSecs);
+		}
+	}
+}
+
+static gboolean video_view_plugin_sum_thread_weight(void* key, void* value, void* sum) {
+	const VideoViewPlugin* player = value;
+	if (player->state > 0) {
+		*(uint32_t*)sum += priorities[player->priority].threadWeight;
+	}
+	return FALSE;
+}
+
+// splits the decoder thread budget by priority among opened players, mpv applies it when the decoder is created
+static void video_view_plugin_apply_decoder_threads(VideoViewPlugin* self) {
+	const uint32_t weight = priorities[self->priority].threadWeight;
+	uint32_t sum = weight;
+	g_tree_foreach(players, video_view_plugin_sum_thread_weight, &sum);
+	gchar* threads = g_strdup_printf("%u", MAX(decoderThreads * weight / sum, 1));
+	mpv_set_property_string(self->mpv, "vd-lavc-threads", threads);
+	g_free(threads);
+}
+
+static void video_view_plugin_fast_start_end(VideoViewPlugin* self) {
+	if (self->fastStarting) {
+		self->fastStarting = false;
+		for (int i = 0; fastStartOptions[i]; i += 2) {
+			if (self->fastStartDefaults[i / 2]) {
+				mpv_set_property_string(self->mpv, fastStartOptions[i], self->fastStartDefaults[i / 2]);
+			}
+		}
+		video_view_plugin_apply_readahead(self);
+	}
+}
+
+static void video_view_plugin_init_render_context(VideoViewPlugin* self) {
 	// we try to create EGL render context first since it has better performance
 	if (!self->mpvRenderContext && eglCreateImageKHR && eglDestroyImageKHR && glEGLImageTargetTexture2DOES && (eglGetCurrentContext() != EGL_NO_CONTEXT || video_view_plugin_make_platform_gl_current()) && video_view_plugin_init_isolated_egl_context(self)) {
 		VideoViewPluginEglState flutterState = { 0 };
 		video_view_plugin_capture_egl_state(&flutterState);
 		if (video_view_plugin_make_isolated_egl_current(self)) {
+			// compiled shaders are kept across launches, so the first frame is not held by shader compilation
+			if (!shaderCacheDir) {
+				shaderCacheDir = g_build_filename(g_get_user_cache_dir(), "video_view", "shaders", NULL);
+				g_mkdir_with_parents(shaderCacheDir, 0700);
+			}
+			mpv_set_property_string(self->mpv, "gpu-shader-cache-dir", shaderCacheDir);
 			mpv_opengl_init_params gl_init_params = { video_view_plugin_init_mpv_gl, NULL };
 			mpv_render_param params[] = {
 				{ MPV_RENDER_PARAM_API_TYPE, MPV_RENDER_API_TYPE_OPENGL },
@@ -611,43 +2127,69 @@ static void video_view_plugin_open(VideoViewPlugin* self, const gchar* source) {
 		};
 		video_view_plugin_create_render_context(self, params);
 	}
-	if (self->mpvRenderContext) {
+}
+
+static void video_view_plugin_open(VideoViewPlugin* self, const gchar* source) {
+	video_view_plugin_close(self);
+	self->probeSerial++;
+	// audio only players and sources without video are opened without a render context
+	const bool audioOnly = self->appliedVisibility > 1 || video_view_plugin_is_audio_source(source);
+	if (!audioOnly) {
+		video_view_plugin_init_render_context(self);
+	}
+	if (self->mpvRenderContext || audioOnly) {
 		int result;
+		video_view_plugin_apply_cache_policy(self);
+		video_view_plugin_use_cache(self);
+		video_view_plugin_apply_decoder_threads(self);
+		self->openStart = g_get_monotonic_time();
+		self->openFileLoaded = self->openRestart = self->openLoaded = self->openPopulate = self->openFrame = 0;
 		if (g_str_has_prefix(source, "asset://")) {
 			g_autoptr(FlDartProject) project = fl_dart_project_new();
 			gchar* path = g_strdup_printf("%s%s", fl_dart_project_get_assets_path(project), &source[7]);
-			const gchar* cmd[] = { "loadfile", path, NULL };
-			result = mpv_command(self->mpv, cmd);
+			result = video_view_plugin_load_file(self, path);
 			g_free(path);
 		} else {
-			const gchar* cmd[] = { "loadfile", source, NULL };
-			result = mpv_command(self->mpv, cmd);
+			gchar* url = video_view_plugin_proxy_url(self->id, source);
+			result = video_view_plugin_load_file(self, url);
+			g_free(url);
 		}
 		if (result == MPV_ERROR_SUCCESS) {
+			video_view_plugin_proxy_set_weight(self->id, priorities[self->priority].proxyWeight);
 			self->state = 1;
 			self->source = g_strdup(source);
 			video_view_plugin_set_pause(self, TRUE);
+			// mediaInfo is sent from the probe cache if the entry is found before the demuxer is done
+			video_view_plugin_probe_push(self, NULL);
 		} else {
-			g_autoptr(FlValue) evt = fl_value_new_map();
-			fl_value_set_string_take(evt, "event", fl_value_new_string("error"));
-			fl_value_set_string_take(evt, "value", fl_value_new_string(mpv_error_string(result)));
-			fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+			video_view_plugin_send_error(self, mpv_error_string(result));
 		}
 	} else {
-		g_autoptr(FlValue) evt = fl_value_new_map();
-		fl_value_set_string_take(evt, "event", fl_value_new_string("error"));
-		fl_value_set_string_take(evt, "value", fl_value_new_string("render context not available"));
-		fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+		video_view_plugin_send_error(self, "render context not available");
 	}
 }
 
 static void video_view_plugin_play(VideoViewPlugin* self) {
-	if (self->state == 2) {
+	if (self->state == 1 && self->probed) {
+		self->playPending = true;
+	} else if (self->state == 2) {
 		self->state = 3;
+		video_view_plugin_proxy_set_weight(self->id, priorities[self->priority].proxyWeight);
+		g_mutex_lock(&mutex);
+		const double shown = self->stepShown;
+		g_mutex_unlock(&mutex);
+		if (shown >= 0) {
+			// mpv stays at the last cached frame, so we need to move it to the one on screen
+			video_view_plugin_step_seek(self, shown);
+		}
+		video_view_plugin_step_clear(self);
+		video_view_plugin_use_cache(self);
+		video_view_plugin_fast_start_end(self);
 		if (video_view_plugin_is_eof(self)) {
 			video_view_plugin_just_seek_to(self, 100, true, false);
 		}
-		video_view_plugin_set_pause(self, FALSE);
+		// mpv stays paused while scanning, the scan timer moves the position instead
+		video_view_plugin_set_pause(self, self->scanSpeed != 0);
 		if (self->width > 0 && self->height > 0 && self->keepScreenOn) {
 			video_view_plugin_set_inhibit(self, true);
 		}
@@ -655,14 +2197,17 @@ static void video_view_plugin_play(VideoViewPlugin* self) {
 }
 
 static void video_view_plugin_pause(VideoViewPlugin* self) {
+	self->playPending = false;
 	if (self->state > 2) {
 		self->state = 2;
+		self->timeShifted = self->streaming && self->timeShift > 0;
+		video_view_plugin_proxy_set_weight(self->id, VIDEO_VIEW_PLUGIN_PROXY_WEIGHT_IDLE);
 		video_view_plugin_set_pause(self, TRUE);
 		video_view_plugin_set_inhibit(self, false);
 	}
 }
 
-static void video_view_plugin_seek_to(VideoViewPlugin* self, const int64_t position, const bool fast) {
+static void video_view_plugin_seek_to(VideoViewPlugin* self, int64_t position, const bool fast) {
 	if (self->state == 1) {
 		if (self->seeking) {
 			video_view_plugin_just_seek_to(self, position, true, false);
@@ -670,7 +2215,24 @@ static void video_view_plugin_seek_to(VideoViewPlugin* self, const int64_t posit
 			self->position = position;
 		}
 	} else if (self->state > 1) {
+		if (self->streaming) {
+			if (self->timeShift <= 0) {
+				return;
+			}
+			position = CLAMP(position, video_view_plugin_time_shift_start(self), self->bufferPosition);
+			self->timeShifted = self->bufferPosition - position > self->targetLatency + VIDEO_VIEW_PLUGIN_LIVE_JUMP;
+		}
+		video_view_plugin_step_clear(self);
+		self->scanPosition = (double)position / 1000;
 		if (video_view_plugin_get_pos(self) != position) {
+			if (self->networking && !self->streaming) {
+				if (!self->cacheEvicted && video_view_plugin_is_cached(self, position)) {
+					self->cacheHits++;
+				} else {
+					self->cacheMisses++;
+				}
+			}
+			video_view_plugin_use_cache(self);
 			video_view_plugin_just_seek_to(self, position, fast, true);
 		} else if (!self->seeking) {
 			g_autoptr(FlValue) evt = fl_value_new_map();
@@ -680,16 +2242,315 @@ static void video_view_plugin_seek_to(VideoViewPlugin* self, const int64_t posit
 	}
 }
 
+// mpv decodes every frame at any speed, so speeds over the threshold scan keyframes like setScanSpeed
+static void video_view_plugin_speed_scan(VideoViewPlugin* self) {
+	if (self->speed > VIDEO_VIEW_PLUGIN_SCAN_SPEED) {
+		if (self->scanSpeed == 0 || self->speedScanning) {
+			video_view_plugin_set_scan_speed(self, self->speed);
+			self->speedScanning = self->scanSpeed != 0;
+		}
+	} else if (self->speedScanning) {
+		video_view_plugin_set_scan_speed(self, 0);
+	}
+}
+
 static void video_view_plugin_set_speed(VideoViewPlugin* self, const double speed) {
 	self->speed = speed;
 	if (!self->streaming) {
-		mpv_set_property(self->mpv, "speed", MPV_FORMAT_DOUBLE, &self->speed);
+		double applied = MIN(speed, VIDEO_VIEW_PLUGIN_SCAN_SPEED);
+		mpv_set_property(self->mpv, "speed", MPV_FORMAT_DOUBLE, &applied);
+		video_view_plugin_speed_scan(self);
+	}
+}
+
+static gboolean video_view_plugin_scan_callback(void* id) {
+	VideoViewPlugin* self = g_tree_lookup(players, id);
+	if (!self) {
+		return G_SOURCE_REMOVE;
+	}
+	const gint64 now = g_get_monotonic_time();
+	if (self->state > 2) {
+		double duration = 0;
+		mpv_get_property(self->mpv, "duration/full", MPV_FORMAT_DOUBLE, &duration);
+		self->scanPosition += self->scanSpeed * (double)(now - self->scanTime) / G_USEC_PER_SEC;
+		if (self->scanPosition <= 0 || self->scanPosition >= duration) {
+			// resume normal playback at the boundary, so we get finished event at the end
+			self->scanPosition = CLAMP(self->scanPosition, 0, duration);
+			video_view_plugin_just_seek_to(self, (int64_t)(self->scanPosition * 1000), true, false);
+			self->scanTimer = 0;
+			video_view_plugin_set_scan_speed(self, 0);
+			g_autoptr(FlValue) evt = fl_value_new_map();
+			fl_value_set_string_take(evt, "event", fl_value_new_string("scanEnd"));
+			fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+			return G_SOURCE_REMOVE;
+		}
+		if (!self->scanSeeking) {
+			double pos;
+			mpv_get_property(self->mpv, "time-pos/full", MPV_FORMAT_DOUBLE, &pos);
+			// keyframe seeks may land beyond the target, skip until the scan catches up
+			if (self->scanSpeed > 0 ? self->scanPosition > pos : self->scanPosition < pos) {
+				video_view_plugin_just_seek_to(self, (int64_t)(self->scanPosition * 1000), true, false);
+				self->scanSeeking = true;
+			}
+		}
+	}
+	self->scanTime = now;
+	return G_SOURCE_CONTINUE;
+}
+
+static void video_view_plugin_set_scan_speed(VideoViewPlugin* self, double speed) {
+	if (self->state < 2 || self->streaming) {
+		speed = 0;
+	}
+	if (speed != 0 && self->scanSpeed == 0) {
+		// only keyframes are decoded while scanning, and audio is silent since mpv is paused
+		video_view_plugin_step_clear(self);
+		self->scanPosition = (double)video_view_plugin_get_pos(self) / 1000;
+		self->scanTime = g_get_monotonic_time();
+		video_view_plugin_set_pause(self, TRUE);
+		self->scanTimer = g_timeout_add(VIDEO_VIEW_PLUGIN_SCAN_INTERVAL, video_view_plugin_scan_callback, (void*)self->id);
+	} else if (speed == 0 && self->scanSpeed != 0) {
+		self->speedScanning = false;
+		if (self->scanTimer) {
+			g_source_remove(self->scanTimer);
+			self->scanTimer = 0;
+		}
+		self->scanSeeking = false;
+		if (self->state > 2) {
+			video_view_plugin_set_pause(self, FALSE);
+		}
+	}
+	self->scanSpeed = speed;
+}
+
+static gboolean video_view_plugin_live_callback(void* id) {
+	VideoViewPlugin* self = g_tree_lookup(players, id);
+	if (!self) {
+		return G_SOURCE_REMOVE;
+	}
+	double cacheTime;
+	double pos;
+	gboolean buffering = FALSE;
+	mpv_get_property(self->mpv, "paused-for-cache", MPV_FORMAT_FLAG, &buffering);
+	if (self->state > 1 && !mpv_get_property(self->mpv, "demuxer-cache-time", MPV_FORMAT_DOUBLE, &cacheTime) && !mpv_get_property(self->mpv, "time-pos/full", MPV_FORMAT_DOUBLE, &pos)) {
+		// the newest demuxed timestamp is the closest thing to the live edge we can measure
+		const int64_t latency = MAX((int64_t)((cacheTime - pos) * 1000), 0);
+		double speed = 1;
+		if (self->timeShift > 0) {
+			// keep enough back buffer for the window with the measured stream rate
+			double rate = 0;
+			mpv_node state;
+			if (!mpv_get_property(self->mpv, "demuxer-cache-state", MPV_FORMAT_NODE, &state)) {
+				const mpv_node* bytes = video_view_plugin_node_get(&state, "fw-bytes", MPV_FORMAT_INT64);
+				const mpv_node* duration = video_view_plugin_node_get(&state, "cache-duration", MPV_FORMAT_DOUBLE);
+				if (bytes && duration && duration->u.double_ > 1) {
+					rate = (double)bytes->u.int64 / duration->u.double_;
+				}
+				mpv_free_node_contents(&state);
+			}
+			if (rate > 0) {
+				const int64_t bytes = MIN((int64_t)(rate * self->timeShift / 1000 * 1.25), VIDEO_VIEW_PLUGIN_TIME_SHIFT_MAX_BYTES);
+				if (bytes > self->timeShiftBytes * 1.1 || bytes < self->timeShiftBytes * 0.9) {
+					video_view_plugin_set_back_bytes(self, bytes);
+				}
+			}
+		}
+		if (self->liveJumping) {
+			// positions are stale until the jump lands, another jump would stack on it
+			speed = self->liveSpeed;
+		} else if (self->targetLatency > 0 && self->state > 2 && !buffering && !self->timeShifted) {
+			const int64_t diff = latency - self->targetLatency;
+			const int64_t tolerance = MAX(self->targetLatency / 10, 100);
+			if (diff > VIDEO_VIEW_PLUGIN_LIVE_JUMP) {
+				gchar* t = g_strdup_printf("%lf", (double)diff / 1000);
+				const gchar* cmd[] = { "seek", t, "relative+exact", NULL };
+				self->liveJumping = mpv_command(self->mpv, cmd) == MPV_ERROR_SUCCESS;
+				g_free(t);
+			} else if (diff > tolerance || diff < -tolerance) {
+				speed = 1 + CLAMP((double)diff / 10000, -VIDEO_VIEW_PLUGIN_LIVE_MAX_RATE, VIDEO_VIEW_PLUGIN_LIVE_MAX_RATE);
+			}
+		}
+		if (speed != self->liveSpeed) {
+			self->liveSpeed = speed;
+			mpv_set_property(self->mpv, "speed", MPV_FORMAT_DOUBLE, &speed);
+		}
+		g_autoptr(FlValue) evt = fl_value_new_map();
+		fl_value_set_string_take(evt, "event", fl_value_new_string("latency"));
+		fl_value_set_string_take(evt, "value", fl_value_new_int(latency));
+		fl_value_set_string_take(evt, "speed", fl_value_new_float(speed));
+		fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+	}
+	return G_SOURCE_CONTINUE;
+}
+
+static void video_view_plugin_set_target_latency(VideoViewPlugin* self, const int64_t latency) {
+	self->targetLatency = latency;
+}
+
+static void video_view_plugin_set_time_shift(VideoViewPlugin* self, const int64_t timeShift) {
+	self->timeShift = timeShift;
+	if (self->streaming) {
+		video_view_plugin_set_back_bytes(self, timeShift > 0 ? MIN(timeShift / 1000 * VIDEO_VIEW_PLUGIN_TIME_SHIFT_RATE, VIDEO_VIEW_PLUGIN_TIME_SHIFT_MAX_BYTES) : 0);
+		if (timeShift <= 0) {
+			self->timeShifted = false;
+		}
 	}
 }
 
 static void video_view_plugin_set_volume(VideoViewPlugin* self, const double volume) {
 	self->volume = volume * 100;
 	mpv_set_property(self->mpv, "volume", MPV_FORMAT_DOUBLE, &self->volume);
+	video_view_plugin_update_audio(self);
+}
+
+static void video_view_plugin_set_skip_muted_audio(VideoViewPlugin* self, const bool enable) {
+	self->skipMutedAudio = enable;
+	video_view_plugin_update_audio(self);
+}
+
+// height of the next rendition below the selected one, 0 if there is none
+static uint16_t video_view_plugin_lower_rendition(VideoViewPlugin* self) {
+	const VideoViewPluginVideoTrack* track = video_view_plugin_get_video_track(self);
+	const uint16_t current = track ? track->height : 0;
+	uint16_t height = 0;
+	for (uint32_t i = 0; i < self->videoTracks->len; i++) {
+		const VideoViewPluginVideoTrack* data = &g_array_index(self->videoTracks, VideoViewPluginVideoTrack, i);
+		if (data->height < current && data->height > height) {
+			height = data->height;
+		}
+	}
+	return height;
+}
+
+// moves to a step of the quality ladder, changes of steps in between are applied as well
+static void video_view_plugin_apply_quality(VideoViewPlugin* self, const uint8_t quality) {
+	const uint8_t previous = self->quality;
+	if (quality == previous) {
+		return;
+	}
+	self->quality = quality;
+	bool reload = false;
+	for (guint i = 0; i < G_N_ELEMENTS(qualityOptions); i++) {
+		const VideoViewPluginQualityOption* option = &qualityOptions[i];
+		if ((quality >= option->step) != (previous >= option->step)) {
+			const gchar* value = quality >= option->step ? option->value : self->qualityDefaults[i];
+			if (value) {
+				mpv_set_property_string(self->mpv, option->name, value);
+			}
+			reload |= option->step == 4;
+		}
+	}
+	const bool showing = self->state > 1 && !self->videoDropped;
+	if ((quality >= 2) != (previous >= 2) && self->state > 0 && !self->videoDropped) {
+		int64_t width, height;
+		video_view_plugin_update_render_size(self, &width, &height);
+		fl_texture_registrar_mark_texture_frame_available(textureRegistrar, FL_TEXTURE(self));
+	}
+	if ((quality >= 3) != (previous >= 3)) {
+		self->qualityHeight = quality >= 3 ? video_view_plugin_lower_rendition(self) : 0;
+		if (showing) {
+			video_view_plugin_set_max_size(self);
+			// the decoder is reinitialized by the switch anyway
+			reload = false;
+		}
+	}
+	if (reload && showing) {
+		video_view_plugin_reload_decoder(self);
+	}
+}
+
+static int64_t video_view_plugin_get_drops(const VideoViewPlugin* self) {
+	int64_t decoder = 0;
+	int64_t output = 0;
+	mpv_get_property(self->mpv, "decoder-frame-drop-count", MPV_FORMAT_INT64, &decoder);
+	mpv_get_property(self->mpv, "frame-drop-count", MPV_FORMAT_INT64, &output);
+	return decoder + output;
+}
+
+// steps down as soon as frames are dropped or populate takes most of the frame time, and back up after several
+// checks with plenty of headroom, the gap between both thresholds keeps it from oscillating
+static gboolean video_view_plugin_quality_callback(void* id) {
+	VideoViewPlugin* self = g_tree_lookup(players, id);
+	if (!self) {
+		return G_SOURCE_REMOVE;
+	}
+	const uint32_t count = self->populateCount;
+	const uint32_t frames = MIN(count - self->qualityFrames, VIDEO_VIEW_PLUGIN_STATS_SAMPLES);
+	const int64_t drops = video_view_plugin_get_drops(self);
+	const int64_t dropped = MAX(drops - self->qualityDrops, 0);
+	self->qualityFrames = count;
+	self->qualityDrops = drops;
+	double fps = 0;
+	mpv_get_property(self->mpv, "estimated-vf-fps", MPV_FORMAT_DOUBLE, &fps);
+	if (self->state < 3 || self->appliedVisibility > 0 || self->videoDropped || self->seeking || video_view_plugin_is_stepping(self) || fps <= 0 || frames == 0) {
+		self->qualityCalm = 0;
+		return G_SOURCE_CONTINUE;
+	}
+	if (self->qualitySettle > 0) {
+		self->qualitySettle--;
+		return G_SOURCE_CONTINUE;
+	}
+	uint64_t sum = 0;
+	for (uint32_t i = 1; i <= frames; i++) {
+		sum += self->populateTimes[(count - i) % VIDEO_VIEW_PLUGIN_STATS_SAMPLES];
+	}
+	const double cost = (double)sum / frames;
+	// the output of the filter chain already reflects the frame-rate cap
+	const double frameTime = G_USEC_PER_SEC / (fps * self->speed);
+	uint8_t quality = self->quality;
+	if (dropped >= VIDEO_VIEW_PLUGIN_QUALITY_DROPS || cost > frameTime * VIDEO_VIEW_PLUGIN_QUALITY_LOAD) {
+		self->qualityCalm = 0;
+		if (quality < 4) {
+			quality++;
+			if (quality == 3 && video_view_plugin_lower_rendition(self) == 0) {
+				quality++;
+			}
+		}
+	} else if (dropped == 0 && cost < frameTime * VIDEO_VIEW_PLUGIN_QUALITY_HEADROOM && quality > 0) {
+		if (++self->qualityCalm >= VIDEO_VIEW_PLUGIN_QUALITY_CALM) {
+			self->qualityCalm = 0;
+			quality--;
+			if (quality == 3 && self->qualityHeight == 0) {
+				quality--;
+			}
+		}
+	} else {
+		self->qualityCalm = 0;
+	}
+	if (quality != self->quality) {
+		video_view_plugin_apply_quality(self, quality);
+		self->qualitySettle = VIDEO_VIEW_PLUGIN_QUALITY_SETTLE;
+		g_autoptr(FlValue) evt = fl_value_new_map();
+		fl_value_set_string_take(evt, "event", fl_value_new_string("quality"));
+		fl_value_set_string_take(evt, "value", fl_value_new_int(quality));
+		fl_value_set_string_take(evt, "cost", fl_value_new_int((int64_t)cost));
+		fl_value_set_string_take(evt, "dropped", fl_value_new_int(dropped));
+		fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+	}
+	return G_SOURCE_CONTINUE;
+}
+
+static void video_view_plugin_set_adaptive_quality(VideoViewPlugin* self, const bool enable) {
+	if (enable == self->adaptiveQuality) {
+		return;
+	}
+	self->adaptiveQuality = enable;
+	self->qualityCalm = self->qualitySettle = 0;
+	if (enable) {
+		self->qualityFrames = self->populateCount;
+		self->qualityDrops = video_view_plugin_get_drops(self);
+		self->qualityTimer = g_timeout_add(VIDEO_VIEW_PLUGIN_QUALITY_INTERVAL, video_view_plugin_quality_callback, (void*)self->id);
+	} else {
+		g_source_remove(self->qualityTimer);
+		self->qualityTimer = 0;
+		if (self->quality > 0) {
+			video_view_plugin_apply_quality(self, 0);
+			g_autoptr(FlValue) evt = fl_value_new_map();
+			fl_value_set_string_take(evt, "event", fl_value_new_string("quality"));
+			fl_value_set_string_take(evt, "value", fl_value_new_int(0));
+			fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+		}
+	}
 }
 
 static void video_view_plugin_set_looping(VideoViewPlugin* self, const bool looping) {
@@ -735,6 +2596,80 @@ static void video_view_plugin_set_max_bitrate(VideoViewPlugin* self, const uint3
 	}
 }
 
+// estimates the bandwidth from the input rate of the demuxer while it's reading, then switches up only with enough
+// buffer to refetch from the position, and down once the buffer runs low or the rendition can't be sustained at all.
+// raw-input-rate is averaged by mpv over roughly the last second, so it's only sampled if the demuxer was reading at
+// the previous check too, otherwise the idle part of the window or a burst of cached data skews it. Samples are sparse
+// once the buffer is full, and a single burst is clamped to twice the slow estimate so it can't switch up alone.
+static gboolean video_view_plugin_abr_callback(void* id) {
+	VideoViewPlugin* self = g_tree_lookup(players, id);
+	if (!self) {
+		return G_SOURCE_REMOVE;
+	}
+	mpv_node state;
+	if (self->state < 2 || self->videoDropped || mpv_get_property(self->mpv, "demuxer-cache-state", MPV_FORMAT_NODE, &state) < 0) {
+		return G_SOURCE_CONTINUE;
+	}
+	const mpv_node* rate = video_view_plugin_node_get(&state, "raw-input-rate", MPV_FORMAT_INT64);
+	const mpv_node* idle = video_view_plugin_node_get(&state, "idle", MPV_FORMAT_FLAG);
+	const mpv_node* duration = video_view_plugin_node_get(&state, "cache-duration", MPV_FORMAT_DOUBLE);
+	const double buffer = duration ? duration->u.double_ : 0;
+	const bool reading = !(idle && idle->u.flag);
+	if (rate && rate->u.int64 > 0 && reading && self->abrReading) {
+		const double sample = self->abrSlow > 0 ? MIN(rate->u.int64 * 8.0, self->abrSlow * VIDEO_VIEW_PLUGIN_ABR_MAX_JUMP) : rate->u.int64 * 8.0;
+		self->abrFast = self->abrFast > 0 ? self->abrFast * 0.5 + sample * 0.5 : sample;
+		self->abrSlow = self->abrSlow > 0 ? self->abrSlow * 0.9 + sample * 0.1 : sample;
+	}
+	self->abrReading = reading;
+	mpv_free_node_contents(&state);
+	const VideoViewPluginVideoTrack* current = video_view_plugin_get_video_track(self);
+	if (self->state < 3 || self->seeking || self->abrFast <= 0 || !current || current->bitrate == 0) {
+		return G_SOURCE_CONTINUE;
+	}
+	const double bandwidth = MIN(self->abrFast, self->abrSlow);
+	const uint32_t target = video_view_plugin_abr_choose(self, bandwidth * VIDEO_VIEW_PLUGIN_ABR_SAFETY);
+	const gint64 now = g_get_monotonic_time();
+	const bool up = target > current->bitrate && buffer >= VIDEO_VIEW_PLUGIN_ABR_UP_BUFFER && now - self->abrSwitched >= VIDEO_VIEW_PLUGIN_ABR_HOLD;
+	const bool down = target < current->bitrate && (buffer < VIDEO_VIEW_PLUGIN_ABR_DOWN_BUFFER || current->bitrate > bandwidth);
+	if (up || down) {
+		const uint32_t from = current->bitrate;
+		self->abrBitRate = target;
+		self->abrSwitched = now;
+		video_view_plugin_set_max_size(self);
+		current = video_view_plugin_get_video_track(self);
+		if (current && current->bitrate != from) {
+			g_autoptr(FlValue) evt = fl_value_new_map();
+			fl_value_set_string_take(evt, "event", fl_value_new_string("rendition"));
+			fl_value_set_string_take(evt, "width", fl_value_new_int(current->width));
+			fl_value_set_string_take(evt, "height", fl_value_new_int(current->height));
+			fl_value_set_string_take(evt, "bitRate", fl_value_new_int(current->bitrate));
+			fl_value_set_string_take(evt, "bandwidth", fl_value_new_int((int64_t)bandwidth));
+			fl_value_set_string_take(evt, "buffer", fl_value_new_int((int64_t)(buffer * 1000)));
+			fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+		}
+	}
+	return G_SOURCE_CONTINUE;
+}
+
+static void video_view_plugin_set_adaptive_bit_rate(VideoViewPlugin* self, const bool enable) {
+	if (enable == self->adaptiveBitRate) {
+		return;
+	}
+	self->adaptiveBitRate = enable;
+	if (enable) {
+		self->abrTimer = g_timeout_add(VIDEO_VIEW_PLUGIN_ABR_INTERVAL, video_view_plugin_abr_callback, (void*)self->id);
+	} else {
+		g_source_remove(self->abrTimer);
+		self->abrTimer = 0;
+		if (self->abrBitRate > 0) {
+			self->abrBitRate = 0;
+			if (self->state > 1) {
+				video_view_plugin_set_max_size(self);
+			}
+		}
+	}
+}
+
 static void video_view_plugin_set_keep_screen_on(VideoViewPlugin* self, const bool enable) {
 	if (self->keepScreenOn != enable) {
 		self->keepScreenOn = enable;
@@ -744,6 +2679,53 @@ static void video_view_plugin_set_keep_screen_on(VideoViewPlugin* self, const bo
 	}
 }
 
+static void video_view_plugin_update_visibility(VideoViewPlugin* self) {
+	const uint8_t visibility = windowHidden ? MAX(self->visibility, 1) : self->visibility;
+	if (visibility != self->appliedVisibility) {
+		const uint8_t previous = self->appliedVisibility;
+		g_mutex_lock(&mutex);
+		self->appliedVisibility = visibility;
+		g_mutex_unlock(&mutex);
+		if (visibility > 0) {
+			video_view_plugin_step_clear(self);
+		}
+		if (self->state > 1 && (visibility > 1) != (previous > 1)) {
+			video_view_plugin_select_video(self);
+			video_view_plugin_update_audio(self);
+		} else if (visibility == 1 && self->skipReload && !self->videoDropped) {
+			// the frame-rate cap changed the decoder options while the player was on screen
+			video_view_plugin_reload_decoder(self);
+		}
+		if (visibility > 0) {
+			self->skipReload = false;
+		}
+		// populate releases the render target of audio only players, or renders the latest frame of players shown again,
+		// players back from audio only are rendered when the reselected video is decoded
+		if (self->state > 0 && (visibility > 1 || (visibility == 0 && previous == 1))) {
+			fl_texture_registrar_mark_texture_frame_available(textureRegistrar, FL_TEXTURE(self));
+		}
+	}
+}
+
+static void video_view_plugin_set_priority(VideoViewPlugin* self, const uint8_t priority) {
+	self->priority = MIN(priority, 2);
+	video_view_plugin_apply_frame_rate(self);
+	video_view_plugin_apply_readahead(self);
+	if (self->state == 1 || self->state == 3) {
+		video_view_plugin_proxy_set_weight(self->id, priorities[self->priority].proxyWeight);
+	}
+}
+
+static void video_view_plugin_set_max_frame_rate(VideoViewPlugin* self, const double frameRate) {
+	self->maxFrameRate = MAX(frameRate, 0);
+	video_view_plugin_apply_frame_rate(self);
+}
+
+static void video_view_plugin_set_visibility(VideoViewPlugin* self, const uint8_t visibility) {
+	self->visibility = MIN(visibility, 2);
+	video_view_plugin_update_visibility(self);
+}
+
 static void video_view_plugin_overrideTrack(VideoViewPlugin* self, const uint8_t typeId, uint16_t trackId, const bool enabled) {
 	if (self->state > 1) {
 		gchar* p;
@@ -759,7 +2741,9 @@ static void video_view_plugin_overrideTrack(VideoViewPlugin* self, const uint8_t
 			self->overrideAudio = trackId;
 		}
 		if (trackId) {
-			mpv_set_property_string(self->mpv, typeId ? "sid" : "aid", p);
+			if (typeId || !self->audioDropped) {
+				mpv_set_property_string(self->mpv, typeId ? "sid" : "aid", p);
+			}
 		} else {
 			video_view_plugin_set_default_track(self, typeId);
 		}
@@ -768,6 +2752,7 @@ static void video_view_plugin_overrideTrack(VideoViewPlugin* self, const uint8_t
 }
 
 static gboolean video_view_plugin_event_callback(void* id) {
+	const int64_t trace = video_view_plugin_trace_begin("event", (int64_t)id);
 	VideoViewPlugin* self = g_tree_lookup(players, id);
 	while (self) {
 		const mpv_event* event = mpv_wait_event(self->mpv, 0);
@@ -778,16 +2763,17 @@ static gboolean video_view_plugin_event_callback(void* id) {
 				const mpv_event_property* detail = (mpv_event_property*)event->data;
 				if (detail->data) {
 					if (g_str_equal(detail->name, "time-pos/full")) {
-						if (self->state > 0 && !self->streaming) {
-							if (self->state > 1) {
+						if (self->state > 0 && (!self->streaming || self->timeShift > 0)) {
+							if (self->state > 1 && !video_view_plugin_is_stepping(self)) {
 								video_view_plugin_send_time(self, (int64_t)(*(double*)detail->data * 1000));
 							}
 						}
 					} else if (g_str_equal(detail->name, "demuxer-cache-time")) {
-						if (self->state > 0 && !self->streaming && (self->networking || self->state == 1)) {
+						if (self->state > 0 && (!self->streaming || self->timeShift > 0) && (self->networking || self->state == 1)) {
 							self->bufferPosition = (int64_t)(*(double*)detail->data * 1000);
 							if (self->state > 1) {
-								video_view_plugin_send_buffer(self, video_view_plugin_get_pos(self));
+								// live streams report the seekable window instead
+								video_view_plugin_send_buffer(self, self->streaming ? video_view_plugin_time_shift_start(self) : video_view_plugin_get_pos(self));
 							}
 						}
 					} else if (g_str_equal(detail->name, "paused-for-cache")) {
@@ -817,34 +2803,43 @@ static gboolean video_view_plugin_event_callback(void* id) {
 			} else if (event->event_id == MPV_EVENT_END_FILE) {
 				mpv_event_end_file* detail = (mpv_event_end_file*)event->data;
 				if (detail->reason == MPV_END_FILE_REASON_ERROR) {
-					video_view_plugin_close(self);
-					g_autoptr(FlValue) evt = fl_value_new_map();
-					fl_value_set_string_take(evt, "event", fl_value_new_string("error"));
-					fl_value_set_string_take(evt, "value", fl_value_new_string(mpv_error_string(detail->error)));
-					fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+					video_view_plugin_close(self);
+					video_view_plugin_send_error(self, mpv_error_string(detail->error));
 				}
 			} else if (event->event_id == MPV_EVENT_VIDEO_RECONFIG) {
-				if (self->state > 0) {
+				// the video size is kept while audio only, so the layout doesn't change
+				if (self->state > 0 && !self->videoDropped) {
 					const bool hasVideo = self->width > 0 && self->height > 0;
-					int64_t tmp;
-					mpv_get_property(self->mpv, "dwidth", MPV_FORMAT_INT64, &tmp);
-					self->width = (GLsizei)tmp;
-					mpv_get_property(self->mpv, "dheight", MPV_FORMAT_INT64, &tmp);
-					self->height = (GLsizei)tmp;
+					int64_t width = 0;
+					int64_t height = 0;
+					video_view_plugin_update_render_size(self, &width, &height);
 					const bool newHasVideo = self->width > 0 && self->height > 0;
 					if (self->state > 2 && self->keepScreenOn && hasVideo != newHasVideo) {
 						video_view_plugin_set_inhibit(self, newHasVideo);
 					}
 					g_autoptr(FlValue) evt = fl_value_new_map();
 					fl_value_set_string_take(evt, "event", fl_value_new_string("videoSize"));
-					fl_value_set_string_take(evt, "width", fl_value_new_float(self->width));
-					fl_value_set_string_take(evt, "height", fl_value_new_float(self->height));
+					fl_value_set_string_take(evt, "width", fl_value_new_float(width));
+					fl_value_set_string_take(evt, "height", fl_value_new_float(height));
 					fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
 				}
 			} else if (event->event_id == MPV_EVENT_PLAYBACK_RESTART) {
-				if (self->state == 1) { // file loaded
+				self->liveJumping = false;
+				if (self->scanSeeking) {
+					self->scanSeeking = false;
+				} else if (video_view_plugin_step_seeked(self)) {
+					// the first frame of a backward fill may arrive before this event
+					fl_texture_registrar_mark_texture_frame_available(textureRegistrar, FL_TEXTURE(self));
+				} else if (self->state == 1) { // file loaded
 					self->seeking = false;
+					if (self->openStart) {
+						self->openRestart = g_get_monotonic_time() - self->openStart;
+					}
 					video_view_plugin_loaded(self);
+					if (self->openStart) {
+						self->openLoaded = g_get_monotonic_time() - self->openStart;
+						video_view_plugin_send_open_timing(self);
+					}
 				} else if (self->state > 1 && self->seeking) {
 					self->seeking = false;
 					g_autoptr(FlValue) evt = fl_value_new_map();
@@ -852,6 +2847,9 @@ static gboolean video_view_plugin_event_callback(void* id) {
 					fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
 				}
 			} else if (event->event_id == MPV_EVENT_FILE_LOADED) {
+				if (self->openStart) {
+					self->openFileLoaded = g_get_monotonic_time() - self->openStart;
+				}
 				// 1) duration unknown or zero is a hint but not decisive
 				double duration = 0.0;
 				const int dur_rc = mpv_get_property(self->mpv, "duration/full", MPV_FORMAT_DOUBLE, &duration);
@@ -886,8 +2884,12 @@ static gboolean video_view_plugin_event_callback(void* id) {
 				double speed = 1;
 				if (self->streaming) {
 					mpv_set_property_string(self->mpv, "profile", "low-latency");
+					if (self->timeShift > 0) {
+						video_view_plugin_set_time_shift(self, self->timeShift);
+					}
+					self->liveTimer = g_timeout_add(VIDEO_VIEW_PLUGIN_LIVE_INTERVAL, video_view_plugin_live_callback, (void*)self->id);
 				} else {
-					speed = self->speed;
+					speed = MIN(self->speed, VIDEO_VIEW_PLUGIN_SCAN_SPEED);
 					if (self->position > 0) {
 						video_view_plugin_just_seek_to(self, self->position, true, true);
 						self->position = 0;
@@ -898,6 +2900,7 @@ static gboolean video_view_plugin_event_callback(void* id) {
 			}
 		}
 	}
+	video_view_plugin_trace_end("event", (int64_t)id, trace, NULL);
 	return FALSE;
 }
 
@@ -930,9 +2933,328 @@ static void video_view_plugin_new_texture(VideoViewPlugin* self) {
 	self->fbo.h = self->height;
 }
 
-static gboolean video_view_plugin_texture_populate(FlTextureGL* texture, uint32_t* target, uint32_t* name, uint32_t* width, uint32_t* height, GError** error) {
+static void video_view_plugin_step_command(VideoViewPlugin* self) {
+	const gchar* cmd[] = { "frame-step", NULL };
+	mpv_command(self->mpv, cmd);
+}
+
+static VideoViewPluginStepFrame* video_view_plugin_step_slot(VideoViewPlugin* self, bool* repeated) {
+	VideoViewPluginStepFrame frame = { 0 };
+	mpv_get_property(self->mpv, "time-pos/full", MPV_FORMAT_DOUBLE, &frame.pts);
+	if (self->stepFrames->len > 0) {
+		// the same frame may be captured twice if it arrives later than the seek event
+		VideoViewPluginStepFrame* last = &g_array_index(self->stepFrames, VideoViewPluginStepFrame, self->stepFrames->len - 1);
+		*repeated = last->pts == frame.pts;
+		if (*repeated) {
+			self->stepCapture = false;
+			return last;
+		}
+	}
+	if (self->stepFrames->len >= self->stepCapacity) {
+		// reuse the resources of the oldest frame
+		const VideoViewPluginStepFrame* oldest = &g_array_index(self->stepFrames, VideoViewPluginStepFrame, 0);
+		frame.texture = oldest->texture;
+		frame.buffer = oldest->buffer;
+		g_array_remove_index(self->stepFrames, 0);
+		if (self->stepIndex >= 0) {
+			self->stepIndex--;
+		}
+	}
+	g_array_append_val(self->stepFrames, frame);
+	return &g_array_index(self->stepFrames, VideoViewPluginStepFrame, self->stepFrames->len - 1);
+}
+
+// called after a frame is captured, returns true if more frames are required
+static bool video_view_plugin_step_captured(VideoViewPlugin* self) {
+	self->stepCapture = false;
+	const int32_t last = (int32_t)self->stepFrames->len - 1;
+	if (self->stepFilling) {
+		const double pts = g_array_index(self->stepFrames, VideoViewPluginStepFrame, last).pts;
+		if (pts < self->stepFillEnd - self->stepDuration / 2 && !video_view_plugin_is_eof(self)) {
+			return true;
+		}
+		self->stepFilling = false;
+		self->stepIndex = last;
+		for (int32_t i = last - 1; i >= 0; i--) {
+			if (g_array_index(self->stepFrames, VideoViewPluginStepFrame, i).pts < self->stepWant + self->stepDuration / 2) {
+				break;
+			}
+			self->stepIndex = i;
+		}
+	} else {
+		self->stepIndex = last;
+		if (self->stepRemaining > 0 && --self->stepRemaining > 0 && !video_view_plugin_is_eof(self)) {
+			return true;
+		}
+		self->stepRemaining = 0;
+	}
+	return false;
+}
+
+static void video_view_plugin_step_run(VideoViewPlugin* self, const int32_t frames) {
+	const int32_t count = (int32_t)self->stepFrames->len;
+	const int32_t current = self->stepIndex < 0 ? count - 1 : self->stepIndex;
+	const int32_t target = current + frames;
+	if (count == 0) {
+		self->stepCapacity = (uint32_t)CLAMP(VIDEO_VIEW_PLUGIN_STEP_CACHE_BYTES / ((size_t)self->width * self->height * 4), 2, VIDEO_VIEW_PLUGIN_STEP_CACHE_SIZE);
+	}
+	self->stepRunning = true;
+	if (count > 0 && target >= 0 && target < count) {
+		// shown by the populate running it
+		self->stepIndex = target;
+	} else if (frames > 0) {
+		// mpv always stays at the last cached frame
+		self->stepRemaining = count > 0 ? target - (count - 1) : frames;
+		video_view_plugin_step_command(self);
+	} else {
+		// decode frames before the current one in a single pass, so later backward steps are served from cache
+		if (self->stepDuration <= 0) {
+			double fps = 0;
+			if (mpv_get_property(self->mpv, "container-fps", MPV_FORMAT_DOUBLE, &fps) < 0 || fps <= 0) {
+				mpv_get_property(self->mpv, "estimated-vf-fps", MPV_FORMAT_DOUBLE, &fps);
+			}
+			self->stepDuration = fps > 0 ? 1 / fps : 1.0 / 30;
+		}
+		double base;
+		int32_t back;
+		if (count > 0) {
+			base = g_array_index(self->stepFrames, VideoViewPluginStepFrame, 0).pts;
+			back = -target;
+		} else {
+			mpv_get_property(self->mpv, "time-pos/full", MPV_FORMAT_DOUBLE, &base);
+			back = -frames;
+		}
+		const double span = (self->stepCapacity - 1) * self->stepDuration;
+		self->stepWant = MAX(base - back * self->stepDuration, 0);
+		self->stepFillEnd = MIN(base, self->stepWant + span);
+		video_view_plugin_step_release(self);
+		self->stepRunning = self->stepFilling = true;
+		// a clear requested meanwhile drops this fill on the next frame
+		g_mutex_lock(&mutex);
+		const bool cleared = self->stepClearPending;
+		self->stepSeeking = !cleared;
+		g_mutex_unlock(&mutex);
+		if (!cleared) {
+			video_view_plugin_step_seek(self, MAX(self->stepFillEnd - span, 0));
+		}
+	}
+}
+
+// requests are queued, populate runs them with the cached frames
+static void video_view_plugin_step_frame(VideoViewPlugin* self, const int32_t frames) {
+	if (self->state > 1 && !self->streaming && !self->videoDropped && self->width > 0 && self->height > 0 && frames != 0) {
+		if (self->state > 2) {
+			video_view_plugin_pause(self);
+		}
+		g_mutex_lock(&mutex);
+		if (!self->stepStart) {
+			self->stepStart = g_get_monotonic_time();
+		}
+		self->stepQueued += frames;
+		g_mutex_unlock(&mutex);
+		fl_texture_registrar_mark_texture_frame_available(textureRegistrar, FL_TEXTURE(self));
+	}
+}
+
+// takes the frames requested so far, once the running step is on screen
+static int32_t video_view_plugin_step_take(VideoViewPlugin* self) {
+	int32_t frames = 0;
+	if (!self->stepRunning) {
+		g_mutex_lock(&mutex);
+		frames = self->stepQueued;
+		self->stepQueued = 0;
+		g_mutex_unlock(&mutex);
+	}
+	return frames;
+}
+
+static gboolean video_view_plugin_step_end_callback(void* data) {
+	const VideoViewPluginStepEnd* end = data;
+	VideoViewPlugin* self = g_tree_lookup(players, (void*)end->id);
+	if (self) {
+		g_autoptr(FlValue) evt = fl_value_new_map();
+		fl_value_set_string_take(evt, "event", fl_value_new_string("stepEnd"));
+		fl_value_set_string_take(evt, "position", fl_value_new_int(end->position));
+		fl_value_set_string_take(evt, "latency", fl_value_new_int(end->latency));
+		fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+	}
+	return G_SOURCE_REMOVE;
+}
+
+// called at the end of populate, publishes the cached frames and sends stepEnd once the selected frame is on screen
+static void video_view_plugin_step_finish(VideoViewPlugin* self) {
+	if (!self->stepRunning && self->stepFrames->len == 0) {
+		return;
+	}
+	const bool done = self->stepRunning && !self->stepFilling && !self->stepRemaining && self->stepIndex >= 0;
+	VideoViewPluginStepEnd* end = NULL;
+	bool queued = false;
+	g_mutex_lock(&mutex);
+	// nothing is published after a clear, the frames are released by the next populate
+	if (!self->stepClearPending) {
+		const int32_t count = (int32_t)self->stepFrames->len;
+		self->stepCount = count;
+		self->stepShown = self->stepIndex >= 0 && self->stepIndex + 1 < count ? g_array_index(self->stepFrames, VideoViewPluginStepFrame, self->stepIndex).pts : -1;
+		if (done && self->stepStart) {
+			const gint64 now = g_get_monotonic_time();
+			end = g_new(VideoViewPluginStepEnd, 1);
+			end->id = self->id;
+			end->position = (int64_t)(g_array_index(self->stepFrames, VideoViewPluginStepFrame, self->stepIndex).pts * 1000);
+			end->latency = self->stepLatency = now - self->stepStart;
+			self->stepLatencySum += self->stepLatency;
+			self->stepLatencyCount++;
+			queued = self->stepQueued != 0;
+			self->stepStart = queued ? now : 0;
+		}
+	}
+	g_mutex_unlock(&mutex);
+	if (done) {
+		self->stepRunning = false;
+	}
+	if (end) {
+		// populate may not run in the main thread
+		g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, video_view_plugin_step_end_callback, end, g_free);
+	}
+	if (queued) {
+		fl_texture_registrar_mark_texture_frame_available(textureRegistrar, FL_TEXTURE(self));
+	}
+}
+
+static void video_view_plugin_step_render_egl(VideoViewPlugin* self, const bool capture) {
+	if (!self->stepFbo) {
+		glGenFramebuffers(1, &self->stepFbo);
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, self->stepFbo);
+	if (capture) {
+		bool repeated = false;
+		VideoViewPluginStepFrame* frame = video_view_plugin_step_slot(self, &repeated);
+		if (!frame->texture) {
+			video_view_plugin_gen_texture(self, &frame->texture, false);
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, frame->texture, 0);
+		mpv_opengl_fbo fbo = { (int)self->stepFbo, self->width, self->height, 0 };
+		mpv_render_param params[] = {
+			{ MPV_RENDER_PARAM_OPENGL_FBO, &fbo },
+			{ MPV_RENDER_PARAM_INVALID, NULL }
+		};
+		mpv_render_context_render(self->mpvRenderContext, params);
+		if (!repeated && video_view_plugin_step_captured(self)) {
+			video_view_plugin_step_command(self);
+		}
+	}
+	if (self->stepIndex >= 0) {
+		const VideoViewPluginStepFrame* frame = &g_array_index(self->stepFrames, VideoViewPluginStepFrame, self->stepIndex);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, frame->texture, 0);
+		glBindTexture(GL_TEXTURE_2D, self->mpvTexture);
+		glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, self->width, self->height);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+}
+
+static void video_view_plugin_sw_render(VideoViewPlugin* self, guint8* buffer) {
+	int swSize[] = { self->width, self->height };
+	char swFormat[] = "rgb0";
+	mpv_render_param params[] = {
+		{ MPV_RENDER_PARAM_SW_SIZE, swSize },
+		{ MPV_RENDER_PARAM_SW_FORMAT, swFormat },
+		{ MPV_RENDER_PARAM_SW_STRIDE, &self->swStride },
+		{ MPV_RENDER_PARAM_SW_POINTER, buffer },
+		{ MPV_RENDER_PARAM_INVALID, NULL }
+	};
+	mpv_render_context_render(self->mpvRenderContext, params);
+	for (GLsizei y = 0; y < self->height; y++) {
+		guint8* row = buffer + y * self->swStride;
+		for (GLsizei x = 0; x < self->width; x++) {
+			row[x * 4 + 3] = 0xff;
+		}
+	}
+}
+
+// returns the buffer to upload, or NULL if the texture should stay unchanged
+static const guint8* video_view_plugin_step_render_sw(VideoViewPlugin* self, const bool capture) {
+	if (capture) {
+		bool repeated = false;
+		VideoViewPluginStepFrame* frame = video_view_plugin_step_slot(self, &repeated);
+		if (!frame->buffer) {
+			frame->buffer = g_malloc(self->swStride * self->height);
+		}
+		video_view_plugin_sw_render(self, frame->buffer);
+		if (!repeated && video_view_plugin_step_captured(self)) {
+			video_view_plugin_step_command(self);
+		}
+	}
+	return self->stepIndex >= 0 ? g_array_index(self->stepFrames, VideoViewPluginStepFrame, self->stepIndex).buffer : NULL;
+}
+
+// drops the render target of an audio only player, the texture is kept with the last frame
+static void video_view_plugin_release_render_target(VideoViewPlugin* self) {
+	if (self->eglRendering && (self->fbo.fbo || self->mpvTexture)) {
+		VideoViewPluginEglState flutterState = { 0 };
+		video_view_plugin_capture_egl_state(&flutterState);
+		if (video_view_plugin_make_isolated_egl_current(self)) {
+			video_view_plugin_clear_mpv_gl_resources(self);
+		}
+		video_view_plugin_restore_egl_state(&flutterState, self->eglDisplay);
+	}
+	if (self->swBuffer) {
+		g_free(self->swBuffer);
+		self->swBuffer = NULL;
+		self->swBufferSize = 0;
+	}
+}
+
+static gboolean video_view_plugin_populate(FlTextureGL* texture, uint32_t* target, uint32_t* name, uint32_t* width, uint32_t* height, GError** error) {
 	VideoViewPlugin* self = VIDEO_VIEW_PLUGIN(texture);
+	g_mutex_lock(&mutex);
+	// the main thread may be dropping a frame of the hidden player with the render context, pending releases wait for it
+	const bool dropping = self->dropping;
+	self->rendering = !dropping;
+	const bool stepClear = !dropping && self->stepClearPending;
+	const bool trim = !dropping && self->trimPending && self->texture;
+	if (stepClear) {
+		self->stepClearPending = false;
+	}
+	if (trim) {
+		self->trimPending = false;
+	}
+	g_mutex_unlock(&mutex);
+	if (stepClear) {
+		video_view_plugin_step_release(self);
+	}
+	if ((dropping || self->appliedVisibility > 0 || trim) && self->texture) {
+		// hidden and trimmed players keep showing the last frame without rendering
+		if (!dropping && (self->appliedVisibility > 1 || trim)) {
+			video_view_plugin_release_render_target(self);
+		}
+		*target = GL_TEXTURE_2D;
+		*name = self->texture;
+		*width = self->width;
+		*height = self->height;
+		return TRUE;
+	}
+	if (dropping) {
+		return FALSE;
+	}
+	if (self->openStart && !self->openPopulate) {
+		self->openPopulate = g_get_monotonic_time() - self->openStart;
+	}
 	if (self->state > 0 && self->width > 0 && self->height > 0 && self->mpvRenderContext) {
+		const gint64 populateStart = g_get_monotonic_time();
+		const int32_t frames = video_view_plugin_step_take(self);
+		if (frames) {
+			video_view_plugin_step_run(self, frames);
+		}
+		if ((self->stepFilling || self->stepRemaining) && (mpv_render_context_update(self->mpvRenderContext) & MPV_RENDER_UPDATE_FRAME)) {
+			self->stepCapture = true;
+		}
+		bool capture = false;
+		if (self->stepCapture) {
+			// frames decoded before the seek of a backward fill are not captured
+			g_mutex_lock(&mutex);
+			capture = !self->stepSeeking;
+			g_mutex_unlock(&mutex);
+		}
 		if (self->eglRendering) {
 			if (self->texture == 0 || self->mpvTexture == 0 || self->eglImage == EGL_NO_IMAGE_KHR || self->width != self->fbo.w || self->height != self->fbo.h) {
 				if (!video_view_plugin_init_isolated_egl_context(self)) {
@@ -973,12 +3295,21 @@ static gboolean video_view_plugin_texture_populate(FlTextureGL* texture, uint32_
 			video_view_plugin_capture_egl_state(&flutterState);
 			bool success = false;
 			if (video_view_plugin_make_isolated_egl_current(self)) {
-				glBindFramebuffer(GL_FRAMEBUFFER, self->fbo.fbo);
-				mpv_render_param params[] = {
-					{ MPV_RENDER_PARAM_OPENGL_FBO, &self->fbo },
-					{ MPV_RENDER_PARAM_INVALID, NULL }
-				};
-				mpv_render_context_render(self->mpvRenderContext, params);
+				const gint64 renderStart = g_get_monotonic_time();
+				const int64_t trace = video_view_plugin_trace_begin("render", self->id);
+				video_view_plugin_step_delete_stale(self);
+				if (self->stepFrames->len > 0 || self->stepCapture) {
+					video_view_plugin_step_render_egl(self, capture);
+				} else {
+					glBindFramebuffer(GL_FRAMEBUFFER, self->fbo.fbo);
+					mpv_render_param params[] = {
+						{ MPV_RENDER_PARAM_OPENGL_FBO, &self->fbo },
+						{ MPV_RENDER_PARAM_INVALID, NULL }
+					};
+					mpv_render_context_render(self->mpvRenderContext, params);
+				}
+				video_view_plugin_trace_end("render", self->id, trace, NULL);
+				video_view_plugin_add_time(self->renderTimes, &self->renderCount, renderStart);
 				glBindFramebuffer(GL_FRAMEBUFFER, 0);
 				glFlush();
 				success = true;
@@ -993,7 +3324,8 @@ static gboolean video_view_plugin_texture_populate(FlTextureGL* texture, uint32_
 			if (requiredSize == 0) {
 				return FALSE;
 			}
-			if (requiredSize > self->swBufferSize) {
+			// the buffer shrinks as well when the video gets much smaller
+			if (requiredSize > self->swBufferSize || requiredSize < self->swBufferSize / 2) {
 				guint8* buffer = g_realloc(self->swBuffer, requiredSize);
 				if (!buffer) {
 					return FALSE;
@@ -1007,29 +3339,36 @@ static gboolean video_view_plugin_texture_populate(FlTextureGL* texture, uint32_
 				video_view_plugin_new_texture(self);
 			}
 
-			int swSize[] = { self->width, self->height };
-			char swFormat[] = "rgb0";
-			mpv_render_param params[] = {
-				{ MPV_RENDER_PARAM_SW_SIZE, swSize },
-				{ MPV_RENDER_PARAM_SW_FORMAT, swFormat },
-				{ MPV_RENDER_PARAM_SW_STRIDE, &self->swStride },
-				{ MPV_RENDER_PARAM_SW_POINTER, self->swBuffer },
-				{ MPV_RENDER_PARAM_INVALID, NULL }
-			};
-			mpv_render_context_render(self->mpvRenderContext, params);
-			for (GLsizei y = 0; y < self->height; y++) {
-				guint8* row = self->swBuffer + y * self->swStride;
-				for (GLsizei x = 0; x < self->width; x++) {
-					row[x * 4 + 3] = 0xff;
-				}
+			const guint8* buffer = self->swBuffer;
+			const gint64 renderStart = g_get_monotonic_time();
+			int64_t trace = video_view_plugin_trace_begin("render", self->id);
+			if (self->stepFrames->len > 0 || self->stepCapture) {
+				buffer = video_view_plugin_step_render_sw(self, capture);
+			} else {
+				video_view_plugin_sw_render(self, self->swBuffer);
 			}
-			GLint oldUnpackAlignment = 4;
-			glGetIntegerv(GL_UNPACK_ALIGNMENT, &oldUnpackAlignment);
-			glBindTexture(GL_TEXTURE_2D, self->texture);
-			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, self->width, self->height, GL_RGBA, GL_UNSIGNED_BYTE, self->swBuffer);
-			glPixelStorei(GL_UNPACK_ALIGNMENT, oldUnpackAlignment);
-			glBindTexture(GL_TEXTURE_2D, 0);
+			video_view_plugin_trace_end("render", self->id, trace, NULL);
+			video_view_plugin_add_time(self->renderTimes, &self->renderCount, renderStart);
+			if (buffer) {
+				const gint64 uploadStart = g_get_monotonic_time();
+				trace = video_view_plugin_trace_begin("upload", self->id);
+				GLint oldUnpackAlignment = 4;
+				glGetIntegerv(GL_UNPACK_ALIGNMENT, &oldUnpackAlignment);
+				glBindTexture(GL_TEXTURE_2D, self->texture);
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, self->width, self->height, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
+				glPixelStorei(GL_UNPACK_ALIGNMENT, oldUnpackAlignment);
+				glBindTexture(GL_TEXTURE_2D, 0);
+				video_view_plugin_trace_end("upload", self->id, trace, NULL);
+				video_view_plugin_add_time(self->uploadTimes, &self->uploadCount, uploadStart);
+			}
+		}
+		video_view_plugin_step_finish(self);
+		video_view_plugin_add_time(self->populateTimes, &self->populateCount, populateStart);
+		if (self->openStart && !self->openFrame) {
+			// populate may not run in the main thread
+			self->openFrame = g_get_monotonic_time() - self->openStart;
+			g_idle_add(video_view_plugin_open_timing_callback, (void*)self->id);
 		}
 		*target = GL_TEXTURE_2D;
 		*name = self->texture;
@@ -1040,6 +3379,17 @@ static gboolean video_view_plugin_texture_populate(FlTextureGL* texture, uint32_
 	return FALSE;
 }
 
+static gboolean video_view_plugin_texture_populate(FlTextureGL* texture, uint32_t* target, uint32_t* name, uint32_t* width, uint32_t* height, GError** error) {
+	const int64_t id = VIDEO_VIEW_PLUGIN(texture)->id;
+	const int64_t trace = video_view_plugin_trace_begin("populate", id);
+	const gboolean result = video_view_plugin_populate(texture, target, name, width, height, error);
+	g_mutex_lock(&mutex);
+	VIDEO_VIEW_PLUGIN(texture)->rendering = false;
+	g_mutex_unlock(&mutex);
+	video_view_plugin_trace_end("populate", id, trace, NULL);
+	return result;
+}
+
 static void video_view_plugin_class_init(VideoViewPluginClass* klass) {
 	FL_TEXTURE_GL_CLASS(klass)->populate = video_view_plugin_texture_populate;
 }
@@ -1059,6 +3409,24 @@ static void video_view_plugin_init(VideoViewPlugin* self) {
 	self->swStride = 0;
 	self->speed = 1;
 	self->state = 0;
+	self->visibility = self->appliedVisibility = 0;
+	self->priority = 0;
+	self->dropSource = 0;
+	self->dropping = self->rendering = false;
+	self->skipReload = self->frameRateFiltered = false;
+	self->maxFrameRate = 0;
+	self->framesSkipped = false;
+	self->qualityTimer = 0;
+	self->qualityFrames = self->qualityHeight = 0;
+	self->qualityDrops = 0;
+	self->quality = self->qualityCalm = self->qualitySettle = 0;
+	self->adaptiveQuality = false;
+	self->abrTimer = 0;
+	self->abrFast = self->abrSlow = 0;
+	self->abrReading = false;
+	self->abrSwitched = 0;
+	self->abrBitRate = 0;
+	self->adaptiveBitRate = false;
 	self->position = self->bufferPosition = 0;
 	self->source = NULL;
 	self->preferredAudioLanguage = NULL;
@@ -1066,6 +3434,42 @@ static void video_view_plugin_init(VideoViewPlugin* self) {
 	self->looping = self->streaming = self->networking = self->seeking = self->keepScreenOn = self->eglRendering = false;
 	self->mpvRenderContext = NULL;
 	self->inhibit_cookie = 0;
+	self->liveSpeed = 1;
+	self->targetLatency = 0;
+	self->liveTimer = 0;
+	self->timeShift = self->timeShiftBytes = 0;
+	self->timeShifted = false;
+	self->liveJumping = false;
+	self->scanSpeed = self->scanPosition = 0;
+	self->scanTime = 0;
+	self->scanTimer = 0;
+	self->scanSeeking = self->speedScanning = false;
+	self->stepFbo = 0;
+	self->stepDuration = self->stepWant = self->stepFillEnd = 0;
+	self->stepShown = -1;
+	self->stepStart = self->stepLatency = self->stepLatencySum = 0;
+	self->stepLatencyCount = 0;
+	self->stepIndex = -1;
+	self->stepQueued = 0;
+	self->stepCount = self->stepRemaining = self->stepCapacity = 0;
+	self->stepFilling = self->stepSeeking = self->stepCapture = self->stepRunning = self->stepClearPending = false;
+	self->cacheBytes = self->cacheDiskBytes = 0;
+	self->cacheUsed = 0;
+	self->cacheHits = self->cacheMisses = self->cacheReported = 0;
+	self->cacheSpilled = self->cacheEvicted = false;
+	self->playPending = self->fastStart = self->fastStarting = false;
+	self->videoDropped = self->skipMutedAudio = self->audioDropped = false;
+	self->trimPending = self->cacheShrunk = false;
+	self->probed = NULL;
+	self->fastStartDefaults = self->qualityDefaults = NULL;
+	self->openStart = self->openFileLoaded = self->openRestart = self->openLoaded = self->openPopulate = self->openFrame = 0;
+	self->populateCount = self->renderCount = self->uploadCount = 0;
+	self->logMpv = NULL;
+	self->logThread = NULL;
+	self->logBuffer = NULL;
+	self->logSequences = NULL;
+	self->logHead = self->logStop = 0;
+	self->statsTimer = 0;
 }
 
 static VideoViewPlugin* video_view_plugin_new() {
@@ -1080,6 +3484,11 @@ static VideoViewPlugin* video_view_plugin_new() {
 	self->videoTracks = g_array_new(FALSE, FALSE, sizeof(VideoViewPluginVideoTrack));
 	self->audioTracks = g_array_new(FALSE, FALSE, sizeof(VideoViewPluginTrack));
 	self->subtitleTracks = g_array_new(FALSE, FALSE, sizeof(VideoViewPluginTrack));
+	self->stepFrames = g_array_new(FALSE, FALSE, sizeof(VideoViewPluginStepFrame));
+	self->stepStale = g_array_new(FALSE, FALSE, sizeof(GLuint));
+	self->populateTimes = g_new0(uint32_t, VIDEO_VIEW_PLUGIN_STATS_SAMPLES);
+	self->renderTimes = g_new0(uint32_t, VIDEO_VIEW_PLUGIN_STATS_SAMPLES);
+	self->uploadTimes = g_new0(uint32_t, VIDEO_VIEW_PLUGIN_STATS_SAMPLES);
 	g_array_set_clear_func(self->audioTracks, video_view_plugin_track_free);
 	g_array_set_clear_func(self->subtitleTracks, video_view_plugin_track_free);
 	video_view_plugin_set_volume(self, 1.0);
@@ -1095,6 +3504,18 @@ static VideoViewPlugin* video_view_plugin_new() {
 	//mpv_set_option_string(self->mpv, "terminal", "yes");
 	//mpv_set_option_string(self->mpv, "msg-level", "all=v");
 	mpv_initialize(self->mpv);
+	self->fastStartDefaults = g_new0(gchar*, G_N_ELEMENTS(fastStartOptions) / 2 + 1);
+	for (int i = 0; fastStartOptions[i]; i += 2) {
+		gchar* value = mpv_get_property_string(self->mpv, fastStartOptions[i]);
+		self->fastStartDefaults[i / 2] = g_strdup(value);
+		mpv_free(value);
+	}
+	self->qualityDefaults = g_new0(gchar*, G_N_ELEMENTS(qualityOptions) + 1);
+	for (guint i = 0; i < G_N_ELEMENTS(qualityOptions); i++) {
+		gchar* value = mpv_get_property_string(self->mpv, qualityOptions[i].name);
+		self->qualityDefaults[i] = g_strdup(value);
+		mpv_free(value);
+	}
 	mpv_observe_property(self->mpv, 0, "time-pos/full", MPV_FORMAT_DOUBLE);
 	mpv_observe_property(self->mpv, 0, "demuxer-cache-time", MPV_FORMAT_DOUBLE);
 	mpv_observe_property(self->mpv, 0, "paused-for-cache", MPV_FORMAT_FLAG);
@@ -1108,8 +3529,32 @@ static void video_view_plugin_destroy(void* obj) {
 	video_view_plugin_set_inhibit(self, false);
 	fl_texture_registrar_unregister_texture(textureRegistrar, FL_TEXTURE(self));
 	g_idle_remove_by_data((void*)self->id);
+	video_view_plugin_proxy_set_weight(self->id, 0);
+	if (self->scanTimer) {
+		g_source_remove(self->scanTimer);
+	}
+	if (self->liveTimer) {
+		g_source_remove(self->liveTimer);
+	}
+	if (self->statsTimer) {
+		g_source_remove(self->statsTimer);
+	}
+	g_mutex_lock(&mutex);
+	if (self->dropSource) {
+		g_source_remove(self->dropSource);
+		self->dropSource = 0;
+	}
+	g_mutex_unlock(&mutex);
+	if (self->qualityTimer) {
+		g_source_remove(self->qualityTimer);
+	}
+	if (self->abrTimer) {
+		g_source_remove(self->abrTimer);
+	}
 	//fl_event_channel_send_end_of_stream(self->eventChannel, NULL, NULL);
 	g_object_unref(self->eventChannel);
+	// populate is not called anymore after the texture is unregistered
+	video_view_plugin_step_release(self);
 
 	VideoViewPluginEglState previousState = { 0 };
 	video_view_plugin_capture_egl_state(&previousState);
@@ -1141,15 +3586,33 @@ static void video_view_plugin_destroy(void* obj) {
 	self->eglDisplay = EGL_NO_DISPLAY;
 	self->eglImage = EGL_NO_IMAGE_KHR;
 
+	if (self->logMpv) {
+		g_atomic_int_set(&self->logStop, 1);
+		mpv_wakeup(self->logMpv);
+		g_thread_join(self->logThread);
+		mpv_destroy(self->logMpv);
+		g_free(self->logBuffer);
+		g_free(self->logSequences);
+	}
 	mpv_set_wakeup_callback(self->mpv, NULL, NULL);
 	mpv_destroy(self->mpv);
 	g_free(self->source);
+	g_strfreev(self->fastStartDefaults);
+	g_strfreev(self->qualityDefaults);
+	g_free(self->populateTimes);
+	g_free(self->renderTimes);
+	g_free(self->uploadTimes);
+	if (self->probed) {
+		fl_value_unref(self->probed);
+	}
 	g_free(self->preferredAudioLanguage);
 	g_free(self->preferredSubtitleLanguage);
 	g_free(self->swBuffer);
 	g_array_free(self->videoTracks, TRUE);
 	g_array_free(self->audioTracks, TRUE);
 	g_array_free(self->subtitleTracks, TRUE);
+	g_array_free(self->stepFrames, TRUE);
+	g_array_free(self->stepStale, TRUE);
 	g_object_unref(self);
 }
 
@@ -1180,10 +3643,22 @@ static void video_view_plugin_clear() {
 
 static void video_view_plugin_destroy_all(void* data) {
 	video_view_plugin_clear();
+	if (cacheTimer) {
+		g_source_remove(cacheTimer);
+		cacheTimer = 0;
+	}
+	g_free(cacheDir);
+	cacheDir = NULL;
+	video_view_plugin_proxy_stop();
 	if (platformGlContext) {
 		g_object_unref(platformGlContext);
 		platformGlContext = NULL;
 	}
+	if (pluginWindow) {
+		g_signal_handler_disconnect(pluginWindow, windowStateHandler);
+		pluginWindow = NULL;
+	}
+	windowHidden = false;
 	pluginView = NULL;
 	g_object_unref(methodChannel);
 	g_object_unref(codec);
@@ -1191,20 +3666,254 @@ static void video_view_plugin_destroy_all(void* data) {
 	g_tree_destroy(players);
 }
 
+static gboolean video_view_plugin_collect_cache(void* key, void* value, void* spilled) {
+	VideoViewPlugin* self = value;
+	int64_t bytes = 0;
+	int64_t diskBytes = 0;
+	mpv_node state;
+	if (self->state > 0 && !mpv_get_property(self->mpv, "demuxer-cache-state", MPV_FORMAT_NODE, &state)) {
+		const mpv_node* total = video_view_plugin_node_get(&state, "total-bytes", MPV_FORMAT_INT64);
+		const mpv_node* file = video_view_plugin_node_get(&state, "file-cache-bytes", MPV_FORMAT_INT64);
+		bytes = total ? total->u.int64 : 0;
+		diskBytes = file ? file->u.int64 : 0;
+		mpv_free_node_contents(&state);
+	}
+	if (bytes != self->cacheBytes || diskBytes != self->cacheDiskBytes || self->cacheHits + self->cacheMisses != self->cacheReported) {
+		self->cacheBytes = bytes;
+		self->cacheDiskBytes = diskBytes;
+		self->cacheReported = self->cacheHits + self->cacheMisses;
+		g_autoptr(FlValue) evt = fl_value_new_map();
+		fl_value_set_string_take(evt, "event", fl_value_new_string("cache"));
+		fl_value_set_string_take(evt, "bytes", fl_value_new_int(bytes));
+		fl_value_set_string_take(evt, "diskBytes", fl_value_new_int(diskBytes));
+		fl_value_set_string_take(evt, "hitRate", fl_value_new_float(self->cacheReported > 0 ? (double)self->cacheHits / self->cacheReported : 0));
+		fl_event_channel_send(self->eventChannel, evt, NULL, NULL);
+	}
+	if (self->cacheSpilled && diskBytes > 0) {
+		g_ptr_array_add(spilled, self);
+	}
+	return FALSE;
+}
+
+static gint video_view_plugin_compare_used(const void* a, const void* b) {
+	const VideoViewPlugin* i = *(VideoViewPlugin**)a;
+	const VideoViewPlugin* j = *(VideoViewPlugin**)b;
+	return i->cacheUsed > j->cacheUsed ? 1 : i->cacheUsed < j->cacheUsed ? -1 : 0;
+}
+
+static gboolean video_view_plugin_collect_player(void* key, void* value, void* all) {
+	g_ptr_array_add(all, value);
+	return FALSE;
+}
+
+// least recently used players give up memory first: caches of players not playing, then software buffers and cached
+// frames of paused or hidden players, then forward caches of playing players other than foreground ones
+static void video_view_plugin_enforce_memory_budget() {
+	GPtrArray* all = g_ptr_array_new();
+	g_tree_foreach(players, video_view_plugin_collect_player, all);
+	VideoViewPluginMemory* memory = g_new(VideoViewPluginMemory, all->len);
+	int64_t total = 0;
+	g_ptr_array_sort(all, video_view_plugin_compare_used);
+	for (guint i = 0; i < all->len; i++) {
+		total += video_view_plugin_get_memory(g_ptr_array_index(all, i), &memory[i]);
+	}
+	for (guint i = 0; total > memoryBudget && i < all->len; i++) {
+		VideoViewPlugin* player = g_ptr_array_index(all, i);
+		if (player->state < 3 && player->timeShiftBytes <= 0 && !player->cacheEvicted && memory[i].cache > 0) {
+			video_view_plugin_evict_cache(player);
+			total -= memory[i].cache;
+		}
+	}
+	for (guint i = 0; total > memoryBudget && i < all->len; i++) {
+		VideoViewPlugin* player = g_ptr_array_index(all, i);
+		if ((player->state < 3 || player->appliedVisibility > 0) && memory[i].buffer + memory[i].stepCache > 0) {
+			video_view_plugin_trim(player, memory[i].buffer > 0 && player->texture);
+			total -= memory[i].buffer + memory[i].stepCache;
+		}
+	}
+	for (guint i = 0; total > memoryBudget && i < all->len; i++) {
+		VideoViewPlugin* player = g_ptr_array_index(all, i);
+		if (player->state == 3 && player->priority > 0 && !player->cacheShrunk && memory[i].cache > VIDEO_VIEW_PLUGIN_MEMORY_MIN_CACHE) {
+			player->cacheShrunk = true;
+			gchar* bytes = g_strdup_printf("%d", VIDEO_VIEW_PLUGIN_MEMORY_MIN_CACHE);
+			mpv_set_property_string(player->mpv, "demuxer-max-bytes", bytes);
+			g_free(bytes);
+			total -= memory[i].cache - VIDEO_VIEW_PLUGIN_MEMORY_MIN_CACHE;
+		}
+	}
+	g_free(memory);
+	g_ptr_array_free(all, TRUE);
+}
+
+static gboolean video_view_plugin_report_memory(void* key, void* value, void* report) {
+	int64_t total = 0;
+	FlValue* usage = video_view_plugin_get_memory_usage(value, &total);
+	fl_value_set_take(fl_value_lookup_string(report, "players"), fl_value_new_int((int64_t)key), usage);
+	fl_value_set_string_take(report, "total", fl_value_new_int(fl_value_get_int(fl_value_lookup_string(report, "total")) + total));
+	return FALSE;
+}
+
+static FlValue* video_view_plugin_get_memory_report() {
+	FlValue* report = fl_value_new_map();
+	fl_value_set_string_take(report, "budget", fl_value_new_int(memoryBudget));
+	fl_value_set_string_take(report, "total", fl_value_new_int(0));
+	fl_value_set_string_take(report, "players", fl_value_new_map());
+	g_tree_foreach(players, video_view_plugin_report_memory, report);
+	return report;
+}
+
+static gboolean video_view_plugin_cache_callback(void* data) {
+	if (g_tree_nnodes(players) == 0) {
+		cacheTimer = 0;
+		return G_SOURCE_REMOVE;
+	}
+	GPtrArray* spilled = g_ptr_array_new();
+	g_tree_foreach(players, video_view_plugin_collect_cache, spilled);
+	if (cacheDiskBudget > 0) {
+		int64_t total = 0;
+		for (guint i = 0; i < spilled->len; i++) {
+			total += ((VideoViewPlugin*)g_ptr_array_index(spilled, i))->cacheDiskBytes;
+		}
+		// drop the cache of least recently used players first, playing players and time-shift windows are kept
+		g_ptr_array_sort(spilled, video_view_plugin_compare_used);
+		for (guint i = 0; total > cacheDiskBudget && i < spilled->len; i++) {
+			VideoViewPlugin* player = g_ptr_array_index(spilled, i);
+			if (player->state < 3 && player->timeShiftBytes <= 0 && !player->cacheEvicted) {
+				video_view_plugin_evict_cache(player);
+				total -= player->cacheDiskBytes;
+			}
+		}
+	}
+	g_ptr_array_free(spilled, TRUE);
+	if (memoryBudget > 0) {
+		video_view_plugin_enforce_memory_budget();
+	}
+	return G_SOURCE_CONTINUE;
+}
+
+// the policy applies to media opened afterwards
+static void video_view_plugin_set_cache_policy(const int64_t memoryBytes, const int64_t diskBytes, const gchar* directory) {
+	cacheMemoryBudget = memoryBytes;
+	cacheDiskBudget = diskBytes;
+	g_free(cacheDir);
+	cacheDir = directory[0] ? g_strdup(directory) : g_build_filename(g_get_user_cache_dir(), "video_view", NULL);
+	if (diskBytes > 0) {
+		g_mkdir_with_parents(cacheDir, 0700);
+	}
+}
+
+static gboolean video_view_plugin_update_player_visibility(void* key, void* value, void* data) {
+	video_view_plugin_update_visibility(value);
+	return FALSE;
+}
+
+// all players are hidden while the window is minimized, GTK can't tell whether it's occluded
+static gboolean video_view_plugin_window_state_callback(GtkWidget* widget, GdkEventWindowState* event, void* data) {
+	const bool hidden = event->new_window_state & (GDK_WINDOW_STATE_ICONIFIED | GDK_WINDOW_STATE_WITHDRAWN);
+	if (hidden != windowHidden) {
+		windowHidden = hidden;
+		g_tree_foreach(players, video_view_plugin_update_player_visibility, NULL);
+	}
+	return FALSE;
+}
+
+// symbols already in the process are preferred, which is how the benchmarks link a stand-in of libmpv,
+// on failure error is set to the message of the last dlopen, dlerror alone is cleared by the later calls
+static void* video_view_plugin_open_library(const gchar* const* names, const gchar* symbol, gchar** error) {
+	void* handle = dlopen(NULL, RTLD_LAZY);
+	if (handle && dlsym(handle, symbol)) {
+		return handle;
+	}
+	if (handle) {
+		dlclose(handle);
+	}
+	for (int i = 0; names[i]; i++) {
+		handle = dlopen(names[i], RTLD_LAZY | RTLD_LOCAL);
+		if (handle) {
+			return handle;
+		}
+		const gchar* message = dlerror();
+		g_free(*error);
+		*error = g_strdup(message ? message : names[i]);
+	}
+	return NULL;
+}
+
+// loading libmpv and ICU takes a noticeable part of app startup, so it's left to sessions that play media,
+// the libraries are kept loaded once they are, and closed again if either of them is unusable
+static bool video_view_plugin_load_libraries() {
+	if (librariesLoaded) {
+		return librariesLoaded > 0;
+	}
+	librariesLoaded = -1;
+	gchar* error = NULL;
+	void* mpv = video_view_plugin_open_library(mpvLibraries, "mpv_create", &error);
+	if (!mpv) {
+		g_warning("video_view: libmpv can't be loaded: %s", error);
+	}
+	g_free(error);
+	error = NULL;
+	void* icu = video_view_plugin_open_library(icuLibraries, G_STRINGIFY(uloc_toLanguageTag), &error);
+	if (!icu) {
+		g_warning("video_view: ICU can't be loaded: %s", error);
+	}
+	g_free(error);
+	if (!mpv || !icu) {
+		goto fail;
+	}
+#define VIDEO_VIEW_PLUGIN_RESOLVE_SYMBOL(name) \
+	if (!(*(void**)&name##_p = dlsym(mpv, #name))) { \
+		g_warning("video_view: %s is not found in libmpv", #name); \
+		goto fail; \
+	}
+	VIDEO_VIEW_PLUGIN_MPV_SYMBOLS(VIDEO_VIEW_PLUGIN_RESOLVE_SYMBOL)
+#undef VIDEO_VIEW_PLUGIN_RESOLVE_SYMBOL
+	*(void**)&ulocToLanguageTag = dlsym(icu, G_STRINGIFY(uloc_toLanguageTag));
+	if (!ulocToLanguageTag) {
+		g_warning("video_view: %s is not found in ICU", G_STRINGIFY(uloc_toLanguageTag));
+		goto fail;
+	}
+#ifndef eglCreateImageKHR
+	eglCreateImageKHR = (EglCreateImageKhrProc)eglGetProcAddress("eglCreateImageKHR");
+#endif
+#ifndef eglDestroyImageKHR
+	eglDestroyImageKHR = (EglDestroyImageKhrProc)eglGetProcAddress("eglDestroyImageKHR");
+#endif
+#ifndef glEGLImageTargetTexture2DOES
+	glEGLImageTargetTexture2DOES = (GlEglImageTargetTexture2DProc)eglGetProcAddress("glEGLImageTargetTexture2DOES");
+#endif
+	librariesLoaded = 1;
+	return true;
+fail:
+	if (mpv) {
+		dlclose(mpv);
+	}
+	if (icu) {
+		dlclose(icu);
+	}
+	return false;
+}
+
 static VideoViewPlugin* video_view_plugin_get_player(FlValue* args, const bool isMap) {
 	const int64_t id = fl_value_get_int(isMap ? fl_value_lookup_string(args, "id") : args);
 	return g_tree_lookup(players, (void*)id);
 }
 
 static void video_view_plugin_method_call(FlMethodChannel* channel, FlMethodCall* method_call, void* user_data) {
+	const int64_t trace = video_view_plugin_trace_begin("method", 0);
 	const gchar* method = fl_method_call_get_name(method_call);
 	FlValue* args = fl_method_call_get_args(method_call);
 	g_autoptr(FlMethodResponse) response = NULL;
-	if (g_str_equal(method, "create")) {
+	if (g_str_equal(method, "create") && !video_view_plugin_load_libraries()) {
+		response = FL_METHOD_RESPONSE(fl_method_error_response_new("unsupported", "libmpv or ICU can't be loaded", NULL));
+	} else if (g_str_equal(method, "create")) {
 		VideoViewPlugin* player = video_view_plugin_new();
 		g_mutex_lock(&mutex);
 		g_tree_insert(players, (void*)player->id, player);
 		g_mutex_unlock(&mutex);
+		if (!cacheTimer) {
+			cacheTimer = g_timeout_add(VIDEO_VIEW_PLUGIN_CACHE_INTERVAL, video_view_plugin_cache_callback, NULL);
+		}
 		g_autoptr(FlValue) result = fl_value_new_map();
 		fl_value_set_string_take(result, "id", fl_value_new_int(player->id));
 		response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
@@ -1217,6 +3926,31 @@ static void video_view_plugin_method_call(FlMethodChannel* channel, FlMethodCall
 			g_tree_remove(players, (void*)id);
 			g_mutex_unlock(&mutex);
 		}
+	} else if (g_str_equal(method, "startTrace")) {
+		video_view_plugin_start_trace(fl_value_get_string(args));
+	} else if (g_str_equal(method, "stopTrace")) {
+		video_view_plugin_stop_trace();
+	} else if (g_str_equal(method, "setCachePolicy")) {
+		const int64_t memoryBytes = fl_value_get_int(fl_value_lookup_string(args, "memoryBytes"));
+		const int64_t diskBytes = fl_value_get_int(fl_value_lookup_string(args, "diskBytes"));
+		const gchar* directory = fl_value_get_string(fl_value_lookup_string(args, "directory"));
+		video_view_plugin_set_cache_policy(memoryBytes, diskBytes, directory);
+	} else if (g_str_equal(method, "setProxy")) {
+		const bool enabled = fl_value_get_bool(fl_value_lookup_string(args, "enabled"));
+		const int64_t bitRate = fl_value_get_int(fl_value_lookup_string(args, "maxBitRate"));
+		video_view_plugin_set_proxy(enabled, bitRate / 8);
+	} else if (g_str_equal(method, "setDecoderThreads")) {
+		const int64_t threads = fl_value_get_int(args);
+		decoderThreads = threads > 0 ? (uint32_t)threads : g_get_num_processors();
+	} else if (g_str_equal(method, "setMemoryBudget")) {
+		memoryBudget = MAX(fl_value_get_int(args), 0);
+	} else if (g_str_equal(method, "getMemoryReport")) {
+		g_autoptr(FlValue) result = video_view_plugin_get_memory_report();
+		response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+	} else if (g_str_equal(method, "prefetch")) {
+		const gchar* source = fl_value_get_string(fl_value_lookup_string(args, "source"));
+		const int64_t bytes = fl_value_get_int(fl_value_lookup_string(args, "bytes"));
+		video_view_plugin_prefetch(source, bytes);
 	} else if (g_str_equal(method, "open")) {
 		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
 		const gchar* value = fl_value_get_string(fl_value_lookup_string(args, "value"));
@@ -1235,14 +3969,79 @@ static void video_view_plugin_method_call(FlMethodChannel* channel, FlMethodCall
 		const int64_t position = fl_value_get_int(fl_value_lookup_string(args, "position"));
 		const bool fast = fl_value_get_bool(fl_value_lookup_string(args, "fast"));
 		video_view_plugin_seek_to(player, position, fast);
+	} else if (g_str_equal(method, "stepFrame")) {
+		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
+		const int32_t value = (int32_t)fl_value_get_int(fl_value_lookup_string(args, "value"));
+		video_view_plugin_step_frame(player, value);
 	} else if (g_str_equal(method, "setVolume")) {
 		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
 		const double value = fl_value_get_float(fl_value_lookup_string(args, "value"));
 		video_view_plugin_set_volume(player, value);
+	} else if (g_str_equal(method, "setSkipMutedAudio")) {
+		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
+		const bool value = fl_value_get_bool(fl_value_lookup_string(args, "value"));
+		video_view_plugin_set_skip_muted_audio(player, value);
+	} else if (g_str_equal(method, "setMaxFrameRate")) {
+		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
+		const double value = fl_value_get_float(fl_value_lookup_string(args, "value"));
+		video_view_plugin_set_max_frame_rate(player, value);
+	} else if (g_str_equal(method, "setAdaptiveBitRate")) {
+		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
+		const bool value = fl_value_get_bool(fl_value_lookup_string(args, "value"));
+		video_view_plugin_set_adaptive_bit_rate(player, value);
+	} else if (g_str_equal(method, "setAdaptiveQuality")) {
+		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
+		const bool value = fl_value_get_bool(fl_value_lookup_string(args, "value"));
+		video_view_plugin_set_adaptive_quality(player, value);
 	} else if (g_str_equal(method, "setSpeed")) {
 		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
 		const double value = fl_value_get_float(fl_value_lookup_string(args, "value"));
 		video_view_plugin_set_speed(player, value);
+	} else if (g_str_equal(method, "setTargetLatency")) {
+		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
+		const int64_t value = fl_value_get_int(fl_value_lookup_string(args, "value"));
+		video_view_plugin_set_target_latency(player, value);
+	} else if (g_str_equal(method, "setTimeShift")) {
+		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
+		const int64_t value = fl_value_get_int(fl_value_lookup_string(args, "value"));
+		video_view_plugin_set_time_shift(player, value);
+	} else if (g_str_equal(method, "setLogLevel")) {
+		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
+		const gchar* value = fl_value_get_string(fl_value_lookup_string(args, "value"));
+		video_view_plugin_set_log_level(player, value);
+	} else if (g_str_equal(method, "getLogs")) {
+		VideoViewPlugin* player = video_view_plugin_get_player(args, false);
+		if (player) {
+			g_autoptr(FlValue) result = video_view_plugin_get_logs(player, VIDEO_VIEW_PLUGIN_LOG_SIZE);
+			response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+		}
+	} else if (g_str_equal(method, "getStats")) {
+		VideoViewPlugin* player = video_view_plugin_get_player(args, false);
+		if (player) {
+			g_autoptr(FlValue) result = video_view_plugin_get_stats(player);
+			response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+		}
+	} else if (g_str_equal(method, "setStatsInterval")) {
+		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
+		const int64_t value = fl_value_get_int(fl_value_lookup_string(args, "value"));
+		video_view_plugin_set_stats_interval(player, value);
+	} else if (g_str_equal(method, "setFastStart")) {
+		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
+		player->fastStart = fl_value_get_bool(fl_value_lookup_string(args, "value"));
+	} else if (g_str_equal(method, "setPriority")) {
+		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
+		const uint8_t value = (uint8_t)fl_value_get_int(fl_value_lookup_string(args, "value"));
+		video_view_plugin_set_priority(player, value);
+	} else if (g_str_equal(method, "setVisibility")) {
+		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
+		const uint8_t value = (uint8_t)fl_value_get_int(fl_value_lookup_string(args, "value"));
+		video_view_plugin_set_visibility(player, value);
+	} else if (g_str_equal(method, "setScanSpeed")) {
+		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
+		const double value = fl_value_get_float(fl_value_lookup_string(args, "value"));
+		// an explicit scan is not stopped by a later playback speed
+		player->speedScanning = false;
+		video_view_plugin_set_scan_speed(player, value);
 	} else if (g_str_equal(method, "setLooping")) {
 		VideoViewPlugin* player = video_view_plugin_get_player(args, true);
 		const bool value = fl_value_get_bool(fl_value_lookup_string(args, "value"));
@@ -1286,27 +4085,31 @@ static void video_view_plugin_method_call(FlMethodChannel* channel, FlMethodCall
 		response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 	}
 	fl_method_call_respond(method_call, response, NULL);
+	video_view_plugin_trace_end("method", 0, trace, method);
 }
 
 /* plugin registration */
 
 void video_view_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
-#ifndef eglCreateImageKHR
-	eglCreateImageKHR = (EglCreateImageKhrProc)eglGetProcAddress("eglCreateImageKHR");
-#endif
-#ifndef eglDestroyImageKHR
-	eglDestroyImageKHR = (EglDestroyImageKhrProc)eglGetProcAddress("eglDestroyImageKHR");
-#endif
-#ifndef glEGLImageTargetTexture2DOES
-	glEGLImageTargetTexture2DOES = (GlEglImageTargetTexture2DProc)eglGetProcAddress("glEGLImageTargetTexture2DOES");
-#endif
 	setlocale(LC_NUMERIC, "C");
 	g_mutex_init(&mutex);
 	players = g_tree_new_full(video_view_plugin_compare_key, NULL, NULL, video_view_plugin_destroy);
 	messenger = fl_plugin_registrar_get_messenger(registrar);
 	textureRegistrar = fl_plugin_registrar_get_texture_registrar(registrar);
 	pluginView = fl_plugin_registrar_get_view(registrar);
+	pluginWindow = pluginView ? gtk_widget_get_toplevel(GTK_WIDGET(pluginView)) : NULL;
+	if (pluginWindow && gtk_widget_is_toplevel(pluginWindow)) {
+		windowStateHandler = g_signal_connect(pluginWindow, "window-state-event", G_CALLBACK(video_view_plugin_window_state_callback), NULL);
+	} else {
+		pluginWindow = NULL;
+	}
+	windowHidden = false;
 	platformGlContext = NULL;
+	decoderThreads = g_get_num_processors();
+	cacheMemoryBudget = cacheDiskBudget = 0;
+	cacheDir = NULL;
+	cacheTimer = 0;
+	video_view_plugin_proxy_init();
 	codec = FL_METHOD_CODEC(fl_standard_method_codec_new());
 	methodChannel = fl_method_channel_new(messenger, "VideoViewPlugin", codec);
 	fl_method_channel_set_method_call_handler(methodChannel, video_view_plugin_method_call, NULL, video_view_plugin_destroy_all);
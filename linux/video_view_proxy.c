@@ -0,0 +1,1176 @@
+#include "video_view_proxy.h"
+#include <gio/gio.h>
+#include <string.h>
+
+#define VIDEO_VIEW_PLUGIN_PROXY_THREADS 64 // max connections served by the proxy at the same time
+#define VIDEO_VIEW_PLUGIN_PROXY_POOL_SIZE 4 // idle upstream connections kept for each host
+#define VIDEO_VIEW_PLUGIN_PROXY_SHARE_BYTES (32 << 20) // max response size kept in memory for concurrent requests
+#define VIDEO_VIEW_PLUGIN_PROXY_BUFFER (64 << 10)
+#define VIDEO_VIEW_PLUGIN_PROXY_PLAYLIST_BYTES (4 << 20) // max HLS playlist size rewritten by the proxy
+#define VIDEO_VIEW_PLUGIN_PREFETCH_CLIENT 0 // proxy client id of prefetch downloads, texture ids are never 0
+#define VIDEO_VIEW_PLUGIN_PREFETCH_THREADS 2 // max sources prefetched at the same time
+#define VIDEO_VIEW_PLUGIN_PREFETCH_MAX_BYTES (64 << 20) // size of the prefetch cache shared by all sources
+
+static GSocketService* proxyService;
+static uint16_t proxyPort; // 0 if the proxy is not listening
+static gchar* proxyToken; // random first segment of proxy paths, so other processes can't relay through the proxy
+static bool proxyEnabled;
+static int64_t proxyBandwidth; // bytes per second shared by all players, 0 for no limit
+static GMutex proxyMutex; // guards all proxy states below, which are used by proxy worker threads
+static GCond proxyCond;
+static GHashTable* proxyPool; // idle upstream connections by scheme and host
+static GHashTable* proxyFetches; // in-flight responses by method, url and range
+static GHashTable* proxyClients; // bandwidth states by player id
+static GHashTable* prefetchCache; // prefetched resources by url, guarded by proxyMutex
+static GQueue* prefetchOrder; // prefetched resources from the least recently used
+static int64_t prefetchBytes;
+static GThreadPool* prefetchPool;
+static GHashTable* proxyValidators; // ETag or Last-Modified of sources being opened through the proxy, guarded by proxyMutex
+
+typedef struct {
+	GSocketConnection* connection;
+	GDataInputStream* input;
+	gchar* origin; // scheme and host the connection is pooled by
+} VideoViewPluginUpstream;
+
+typedef struct {
+	GByteArray* data; // response head and body as received, replayed to followers
+	uint32_t refs; // requests waiting for this response
+	bool done;
+	bool failed;
+	bool closing; // the response ends by closing the connection
+	bool shared; // false if the response is too large to keep, followers have to fetch it by themselves
+} VideoViewPluginFetch;
+
+typedef struct {
+	gchar* url;
+	gchar* contentType;
+	gchar* validator; // ETag or Last-Modified
+	GByteArray* data; // the beginning of the resource
+	int64_t total; // size of the resource, -1 before the response head is received
+	int64_t limit; // max bytes to download
+	uint32_t refs;
+	bool headed; // the response head is received
+	bool ranged; // the server supports range requests, so the rest can be fetched on demand
+	bool done;
+	bool failed;
+	bool cached; // the entry is in prefetchCache
+	gint cancelled; // set under proxyMutex, read by the download thread without locking
+} VideoViewPluginPrefetch;
+
+typedef struct {
+	uint32_t weight;
+	uint32_t relays; // responses being sent to the player
+	int64_t bytes; // bytes sent in current window
+	gint64 windowStart;
+} VideoViewPluginProxyClient;
+
+static void video_view_plugin_upstream_free(void* data) {
+	VideoViewPluginUpstream* upstream = data;
+	g_object_unref(upstream->input);
+	g_io_stream_close(G_IO_STREAM(upstream->connection), NULL, NULL);
+	g_object_unref(upstream->connection);
+	g_free(upstream->origin);
+	g_free(upstream);
+}
+
+static void video_view_plugin_upstream_queue_free(void* queue) {
+	g_queue_free_full(queue, video_view_plugin_upstream_free);
+}
+
+static VideoViewPluginUpstream* video_view_plugin_upstream_get(const gchar* scheme, const gchar* host, bool* reused) {
+	gchar* origin = g_strdup_printf("%s://%s", scheme, host);
+	g_mutex_lock(&proxyMutex);
+	GQueue* idle = g_hash_table_lookup(proxyPool, origin);
+	VideoViewPluginUpstream* upstream = idle ? g_queue_pop_head(idle) : NULL;
+	g_mutex_unlock(&proxyMutex);
+	*reused = upstream != NULL;
+	if (upstream) {
+		g_free(origin);
+		return upstream;
+	}
+	const bool tls = g_str_equal(scheme, "https");
+	GSocketClient* client = g_socket_client_new();
+	g_socket_client_set_tls(client, tls);
+	GSocketConnection* connection = g_socket_client_connect_to_host(client, host, tls ? 443 : 80, NULL, NULL);
+	g_object_unref(client);
+	if (!connection) {
+		g_free(origin);
+		return NULL;
+	}
+	upstream = g_new(VideoViewPluginUpstream, 1);
+	upstream->connection = connection;
+	upstream->input = g_data_input_stream_new(g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+	g_data_input_stream_set_newline_type(upstream->input, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+	upstream->origin = origin;
+	return upstream;
+}
+
+static void video_view_plugin_upstream_put(VideoViewPluginUpstream* upstream) {
+	g_mutex_lock(&proxyMutex);
+	GQueue* idle = g_hash_table_lookup(proxyPool, upstream->origin);
+	if (!idle) {
+		idle = g_queue_new();
+		g_hash_table_insert(proxyPool, g_strdup(upstream->origin), idle);
+	}
+	if (idle->length < VIDEO_VIEW_PLUGIN_PROXY_POOL_SIZE) {
+		g_queue_push_tail(idle, upstream);
+		upstream = NULL;
+	}
+	g_mutex_unlock(&proxyMutex);
+	if (upstream) {
+		video_view_plugin_upstream_free(upstream);
+	}
+}
+
+// must be called with proxyMutex locked
+static void video_view_plugin_fetch_unref(VideoViewPluginFetch* fetch) {
+	if (--fetch->refs == 0) {
+		g_byte_array_free(fetch->data, TRUE);
+		g_free(fetch);
+	}
+}
+
+// must be called with proxyMutex locked
+static void video_view_plugin_proxy_relays(const int64_t id, const int32_t delta) {
+	VideoViewPluginProxyClient* client = g_hash_table_lookup(proxyClients, (void*)id);
+	if (client) {
+		client->relays += delta;
+	}
+}
+
+// sleeps until the player is within its share of the bandwidth, shares are weighted by players receiving data
+static void video_view_plugin_proxy_throttle(const int64_t id, const gsize bytes) {
+	gint64 delay = 0;
+	g_mutex_lock(&proxyMutex);
+	VideoViewPluginProxyClient* client = g_hash_table_lookup(proxyClients, (void*)id);
+	if (client && proxyBandwidth > 0) {
+		uint32_t weights = 0;
+		GHashTableIter iter;
+		void* value;
+		g_hash_table_iter_init(&iter, proxyClients);
+		while (g_hash_table_iter_next(&iter, NULL, &value)) {
+			const VideoViewPluginProxyClient* other = value;
+			if (other->relays > 0) {
+				weights += other->weight;
+			}
+		}
+		const double share = (double)proxyBandwidth * client->weight / MAX(weights, client->weight);
+		const gint64 now = g_get_monotonic_time();
+		if (now - client->windowStart > G_USEC_PER_SEC) {
+			client->windowStart = now;
+			client->bytes = 0;
+		}
+		client->bytes += bytes;
+		delay = client->windowStart + (gint64)(client->bytes / share * G_USEC_PER_SEC) - now;
+	}
+	g_mutex_unlock(&proxyMutex);
+	if (delay > 0) {
+		g_usleep(delay);
+	}
+}
+
+// forwards a part of the response to the client and followers, returns false if nobody needs it anymore
+static bool video_view_plugin_proxy_send(VideoViewPluginFetch* fetch, GOutputStream* output, const int64_t id, const void* data, const gsize size, bool* clientAlive) {
+	g_mutex_lock(&proxyMutex);
+	if (fetch->shared) {
+		g_byte_array_append(fetch->data, data, size);
+		g_cond_broadcast(&proxyCond);
+	}
+	const bool followed = fetch->shared && fetch->refs > 1;
+	g_mutex_unlock(&proxyMutex);
+	if (*clientAlive) {
+		video_view_plugin_proxy_throttle(id, size);
+		*clientAlive = g_output_stream_write_all(output, data, size, NULL, NULL, NULL);
+	}
+	return *clientAlive || followed;
+}
+
+// relays size bytes of body, or until the upstream is closed if size < 0
+static bool video_view_plugin_proxy_relay(VideoViewPluginUpstream* upstream, VideoViewPluginFetch* fetch, GOutputStream* output, const int64_t id, int64_t size, bool* clientAlive) {
+	guint8* buffer = g_malloc(VIDEO_VIEW_PLUGIN_PROXY_BUFFER);
+	bool ok = true;
+	while (ok && size != 0) {
+		const gssize n = g_input_stream_read(G_INPUT_STREAM(upstream->input), buffer, size > 0 ? MIN(size, VIDEO_VIEW_PLUGIN_PROXY_BUFFER) : VIDEO_VIEW_PLUGIN_PROXY_BUFFER, NULL, NULL);
+		if (n <= 0) {
+			ok = n == 0 && size < 0;
+			break;
+		}
+		if (size > 0) {
+			size -= n;
+		}
+		ok = video_view_plugin_proxy_send(fetch, output, id, buffer, n, clientAlive);
+	}
+	g_free(buffer);
+	return ok;
+}
+
+// relays a chunked body with its framing, so followers can replay it as is
+static bool video_view_plugin_proxy_relay_chunked(VideoViewPluginUpstream* upstream, VideoViewPluginFetch* fetch, GOutputStream* output, const int64_t id, bool* clientAlive) {
+	while (true) {
+		gchar* line = g_data_input_stream_read_line(upstream->input, NULL, NULL, NULL);
+		if (!line) {
+			return false;
+		}
+		const int64_t size = g_ascii_strtoll(line, NULL, 16);
+		gchar* framed = g_strdup_printf("%s\r\n", line);
+		bool ok = video_view_plugin_proxy_send(fetch, output, id, framed, strlen(framed), clientAlive);
+		g_free(framed);
+		g_free(line);
+		if (ok && size == 0) {
+			// the last chunk is followed by optional trailers and an empty line
+			bool end = false;
+			while (ok && !end) {
+				line = g_data_input_stream_read_line(upstream->input, NULL, NULL, NULL);
+				if (!line) {
+					return false;
+				}
+				end = line[0] == 0;
+				framed = g_strdup_printf("%s\r\n", line);
+				ok = video_view_plugin_proxy_send(fetch, output, id, framed, strlen(framed), clientAlive);
+				g_free(framed);
+				g_free(line);
+			}
+			return ok;
+		}
+		if (!ok || !video_view_plugin_proxy_relay(upstream, fetch, output, id, size, clientAlive)) {
+			return false;
+		}
+		line = g_data_input_stream_read_line(upstream->input, NULL, NULL, NULL);
+		ok = line && line[0] == 0 && video_view_plugin_proxy_send(fetch, output, id, "\r\n", 2, clientAlive);
+		g_free(line);
+		if (!ok) {
+			return false;
+		}
+	}
+}
+
+// reads a whole body, returns false if it fails or gets larger than max
+static bool video_view_plugin_proxy_read_body(VideoViewPluginUpstream* upstream, const int64_t length, const bool chunked, GByteArray* data, const guint max) {
+	GInputStream* input = G_INPUT_STREAM(upstream->input);
+	if (!chunked) {
+		guint8* buffer = g_malloc(VIDEO_VIEW_PLUGIN_PROXY_BUFFER);
+		bool ok = length <= max;
+		while (ok && (length < 0 || data->len < length)) {
+			const gssize n = g_input_stream_read(input, buffer, length < 0 ? VIDEO_VIEW_PLUGIN_PROXY_BUFFER : MIN(length - data->len, VIDEO_VIEW_PLUGIN_PROXY_BUFFER), NULL, NULL);
+			if (n <= 0) {
+				ok = n == 0 && length < 0;
+				break;
+			}
+			g_byte_array_append(data, buffer, n);
+			ok = data->len <= max;
+		}
+		g_free(buffer);
+		return ok;
+	}
+	while (true) {
+		gchar* line = g_data_input_stream_read_line(upstream->input, NULL, NULL, NULL);
+		if (!line) {
+			return false;
+		}
+		const int64_t size = g_ascii_strtoll(line, NULL, 16);
+		g_free(line);
+		if (size == 0) {
+			// the last chunk is followed by optional trailers and an empty line
+			bool end = false;
+			while (!end) {
+				line = g_data_input_stream_read_line(upstream->input, NULL, NULL, NULL);
+				if (!line) {
+					return false;
+				}
+				end = line[0] == 0;
+				g_free(line);
+			}
+			return true;
+		}
+		if (size < 0 || data->len + size > max) {
+			return false;
+		}
+		const guint offset = data->len;
+		gsize read = 0;
+		g_byte_array_set_size(data, offset + size);
+		if (!g_input_stream_read_all(input, &data->data[offset], size, &read, NULL, NULL) || read != size) {
+			return false;
+		}
+		line = g_data_input_stream_read_line(upstream->input, NULL, NULL, NULL);
+		const bool ok = line && line[0] == 0;
+		g_free(line);
+		if (!ok) {
+			return false;
+		}
+	}
+}
+
+static bool video_view_plugin_proxy_is_playlist(const gchar* path, const gchar* contentType) {
+	const gchar* query = strchr(path, '?');
+	const gsize length = query ? (gsize)(query - path) : strlen(path);
+	if (length >= 5 && !g_ascii_strncasecmp(&path[length - 5], ".m3u8", 5)) {
+		return true;
+	}
+	gchar* type = contentType ? g_ascii_strdown(contentType, -1) : NULL;
+	const bool playlist = type && strstr(type, "mpegurl");
+	g_free(type);
+	return playlist;
+}
+
+// absolute http uris are made relative to the playlist, up climbs from its directory to /<token>/<player id>/
+static void video_view_plugin_proxy_append_uri(GString* text, const gchar* uri, const gsize length, const gchar* up) {
+	const gchar* separator = g_strstr_len(uri, length, "://");
+	if (separator && (g_str_has_prefix(uri, "http://") || g_str_has_prefix(uri, "https://"))) {
+		g_string_append(text, up);
+		g_string_append_len(text, uri, separator - uri);
+		g_string_append_c(text, '/');
+		g_string_append_len(text, &separator[3], length - (&separator[3] - uri));
+	} else {
+		g_string_append_len(text, uri, length);
+	}
+}
+
+// rewrites absolute uris of an HLS playlist requested by path, so its variants, segments and keys go through the proxy
+// the result doesn't depend on the player, so concurrent requests of other players can still share it
+static GString* video_view_plugin_proxy_rewrite_playlist(const gchar* text, const gsize size, const gchar* path) {
+	// the playlist is at /<token>/<player id>/<scheme>/<host><path>
+	GString* up = g_string_new("../../");
+	for (const gchar* c = &path[1]; *c && *c != '?'; c++) {
+		if (*c == '/') {
+			g_string_append(up, "../");
+		}
+	}
+	GString* result = g_string_sized_new(size + size / 4);
+	const gchar* end = text + size;
+	for (const gchar* line = text; line < end;) {
+		const gchar* next = memchr(line, '\n', end - line);
+		const gchar* lineEnd = next ? next : end;
+		if (line[0] == '#') {
+			const gchar* cursor = line;
+			const gchar* attribute;
+			while ((attribute = g_strstr_len(cursor, lineEnd - cursor, "URI=\""))) {
+				const gchar* value = &attribute[5];
+				const gchar* quote = memchr(value, '"', lineEnd - value);
+				if (!quote) {
+					break;
+				}
+				g_string_append_len(result, cursor, value - cursor);
+				video_view_plugin_proxy_append_uri(result, value, quote - value, up->str);
+				cursor = quote;
+			}
+			g_string_append_len(result, cursor, lineEnd - cursor);
+		} else {
+			const bool cr = lineEnd > line && lineEnd[-1] == '\r';
+			video_view_plugin_proxy_append_uri(result, line, lineEnd - line - cr, up->str);
+			if (cr) {
+				g_string_append_c(result, '\r');
+			}
+		}
+		if (next) {
+			g_string_append_c(result, '\n');
+		}
+		line = next ? &next[1] : end;
+	}
+	g_string_free(up, TRUE);
+	return result;
+}
+
+// sends the request upstream and relays the response to the client and followers, returns false if the client connection should be closed
+// a headless fetch continues a response that is already started, so only the body of a partial response is relayed
+static bool video_view_plugin_proxy_fetch(VideoViewPluginFetch* fetch, GOutputStream* output, const int64_t id, const gchar* method, const gchar* scheme, const gchar* host, const gchar* path, const gchar* headers, const gchar* range, const bool headless) {
+	gchar* request = range ? g_strdup_printf("%s %s HTTP/1.1\r\nHost: %s\r\nConnection: keep-alive\r\nRange: %s\r\n%s\r\n", method, path, host, range, headers) : g_strdup_printf("%s %s HTTP/1.1\r\nHost: %s\r\nConnection: keep-alive\r\n%s\r\n", method, path, host, headers);
+	VideoViewPluginUpstream* upstream = NULL;
+	gchar* status = NULL;
+	bool reused = true;
+	// pooled connections may have been closed by the server, so retry once with a new one
+	for (int i = 0; i < 2 && !status && reused; i++) {
+		upstream = video_view_plugin_upstream_get(scheme, host, &reused);
+		if (!upstream) {
+			break;
+		}
+		if (g_output_stream_write_all(g_io_stream_get_output_stream(G_IO_STREAM(upstream->connection)), request, strlen(request), NULL, NULL, NULL)) {
+			status = g_data_input_stream_read_line(upstream->input, NULL, NULL, NULL);
+		}
+		if (!status) {
+			video_view_plugin_upstream_free(upstream);
+			upstream = NULL;
+		}
+	}
+	g_free(request);
+	bool clientAlive = true;
+	bool ok = status != NULL;
+	if (ok) {
+		const int code = strlen(status) > 9 ? (int)g_ascii_strtoll(&status[9], NULL, 10) : 0;
+		const bool hasBody = !g_str_equal(method, "HEAD") && code >= 200 && code != 204 && code != 304;
+		bool keepAlive = !g_str_has_prefix(status, "HTTP/1.0");
+		bool chunked = false;
+		int64_t length = -1;
+		gchar* validator = NULL;
+		gchar* contentType = NULL;
+		bool encoded = false;
+		bool whole = code == 200;
+		GString* head = g_string_new(NULL);
+		GString* framing = g_string_new(NULL); // headers which don't apply to a rewritten body
+		gchar* line;
+		while ((line = g_data_input_stream_read_line(upstream->input, NULL, NULL, NULL)) && line[0]) {
+			if (!g_ascii_strncasecmp(line, "ETag:", 5) || (!validator && !g_ascii_strncasecmp(line, "Last-Modified:", 14))) {
+				g_free(validator);
+				validator = g_strdup(g_strchug(strchr(line, ':') + 1));
+			}
+			if (!g_ascii_strncasecmp(line, "Connection:", 11)) {
+				gchar* value = g_ascii_strdown(&line[11], -1);
+				keepAlive = !strstr(value, "close");
+				g_free(value);
+			} else if (!g_ascii_strncasecmp(line, "Keep-Alive:", 11)) {
+				// hop-by-hop header
+			} else if (!g_ascii_strncasecmp(line, "Location:", 9)) {
+				// keep redirects inside the proxy
+				const gchar* location = g_strchug(&line[9]);
+				const gchar* separator = strstr(location, "://");
+				if (separator && (g_str_has_prefix(location, "http://") || g_str_has_prefix(location, "https://"))) {
+					g_string_append_printf(head, "Location: http://127.0.0.1:%u/%s/%ld/%.*s/%s\r\n", proxyPort, proxyToken, id, (int)(separator - location), location, &separator[3]);
+				} else if (location[0] == '/') {
+					g_string_append_printf(head, "Location: /%s/%ld/%s/%s%s\r\n", proxyToken, id, scheme, host, location);
+				} else {
+					g_string_append_printf(head, "Location: %s\r\n", location);
+				}
+			} else if (!g_ascii_strncasecmp(line, "Content-Length:", 15)) {
+				length = g_ascii_strtoll(&line[15], NULL, 10);
+				g_string_append_printf(framing, "%s\r\n", line);
+			} else if (!g_ascii_strncasecmp(line, "Transfer-Encoding:", 18)) {
+				gchar* value = g_ascii_strdown(&line[18], -1);
+				chunked = strstr(value, "chunked") != NULL;
+				g_free(value);
+				g_string_append_printf(framing, "%s\r\n", line);
+			} else if (!g_ascii_strncasecmp(line, "Content-Range:", 14)) {
+				// mpv asks for bytes=0- by default, which is whole if the range starts at 0 and ends at the last byte
+				gchar* end = NULL;
+				const gchar* first = strstr(line, "bytes 0-");
+				const int64_t last = first ? g_ascii_strtoll(&first[8], &end, 10) : -1;
+				whole = whole || (code == 206 && end && end[0] == '/' && g_ascii_strtoll(&end[1], NULL, 10) == last + 1);
+				g_string_append_printf(framing, "%s\r\n", line);
+			} else {
+				if (!g_ascii_strncasecmp(line, "Content-Type:", 13)) {
+					g_free(contentType);
+					contentType = g_strdup(&line[13]);
+				} else if (!g_ascii_strncasecmp(line, "Content-Encoding:", 17)) {
+					gchar* value = g_ascii_strdown(&line[17], -1);
+					encoded = !g_str_equal(g_strstrip(value), "identity");
+					g_free(value);
+				}
+				g_string_append_printf(head, "%s\r\n", line);
+			}
+			g_free(line);
+		}
+		// HLS playlists are rewritten unless they are compressed or only a part is requested
+		const bool rewrite = video_view_plugin_proxy_is_playlist(path, contentType) && !encoded && whole && hasBody && !headless;
+		g_free(contentType);
+		g_string_prepend(head, "\r\n");
+		g_string_prepend(head, rewrite ? "HTTP/1.1 200 OK" : status);
+		ok = line != NULL && (!headless || code == 206);
+		g_free(line);
+		if (ok && validator && (code == 200 || code == 206)) {
+			gchar* url = g_strdup_printf("%s://%s%s", scheme, host, path);
+			g_mutex_lock(&proxyMutex);
+			if (g_hash_table_contains(proxyValidators, url)) {
+				g_hash_table_replace(proxyValidators, url, validator);
+				url = validator = NULL;
+			}
+			g_mutex_unlock(&proxyMutex);
+			g_free(url);
+		}
+		g_free(validator);
+		GString* rewritten = NULL;
+		if (ok && rewrite) {
+			GByteArray* body = g_byte_array_new();
+			ok = video_view_plugin_proxy_read_body(upstream, length, chunked, body, VIDEO_VIEW_PLUGIN_PROXY_PLAYLIST_BYTES);
+			if (ok) {
+				rewritten = video_view_plugin_proxy_rewrite_playlist((const gchar*)body->data, body->len, path);
+				g_string_append_printf(head, "Content-Length: %u\r\n", (guint)rewritten->len);
+			}
+			g_byte_array_free(body, TRUE);
+		} else {
+			g_string_append(head, framing->str);
+		}
+		if (ok) {
+			// the body of an upstream response without length ends with the connection
+			const bool upstreamClosing = hasBody && !chunked && length < 0;
+			const bool untilClose = upstreamClosing && !rewritten;
+			g_string_append(head, untilClose ? "Connection: close\r\n\r\n" : "Connection: keep-alive\r\n\r\n");
+			const int64_t bodyLength = rewritten ? (int64_t)rewritten->len : length;
+			g_mutex_lock(&proxyMutex);
+			fetch->closing = untilClose;
+			// redirects carry the id of the requesting player, so followers fetch them with their own
+			fetch->shared = fetch->shared && (code < 300 || code >= 400) && (!hasBody || (bodyLength >= 0 && bodyLength <= VIDEO_VIEW_PLUGIN_PROXY_SHARE_BYTES));
+			g_mutex_unlock(&proxyMutex);
+			if (!headless) {
+				ok = video_view_plugin_proxy_send(fetch, output, id, head->str, head->len, &clientAlive);
+			}
+			if (ok && rewritten) {
+				ok = video_view_plugin_proxy_send(fetch, output, id, rewritten->str, rewritten->len, &clientAlive);
+			} else if (ok && hasBody) {
+				ok = chunked ? video_view_plugin_proxy_relay_chunked(upstream, fetch, output, id, &clientAlive) : video_view_plugin_proxy_relay(upstream, fetch, output, id, length, &clientAlive);
+			}
+			if (ok && keepAlive && !upstreamClosing) {
+				video_view_plugin_upstream_put(upstream);
+				upstream = NULL;
+			}
+			clientAlive = clientAlive && !untilClose;
+		}
+		if (rewritten) {
+			g_string_free(rewritten, TRUE);
+		}
+		g_string_free(framing, TRUE);
+		g_string_free(head, TRUE);
+		g_free(status);
+	} else if (!headless) {
+		const gchar* response = "HTTP/1.1 502 Bad Gateway\r\nContent-Length: 0\r\n\r\n";
+		clientAlive = g_output_stream_write_all(output, response, strlen(response), NULL, NULL, NULL);
+		ok = clientAlive;
+	}
+	if (upstream) {
+		video_view_plugin_upstream_free(upstream);
+	}
+	g_mutex_lock(&proxyMutex);
+	fetch->done = true;
+	fetch->failed = !ok;
+	g_cond_broadcast(&proxyCond);
+	g_mutex_unlock(&proxyMutex);
+	return ok && clientAlive;
+}
+
+// replays a response fetched by another request, returns 1 if it has to be fetched again, 0 if the connection can be reused
+static int video_view_plugin_proxy_follow(VideoViewPluginFetch* fetch, GOutputStream* output, const int64_t id) {
+	guint8* buffer = g_malloc(VIDEO_VIEW_PLUGIN_PROXY_BUFFER);
+	guint sent = 0;
+	bool ok = true;
+	g_mutex_lock(&proxyMutex);
+	while (ok) {
+		if (fetch->shared && sent < fetch->data->len) {
+			const guint n = MIN(fetch->data->len - sent, VIDEO_VIEW_PLUGIN_PROXY_BUFFER);
+			memcpy(buffer, &fetch->data->data[sent], n);
+			g_mutex_unlock(&proxyMutex);
+			video_view_plugin_proxy_throttle(id, n);
+			ok = g_output_stream_write_all(output, buffer, n, NULL, NULL, NULL);
+			sent += n;
+			g_mutex_lock(&proxyMutex);
+		} else if (fetch->done || !fetch->shared) {
+			break;
+		} else {
+			g_cond_wait(&proxyCond, &proxyMutex);
+		}
+	}
+	const int result = sent == 0 && (!fetch->shared || fetch->failed) ? 1 : ok && !fetch->failed && !fetch->closing ? 0 : -1;
+	g_mutex_unlock(&proxyMutex);
+	g_free(buffer);
+	return result;
+}
+
+// must be called with proxyMutex locked
+static void video_view_plugin_prefetch_unref(VideoViewPluginPrefetch* prefetch) {
+	if (--prefetch->refs == 0) {
+		g_byte_array_free(prefetch->data, TRUE);
+		g_free(prefetch->contentType);
+		g_free(prefetch->validator);
+		g_free(prefetch->url);
+		g_free(prefetch);
+	}
+}
+
+// must be called with proxyMutex locked
+static void video_view_plugin_prefetch_remove(VideoViewPluginPrefetch* prefetch) {
+	if (prefetch->cached) {
+		prefetch->cached = false;
+		prefetchBytes -= prefetch->data->len;
+		g_queue_remove(prefetchOrder, prefetch);
+		g_hash_table_steal(prefetchCache, prefetch->url);
+		video_view_plugin_prefetch_unref(prefetch);
+	}
+}
+
+// must be called with proxyMutex locked, drops finished entries from the least recently used
+static bool video_view_plugin_prefetch_evict() {
+	GList* item = prefetchOrder->head;
+	while (item && prefetchBytes > VIDEO_VIEW_PLUGIN_PREFETCH_MAX_BYTES) {
+		GList* next = item->next;
+		VideoViewPluginPrefetch* prefetch = item->data;
+		if (prefetch->done) {
+			video_view_plugin_prefetch_remove(prefetch);
+		}
+		item = next;
+	}
+	return prefetchBytes <= VIDEO_VIEW_PLUGIN_PREFETCH_MAX_BYTES;
+}
+
+// must be called with proxyMutex locked
+static VideoViewPluginPrefetch* video_view_plugin_prefetch_add(const gchar* url, const int64_t limit) {
+	VideoViewPluginPrefetch* prefetch = g_new0(VideoViewPluginPrefetch, 1);
+	prefetch->url = g_strdup(url);
+	prefetch->data = g_byte_array_new();
+	prefetch->total = -1;
+	prefetch->limit = limit;
+	prefetch->refs = 1;
+	prefetch->cached = true;
+	g_hash_table_insert(prefetchCache, prefetch->url, prefetch);
+	g_queue_push_tail(prefetchOrder, prefetch);
+	return prefetch;
+}
+
+// downloads the first bytes of a resource, stops early if root is cancelled or the cache is full
+static bool video_view_plugin_prefetch_download(VideoViewPluginPrefetch* prefetch, const VideoViewPluginPrefetch* root) {
+	const gchar* separator = strstr(prefetch->url, "://");
+	const gchar* slash = strchr(&separator[3], '/');
+	gchar* scheme = g_strndup(prefetch->url, separator - prefetch->url);
+	gchar* host = slash ? g_strndup(&separator[3], slash - &separator[3]) : g_strdup(&separator[3]);
+	gchar* request = g_strdup_printf("GET %s HTTP/1.1\r\nHost: %s\r\nConnection: keep-alive\r\nRange: bytes=0-%ld\r\n\r\n", slash ? slash : "/", host, prefetch->limit - 1);
+	VideoViewPluginUpstream* upstream = NULL;
+	gchar* status = NULL;
+	bool reused = true;
+	for (int i = 0; i < 2 && !status && reused; i++) {
+		upstream = video_view_plugin_upstream_get(scheme, host, &reused);
+		if (!upstream) {
+			break;
+		}
+		if (g_output_stream_write_all(g_io_stream_get_output_stream(G_IO_STREAM(upstream->connection)), request, strlen(request), NULL, NULL, NULL)) {
+			status = g_data_input_stream_read_line(upstream->input, NULL, NULL, NULL);
+		}
+		if (!status) {
+			video_view_plugin_upstream_free(upstream);
+			upstream = NULL;
+		}
+	}
+	g_free(request);
+	g_free(scheme);
+	g_free(host);
+	if (!status) {
+		return false;
+	}
+	const int code = strlen(status) > 9 ? (int)g_ascii_strtoll(&status[9], NULL, 10) : 0;
+	bool keepAlive = !g_str_has_prefix(status, "HTTP/1.0");
+	bool chunked = false;
+	int64_t length = -1;
+	int64_t total = -1;
+	gchar* contentType = NULL;
+	gchar* validator = NULL;
+	gchar* line;
+	g_free(status);
+	while ((line = g_data_input_stream_read_line(upstream->input, NULL, NULL, NULL)) && line[0]) {
+		if (!g_ascii_strncasecmp(line, "ETag:", 5) || (!validator && !g_ascii_strncasecmp(line, "Last-Modified:", 14))) {
+			g_free(validator);
+			validator = g_strdup(g_strchug(strchr(line, ':') + 1));
+		} else if (!g_ascii_strncasecmp(line, "Content-Length:", 15)) {
+			length = g_ascii_strtoll(&line[15], NULL, 10);
+		} else if (!g_ascii_strncasecmp(line, "Content-Range:", 14)) {
+			const gchar* size = strchr(line, '/');
+			total = size && size[1] != '*' ? g_ascii_strtoll(&size[1], NULL, 10) : -1;
+		} else if (!g_ascii_strncasecmp(line, "Content-Type:", 13)) {
+			g_free(contentType);
+			contentType = g_strdup(g_strchug(&line[13]));
+		} else if (!g_ascii_strncasecmp(line, "Transfer-Encoding:", 18)) {
+			chunked = true;
+		} else if (!g_ascii_strncasecmp(line, "Connection:", 11)) {
+			gchar* value = g_ascii_strdown(&line[11], -1);
+			keepAlive = !strstr(value, "close");
+			g_free(value);
+		}
+		g_free(line);
+	}
+	// chunked responses are rare for media, they are not worth to be cached
+	bool ok = line != NULL && !chunked && length >= 0 && (code == 200 || (code == 206 && total >= 0));
+	g_free(line);
+	g_mutex_lock(&proxyMutex);
+	if (ok) {
+		prefetch->headed = true;
+		prefetch->ranged = code == 206;
+		prefetch->total = code == 206 ? total : length;
+		prefetch->contentType = contentType;
+		prefetch->validator = validator;
+		contentType = validator = NULL;
+		g_cond_broadcast(&proxyCond);
+	}
+	g_mutex_unlock(&proxyMutex);
+	g_free(contentType);
+	g_free(validator);
+	// a full response is read until the limit, the connection can't be reused if the rest is skipped
+	const int64_t size = code == 206 ? length : MIN(length, prefetch->limit);
+	int64_t received = 0;
+	guint8* buffer = g_malloc(VIDEO_VIEW_PLUGIN_PROXY_BUFFER);
+	while (ok && received < size && !g_atomic_int_get(&root->cancelled) && !g_atomic_int_get(&prefetch->cancelled)) {
+		const gssize n = g_input_stream_read(G_INPUT_STREAM(upstream->input), buffer, MIN(size - received, VIDEO_VIEW_PLUGIN_PROXY_BUFFER), NULL, NULL);
+		if (n <= 0) {
+			ok = false;
+			break;
+		}
+		received += n;
+		g_mutex_lock(&proxyMutex);
+		g_byte_array_append(prefetch->data, buffer, n);
+		if (prefetch->cached) {
+			prefetchBytes += n;
+			ok = video_view_plugin_prefetch_evict();
+		}
+		g_cond_broadcast(&proxyCond);
+		g_mutex_unlock(&proxyMutex);
+		video_view_plugin_proxy_throttle(VIDEO_VIEW_PLUGIN_PREFETCH_CLIENT, n);
+	}
+	g_free(buffer);
+	if (ok && keepAlive && received == length) {
+		video_view_plugin_upstream_put(upstream);
+	} else {
+		video_view_plugin_upstream_free(upstream);
+	}
+	return ok;
+}
+
+static gchar* video_view_plugin_prefetch_resolve(const gchar* base, const gchar* uri) {
+	return g_uri_resolve_relative(base, uri, G_URI_FLAGS_NONE, NULL);
+}
+
+// queues the variant with the highest bandwidth of a master playlist, which mpv selects by default
+// or the init section and segments of a media playlist, live playlists are skipped since mpv starts near the end
+static void video_view_plugin_prefetch_parse(const gchar* base, const gchar* text, GQueue* urls) {
+	const bool vod = strstr(text, "#EXT-X-ENDLIST") && !strstr(text, "#EXT-X-BYTERANGE");
+	gchar** lines = g_strsplit(text, "\n", -1);
+	gchar* variant = NULL;
+	int64_t best = -1;
+	int64_t bandwidth = -1;
+	for (int i = 0; lines[i]; i++) {
+		gchar* line = g_strstrip(lines[i]);
+		if (g_str_has_prefix(line, "#EXT-X-STREAM-INF:")) {
+			const gchar* value = strstr(line, ":BANDWIDTH=");
+			if (!value) {
+				value = strstr(line, ",BANDWIDTH=");
+			}
+			bandwidth = value ? g_ascii_strtoll(&value[11], NULL, 10) : 0;
+		} else if (g_str_has_prefix(line, "#EXT-X-MAP:") && vod) {
+			const gchar* uri = strstr(line, "URI=\"");
+			const gchar* end = uri ? strchr(&uri[5], '"') : NULL;
+			if (end) {
+				gchar* value = g_strndup(&uri[5], end - &uri[5]);
+				gchar* url = video_view_plugin_prefetch_resolve(base, value);
+				if (url) {
+					g_queue_push_tail(urls, url);
+				}
+				g_free(value);
+			}
+		} else if (line[0] && line[0] != '#') {
+			if (bandwidth >= 0) {
+				if (bandwidth > best) {
+					best = bandwidth;
+					g_free(variant);
+					variant = video_view_plugin_prefetch_resolve(base, line);
+				}
+				bandwidth = -1;
+			} else if (vod) {
+				gchar* url = video_view_plugin_prefetch_resolve(base, line);
+				if (url) {
+					g_queue_push_tail(urls, url);
+				}
+			}
+		}
+	}
+	if (variant) {
+		g_queue_push_tail(urls, variant);
+	}
+	g_strfreev(lines);
+}
+
+// runs in prefetch threads, the byte limit of root is shared by all resources it refers to
+static void video_view_plugin_prefetch_run(void* data, void* user_data) {
+	VideoViewPluginPrefetch* root = data;
+	VideoViewPluginPrefetch* prefetch = root;
+	int64_t budget = root->limit;
+	GQueue urls;
+	g_queue_init(&urls);
+	g_mutex_lock(&proxyMutex);
+	video_view_plugin_proxy_relays(VIDEO_VIEW_PLUGIN_PREFETCH_CLIENT, 1);
+	g_mutex_unlock(&proxyMutex);
+	while (prefetch) {
+		const bool ok = video_view_plugin_prefetch_download(prefetch, root);
+		gchar* playlist = NULL;
+		g_mutex_lock(&proxyMutex);
+		prefetch->done = true;
+		prefetch->failed = !ok;
+		budget -= prefetch->data->len;
+		if (ok && prefetch->total == prefetch->data->len && prefetch->data->len > 7 && !memcmp(prefetch->data->data, "#EXTM3U", 7)) {
+			playlist = g_strndup((const gchar*)prefetch->data->data, prefetch->data->len);
+		}
+		g_cond_broadcast(&proxyCond);
+		video_view_plugin_prefetch_unref(prefetch);
+		prefetch = NULL;
+		g_mutex_unlock(&proxyMutex);
+		if (playlist) {
+			video_view_plugin_prefetch_parse(root->url, playlist, &urls);
+			g_free(playlist);
+		}
+		gchar* url;
+		while (!prefetch && budget > 0 && !g_atomic_int_get(&root->cancelled) && (url = g_queue_pop_head(&urls))) {
+			g_mutex_lock(&proxyMutex);
+			if (!g_hash_table_contains(prefetchCache, url)) {
+				prefetch = video_view_plugin_prefetch_add(url, budget);
+				prefetch->refs++;
+			}
+			g_mutex_unlock(&proxyMutex);
+			g_free(url);
+		}
+	}
+	g_queue_clear_full(&urls, g_free);
+	g_mutex_lock(&proxyMutex);
+	video_view_plugin_proxy_relays(VIDEO_VIEW_PLUGIN_PREFETCH_CLIENT, -1);
+	video_view_plugin_prefetch_unref(root);
+	g_mutex_unlock(&proxyMutex);
+}
+
+// serves a request from the prefetch cache, and fetches the rest from upstream if only the beginning is cached
+// returns 1 if the request can't be served, 0 if the client connection can be reused
+static int video_view_plugin_prefetch_serve(VideoViewPluginPrefetch* prefetch, GOutputStream* output, const int64_t id, const gchar* scheme, const gchar* host, const gchar* path, const gchar* headers, const gchar* range) {
+	int64_t start = 0;
+	int64_t end = -1;
+	if (range) {
+		gchar* next = NULL;
+		if (g_str_has_prefix(range, "bytes=")) {
+			start = g_ascii_strtoll(&range[6], &next, 10);
+		}
+		if (!next || next[0] != '-' || strchr(next, ',')) {
+			return 1;
+		}
+		if (next[1]) {
+			end = g_ascii_strtoll(&next[1], NULL, 10);
+		}
+	}
+	g_mutex_lock(&proxyMutex);
+	while (!prefetch->headed && !prefetch->done) {
+		g_cond_wait(&proxyCond, &proxyMutex);
+	}
+	if (prefetch->headed && video_view_plugin_proxy_is_playlist(path, prefetch->contentType)) {
+		// playlists are small, they are served whole once complete to be rewritten like fetched ones
+		while (!prefetch->done) {
+			g_cond_wait(&proxyCond, &proxyMutex);
+		}
+		if (start > 0 || prefetch->data->len != prefetch->total) {
+			g_mutex_unlock(&proxyMutex);
+			return 1;
+		}
+		GString* text = video_view_plugin_proxy_rewrite_playlist((const gchar*)prefetch->data->data, prefetch->data->len, path);
+		GString* head = g_string_new("HTTP/1.1 200 OK\r\n");
+		if (prefetch->contentType) {
+			g_string_append_printf(head, "Content-Type: %s\r\n", prefetch->contentType);
+		}
+		g_mutex_unlock(&proxyMutex);
+		g_string_append_printf(head, "Content-Length: %u\r\nConnection: keep-alive\r\n\r\n", (guint)text->len);
+		video_view_plugin_proxy_throttle(id, text->len);
+		const bool ok = g_output_stream_write_all(output, head->str, head->len, NULL, NULL, NULL) && g_output_stream_write_all(output, text->str, text->len, NULL, NULL, NULL);
+		g_string_free(head, TRUE);
+		g_string_free(text, TRUE);
+		return ok ? 0 : -1;
+	}
+	const int64_t total = prefetch->total;
+	const bool complete = prefetch->done && prefetch->data->len == total;
+	if (!prefetch->headed || start >= MIN(prefetch->limit, total) || (!complete && !prefetch->ranged)) {
+		g_mutex_unlock(&proxyMutex);
+		return 1;
+	}
+	if (end < 0 || end >= total) {
+		end = total - 1;
+	}
+	GString* head = g_string_new(range ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n");
+	if (range) {
+		g_string_append_printf(head, "Content-Range: bytes %ld-%ld/%ld\r\n", start, end, total);
+	}
+	if (prefetch->contentType) {
+		g_string_append_printf(head, "Content-Type: %s\r\n", prefetch->contentType);
+	}
+	g_string_append_printf(head, "Content-Length: %ld\r\nAccept-Ranges: bytes\r\nConnection: keep-alive\r\n\r\n", end - start + 1);
+	g_queue_remove(prefetchOrder, prefetch);
+	g_queue_push_tail(prefetchOrder, prefetch);
+	g_mutex_unlock(&proxyMutex);
+	bool ok = g_output_stream_write_all(output, head->str, head->len, NULL, NULL, NULL);
+	g_string_free(head, TRUE);
+	guint8* buffer = g_malloc(VIDEO_VIEW_PLUGIN_PROXY_BUFFER);
+	int64_t position = start;
+	g_mutex_lock(&proxyMutex);
+	while (ok && position <= end) {
+		if (position < prefetch->data->len) {
+			const guint n = MIN(MIN(prefetch->data->len - position, end + 1 - position), VIDEO_VIEW_PLUGIN_PROXY_BUFFER);
+			memcpy(buffer, &prefetch->data->data[position], n);
+			g_mutex_unlock(&proxyMutex);
+			video_view_plugin_proxy_throttle(id, n);
+			ok = g_output_stream_write_all(output, buffer, n, NULL, NULL, NULL);
+			position += n;
+			g_mutex_lock(&proxyMutex);
+		} else if (prefetch->done) {
+			break;
+		} else {
+			g_cond_wait(&proxyCond, &proxyMutex);
+		}
+	}
+	g_mutex_unlock(&proxyMutex);
+	g_free(buffer);
+	if (ok && position <= end) {
+		// the rest of the range is not prefetched
+		gchar* rest = g_strdup_printf("bytes=%ld-%ld", position, end);
+		VideoViewPluginFetch* fetch = g_new0(VideoViewPluginFetch, 1);
+		fetch->data = g_byte_array_new();
+		fetch->refs = 1;
+		ok = video_view_plugin_proxy_fetch(fetch, output, id, "GET", scheme, host, path, headers, rest, true);
+		g_mutex_lock(&proxyMutex);
+		video_view_plugin_fetch_unref(fetch);
+		g_mutex_unlock(&proxyMutex);
+		g_free(rest);
+	}
+	return ok ? 0 : -1;
+}
+
+// concurrent requests of the same resource and range share a single upstream response
+static bool video_view_plugin_proxy_request(GOutputStream* output, const int64_t id, const gchar* method, const gchar* scheme, const gchar* host, const gchar* path, const gchar* headers, const gchar* range) {
+	if (g_str_equal(method, "GET")) {
+		gchar* url = g_strdup_printf("%s://%s%s", scheme, host, path);
+		g_mutex_lock(&proxyMutex);
+		VideoViewPluginPrefetch* prefetch = g_hash_table_lookup(prefetchCache, url);
+		if (prefetch) {
+			prefetch->refs++;
+			video_view_plugin_proxy_relays(id, 1);
+		}
+		g_mutex_unlock(&proxyMutex);
+		g_free(url);
+		if (prefetch) {
+			const int result = video_view_plugin_prefetch_serve(prefetch, output, id, scheme, host, path, headers, range);
+			g_mutex_lock(&proxyMutex);
+			video_view_plugin_prefetch_unref(prefetch);
+			video_view_plugin_proxy_relays(id, -1);
+			g_mutex_unlock(&proxyMutex);
+			if (result <= 0) {
+				return result == 0;
+			}
+		}
+	}
+	gchar* key = g_strdup_printf("%s %s://%s%s %s", method, scheme, host, path, range ? range : "");
+	g_mutex_lock(&proxyMutex);
+	VideoViewPluginFetch* fetch = g_hash_table_lookup(proxyFetches, key);
+	const bool owner = !fetch;
+	if (owner) {
+		fetch = g_new0(VideoViewPluginFetch, 1);
+		fetch->data = g_byte_array_new();
+		fetch->shared = true;
+		g_hash_table_insert(proxyFetches, g_strdup(key), fetch);
+	}
+	fetch->refs++;
+	video_view_plugin_proxy_relays(id, 1);
+	g_mutex_unlock(&proxyMutex);
+	bool alive;
+	if (owner) {
+		alive = video_view_plugin_proxy_fetch(fetch, output, id, method, scheme, host, path, headers, range, false);
+		g_mutex_lock(&proxyMutex);
+		g_hash_table_remove(proxyFetches, key);
+		video_view_plugin_fetch_unref(fetch);
+		g_mutex_unlock(&proxyMutex);
+	} else {
+		const int result = video_view_plugin_proxy_follow(fetch, output, id);
+		g_mutex_lock(&proxyMutex);
+		video_view_plugin_fetch_unref(fetch);
+		g_mutex_unlock(&proxyMutex);
+		if (result > 0) {
+			fetch = g_new0(VideoViewPluginFetch, 1);
+			fetch->data = g_byte_array_new();
+			fetch->refs = 1;
+			alive = video_view_plugin_proxy_fetch(fetch, output, id, method, scheme, host, path, headers, range, false);
+			g_mutex_lock(&proxyMutex);
+			video_view_plugin_fetch_unref(fetch);
+			g_mutex_unlock(&proxyMutex);
+		} else {
+			alive = result == 0;
+		}
+	}
+	g_mutex_lock(&proxyMutex);
+	video_view_plugin_proxy_relays(id, -1);
+	g_mutex_unlock(&proxyMutex);
+	g_free(key);
+	return alive;
+}
+
+// runs in a worker thread for each connection from mpv, requests are like "GET /<token>/<player id>/<scheme>/<host>/<path> HTTP/1.1"
+static gboolean video_view_plugin_proxy_run(GThreadedSocketService* service, GSocketConnection* connection, GObject* source, void* data) {
+	GDataInputStream* input = g_data_input_stream_new(g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+	g_data_input_stream_set_newline_type(input, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+	GOutputStream* output = g_io_stream_get_output_stream(G_IO_STREAM(connection));
+	bool alive = true;
+	gchar* line;
+	while (alive && (line = g_data_input_stream_read_line(input, NULL, NULL, NULL))) {
+		gchar** request = g_strsplit(line, " ", 3);
+		g_free(line);
+		GString* headers = g_string_new(NULL);
+		gchar* range = NULL;
+		while ((line = g_data_input_stream_read_line(input, NULL, NULL, NULL)) && line[0]) {
+			if (!g_ascii_strncasecmp(line, "Connection:", 11)) {
+				gchar* value = g_ascii_strdown(&line[11], -1);
+				alive = !strstr(value, "close");
+				g_free(value);
+			} else if (g_ascii_strncasecmp(line, "Host:", 5) && g_ascii_strncasecmp(line, "Keep-Alive:", 11) && g_ascii_strncasecmp(line, "Proxy-Connection:", 17)) {
+				if (!g_ascii_strncasecmp(line, "Range:", 6)) {
+					g_free(range);
+					range = g_strdup(g_strchug(&line[6]));
+				} else {
+					g_string_append_printf(headers, "%s\r\n", line);
+				}
+			}
+			g_free(line);
+		}
+		if (line) {
+			g_free(line);
+			gchar** target = request[0] && request[1] && request[1][0] == '/' ? g_strsplit(&request[1][1], "/", 5) : NULL;
+			if (target && g_strv_length(target) >= 4 && !g_str_equal(target[0], proxyToken)) {
+				const gchar* response = "HTTP/1.1 403 Forbidden\r\nContent-Length: 0\r\n\r\n";
+				alive = g_output_stream_write_all(output, response, strlen(response), NULL, NULL, NULL) && alive;
+			} else if (target && g_strv_length(target) >= 4 && (g_str_equal(target[2], "http") || g_str_equal(target[2], "https"))) {
+				gchar* path = g_strdup_printf("/%s", target[4] ? target[4] : "");
+				alive = video_view_plugin_proxy_request(output, g_ascii_strtoll(target[1], NULL, 10), request[0], target[2], target[3], path, headers->str, range) && alive;
+				g_free(path);
+			} else {
+				const gchar* response = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n";
+				alive = g_output_stream_write_all(output, response, strlen(response), NULL, NULL, NULL) && alive;
+			}
+			g_strfreev(target);
+		} else {
+			alive = false;
+		}
+		g_free(range);
+		g_string_free(headers, TRUE);
+		g_strfreev(request);
+	}
+	g_object_unref(input);
+	return FALSE;
+}
+
+void video_view_plugin_proxy_set_weight(const int64_t id, const uint32_t weight) {
+	g_mutex_lock(&proxyMutex);
+	VideoViewPluginProxyClient* client = g_hash_table_lookup(proxyClients, (void*)id);
+	if (weight == 0) {
+		g_hash_table_remove(proxyClients, (void*)id);
+	} else if (client) {
+		client->weight = weight;
+	} else {
+		client = g_new0(VideoViewPluginProxyClient, 1);
+		client->weight = weight;
+		g_hash_table_insert(proxyClients, (void*)id, client);
+	}
+	g_mutex_unlock(&proxyMutex);
+}
+
+gchar* video_view_plugin_proxy_url(const int64_t id, const gchar* source) {
+	const gchar* separator = strstr(source, "://");
+	g_mutex_lock(&proxyMutex);
+	const bool prefetched = g_hash_table_contains(prefetchCache, source);
+	g_mutex_unlock(&proxyMutex);
+	if ((proxyEnabled || prefetched) && proxyPort && separator && (g_str_has_prefix(source, "http://") || g_str_has_prefix(source, "https://"))) {
+		g_mutex_lock(&proxyMutex);
+		if (!g_hash_table_contains(proxyValidators, source)) {
+			g_hash_table_insert(proxyValidators, g_strdup(source), NULL);
+		}
+		g_mutex_unlock(&proxyMutex);
+		return g_strdup_printf("http://127.0.0.1:%u/%s/%ld/%.*s/%s", proxyPort, proxyToken, id, (int)(separator - source), source, &separator[3]);
+	}
+	return g_strdup(source);
+}
+
+static void video_view_plugin_proxy_start() {
+	if (!proxyService) {
+		// only accept connections from this machine
+		GInetAddress* loopback = g_inet_address_new_loopback(G_SOCKET_FAMILY_IPV4);
+		GSocketAddress* address = g_inet_socket_address_new(loopback, 0);
+		GSocketAddress* effective = NULL;
+		if (!proxyToken) {
+			proxyToken = g_uuid_string_random();
+		}
+		proxyService = g_threaded_socket_service_new(VIDEO_VIEW_PLUGIN_PROXY_THREADS);
+		if (g_socket_listener_add_address(G_SOCKET_LISTENER(proxyService), address, G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_TCP, NULL, &effective, NULL)) {
+			proxyPort = g_inet_socket_address_get_port(G_INET_SOCKET_ADDRESS(effective));
+			g_object_unref(effective);
+			g_signal_connect(proxyService, "run", G_CALLBACK(video_view_plugin_proxy_run), NULL);
+			g_socket_service_start(proxyService);
+		} else {
+			g_object_unref(proxyService);
+			proxyService = NULL;
+		}
+		g_object_unref(address);
+		g_object_unref(loopback);
+	}
+}
+
+void video_view_plugin_set_proxy(const bool enabled, const int64_t bandwidth) {
+	proxyEnabled = enabled;
+	g_mutex_lock(&proxyMutex);
+	proxyBandwidth = bandwidth;
+	g_mutex_unlock(&proxyMutex);
+	if (enabled) {
+		video_view_plugin_proxy_start();
+	}
+}
+
+void video_view_plugin_prefetch(const gchar* source, const int64_t bytes) {
+	if (!g_str_has_prefix(source, "http://") && !g_str_has_prefix(source, "https://")) {
+		return;
+	}
+	video_view_plugin_proxy_start();
+	if (!proxyPort) {
+		return;
+	}
+	video_view_plugin_proxy_set_weight(VIDEO_VIEW_PLUGIN_PREFETCH_CLIENT, VIDEO_VIEW_PLUGIN_PROXY_WEIGHT_IDLE);
+	g_mutex_lock(&proxyMutex);
+	VideoViewPluginPrefetch* prefetch = g_hash_table_lookup(prefetchCache, source);
+	if (prefetch) {
+		if (bytes <= 0) {
+			g_atomic_int_set(&prefetch->cancelled, 1);
+			video_view_plugin_prefetch_remove(prefetch);
+		}
+		prefetch = NULL;
+	} else if (bytes > 0) {
+		prefetch = video_view_plugin_prefetch_add(source, bytes);
+		prefetch->refs++;
+	}
+	g_mutex_unlock(&proxyMutex);
+	if (prefetch) {
+		g_thread_pool_push(prefetchPool, prefetch, NULL);
+	}
+}
+
+gchar* video_view_plugin_proxy_validator(const gchar* source) {
+	g_mutex_lock(&proxyMutex);
+	const gchar* value = g_hash_table_lookup(proxyValidators, source);
+	if (!value) {
+		const VideoViewPluginPrefetch* prefetch = g_hash_table_lookup(prefetchCache, source);
+		value = prefetch ? prefetch->validator : NULL;
+	}
+	gchar* validator = g_strdup(value);
+	g_mutex_unlock(&proxyMutex);
+	return validator;
+}
+
+void video_view_plugin_proxy_forget(const gchar* source) {
+	g_mutex_lock(&proxyMutex);
+	g_hash_table_remove(proxyValidators, source);
+	g_mutex_unlock(&proxyMutex);
+}
+
+void video_view_plugin_proxy_init(void) {
+	if (!proxyPool) {
+		g_mutex_init(&proxyMutex);
+		g_cond_init(&proxyCond);
+		proxyPool = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, video_view_plugin_upstream_queue_free);
+		proxyFetches = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+		proxyClients = g_hash_table_new_full(NULL, NULL, NULL, g_free);
+		prefetchCache = g_hash_table_new(g_str_hash, g_str_equal);
+		prefetchOrder = g_queue_new();
+		proxyValidators = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+		prefetchPool = g_thread_pool_new(video_view_plugin_prefetch_run, NULL, VIDEO_VIEW_PLUGIN_PREFETCH_THREADS, FALSE, NULL);
+	}
+	proxyService = NULL;
+	proxyEnabled = false;
+	proxyPort = 0;
+	proxyBandwidth = 0;
+}
+
+void video_view_plugin_proxy_stop(void) {
+	if (proxyService) {
+		g_socket_service_stop(proxyService);
+		g_socket_listener_close(G_SOCKET_LISTENER(proxyService));
+		g_object_unref(proxyService);
+		proxyService = NULL;
+	}
+	proxyEnabled = false;
+	proxyPort = 0;
+}
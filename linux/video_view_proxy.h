@@ -0,0 +1,32 @@
+#pragma once
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// local HTTP proxy of the players and the prefetch cache behind it, the functions below are called in the main thread
+
+#define VIDEO_VIEW_PLUGIN_PROXY_WEIGHT_ACTIVE 4 // bandwidth weight of opening and playing players
+#define VIDEO_VIEW_PLUGIN_PROXY_WEIGHT_IDLE 1 // bandwidth weight of paused players and prefetch
+
+// called when the plugin is registered, states shared with worker threads are only created once per process
+void video_view_plugin_proxy_init(void);
+
+// stops listening, worker threads may still be running, so proxy states are kept until the process exits
+void video_view_plugin_proxy_stop(void);
+
+void video_view_plugin_set_proxy(const bool enabled, const int64_t bandwidth);
+
+// weight 0 removes the player
+void video_view_plugin_proxy_set_weight(const int64_t id, const uint32_t weight);
+
+// returns the url mpv should load, which goes through the proxy for http sources if enabled or prefetched
+gchar* video_view_plugin_proxy_url(const int64_t id, const gchar* source);
+
+// returns the ETag or Last-Modified of source seen by the proxy or the prefetch cache, NULL if unknown
+gchar* video_view_plugin_proxy_validator(const gchar* source);
+
+// forgets the validator of a source that is no longer opened
+void video_view_plugin_proxy_forget(const gchar* source);
+
+// starts to download the beginning of source into the prefetch cache, bytes <= 0 cancels it
+void video_view_plugin_prefetch(const gchar* source, const int64_t bytes);